@@ -426,6 +426,7 @@ void setup() {
   // rpupdfs_wipe_chip(fs);
 
   Serial.println("CoProc (soft-serial) booting...");
+  CRC32Fast::init();  // tables and DMA probe before core1 can compute CRCs
   ArbiterISP::initTestPins();
   //bool ok = ArbiterISP::runTestSuiteOnce(true, true);
   ArbiterISP::cleanupToResetState();
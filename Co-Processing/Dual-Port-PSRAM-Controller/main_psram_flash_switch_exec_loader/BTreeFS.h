@@ -0,0 +1,635 @@
+#pragma once
+#ifndef BTREE_FS_H
+#define BTREE_FS_H
+#include <Arduino.h>
+#include "UnifiedSPIMemSimpleFS.h"
+
+/*
+  BTreeFS.h - optional large-directory volume: a copy-on-write B+tree of files kept inside
+  one fixed SimpleFS slot (BTREEFS_SLOT), for file counts far beyond the RAM index
+
+  - Nothing per file is held in RAM. A lookup reads one node per tree level (O(log n));
+    mount reads the superblock log only (O(1) in the file count).
+  - Slot layout: two superblock units, then two halves. The active half is an append
+    log of file data and tree nodes; nothing in it is ever rewritten. An update writes
+    the file data, then new copies of the nodes on the root path (splitting full ones),
+    then commits a superblock record with the new root. A reset before the commit
+    leaves the previous tree intact.
+  - Superblock records (root, append offset, count, height, active half, seq, CRC-32) are
+    appended to one unit; when it is full the other unit is erased and takes over. Mount
+    picks the unit whose first record is newer and binary-searches its last record.
+  - When the active half is full, the live tree and file data are copied into the
+    other half (erased first) and committed there. The record names the active half: a
+    half filled to its last byte ends where the other one starts, so the append offset
+    alone cannot tell them apart (records without it: the half holding the root)
+  - Works on NOR, PSRAM and SPI-NAND (nodes are one NAND page; data is page aligned)
+
+  Node: 'B', 'L'|'I', count (BE16), CRC-32 (BE) of the entries, then sorted entries.
+  Leaf entry: name (BTREEFS_NAME_MAX, zero padded), data offset, size, CRC-32 (BE32).
+  Inner entry: first name of the child, child offset (BE32).
+
+  Usage:
+    BTreeFS::format(fs, 1024 * 1024);
+    static BTreeFS bt;
+    if (bt.begin(fs)) bt.writeFile("s00042.cfg", data, len);
+*/
+
+#ifndef BTREEFS_SLOT
+#define BTREEFS_SLOT "@bt"
+#endif
+#ifndef BTREEFS_NODE
+#define BTREEFS_NODE 512  // node bytes on NOR/PSRAM (SPI-NAND uses one page)
+#endif
+#ifndef BTREEFS_SECTOR
+#define BTREEFS_SECTOR 4096UL  // erase granularity when the device has none (PSRAM)
+#endif
+#ifndef BTREEFS_MAX_DEPTH
+#define BTREEFS_MAX_DEPTH 8
+#endif
+#define BTREEFS_NAME_MAX 32
+
+class BTreeFS {
+public:
+  struct Stats {
+    uint32_t lookups = 0;
+    uint32_t nodeReads = 0;
+    uint32_t nodeWrites = 0;
+    uint32_t commits = 0;
+    uint32_t compactions = 0;
+  };
+  typedef bool (*IterFn)(void* ctx, const char* name, uint32_t size);
+
+  // Create the slot (total bytes, split into two halves) with an empty tree
+  static bool format(UnifiedSPIMemSimpleFS& fs, uint32_t bytes) {
+    if (fs.exists(BTREEFS_SLOT)) return false;
+    BTreeFS t;
+    t.geometry(fs);
+    const uint32_t half = alignUp(max<uint32_t>(bytes / 2, 8 * t._node), t._unit);
+    if (!fs.createFixedFile(BTREEFS_SLOT, 2 * t._unit + 2 * half) || !t.attach(fs)) return false;
+    t._root = NONE;
+    t._active = 0;
+    t._next = t.halfStart(0);
+    t._sbUnit = 0;
+    t._sbSlot = -1;
+    return t.commit();
+  }
+
+  bool begin(UnifiedSPIMemSimpleFS& fs) {
+    _fs = nullptr;
+    if (!attach(fs)) return false;
+    uint8_t r[REC];
+    uint32_t s0 = 0, s1 = 0;
+    const bool v0 = readRec(0, 0, r, s0), v1 = readRec(1, 0, r, s1);
+    bool ok = v0 || v1;
+    if (ok) {
+      _sbUnit = (v0 && v1) ? ((int32_t)(s1 - s0) > 0 ? 1 : 0) : (v1 ? 1 : 0);
+      // Records form a programmed prefix of the unit
+      int32_t lo = 0, hi = (int32_t)recsPerUnit() - 1;
+      while (lo < hi) {
+        const int32_t mid = (lo + hi + 1) / 2;
+        if (recProgrammed(_sbUnit, mid)) lo = mid;
+        else hi = mid - 1;
+      }
+      _sbSlot = lo;
+      // A torn last record falls back to the one before it
+      uint32_t seq = 0;
+      while (lo >= 0 && !readRec(_sbUnit, lo, r, seq)) --lo;
+      ok = lo >= 0 && applyRec(r);
+    }
+    if (!ok) {
+      _fs = nullptr;
+      return false;
+    }
+    // Uncommitted appends past _next (reset mid-update): continue at the next erase unit
+    const uint32_t unitEnd = min<uint32_t>(alignUp(_next + 1, _unit), halfEnd(activeHalf()));
+    _erasedTo = blank(_next, unitEnd - _next) ? unitEnd : (_next = unitEnd);
+    return true;
+  }
+  // Still attached to fs and its slot (false after a format or a rewrite of the slot)
+  bool bound(UnifiedSPIMemSimpleFS& fs) {
+    uint32_t a = 0, s = 0, c = 0;
+    return _fs == &fs && fs.getFileInfo(BTREEFS_SLOT, a, s, c) && a == _addr;
+  }
+
+  bool writeFile(const char* name, const uint8_t* data, uint32_t size) {
+    uint8_t key[BTREEFS_NAME_MAX];
+    if (!_fs || !makeKey(name, key) || (size && !data)) return false;
+    const uint32_t need = alignUp(size, _align) + (2 * (_height + 1) + 1) * _node;
+    if (!room(need)) return false;
+    uint32_t off = 0;
+    if (!reserve(size, off) || (size && !program(off, data, size))) return false;
+    uint8_t val[12];
+    wr32(val, off);
+    wr32(val + 4, size);
+    wr32(val + 8, CRC32Fast::compute(data, size));
+    return update(key, val) && commit();
+  }
+  bool deleteFile(const char* name) {
+    uint8_t key[BTREEFS_NAME_MAX];
+    if (!_fs || !makeKey(name, key) || !room((2 * (_height + 1) + 1) * _node)) return false;
+    return update(key, nullptr) && commit();
+  }
+  bool exists(const char* name) {
+    uint32_t a, s, c;
+    return find(name, a, s, c);
+  }
+  bool getFileSize(const char* name, uint32_t& size) {
+    uint32_t a, c;
+    return find(name, a, size, c);
+  }
+  bool getFileCrc(const char* name, uint32_t& crc) {
+    uint32_t a, s;
+    return find(name, a, s, crc);
+  }
+  uint32_t readFile(const char* name, uint8_t* buf, uint32_t cap) {
+    return readFileRange(name, 0, buf, cap);
+  }
+  uint32_t readFileRange(const char* name, uint32_t offset, uint8_t* buf, uint32_t len) {
+    uint32_t a = 0, s = 0, c = 0;
+    if (!find(name, a, s, c) || offset >= s) return 0;
+    if (len > s - offset) len = s - offset;
+    return _fs->readFileRange(BTREEFS_SLOT, a + offset, buf, len) == len ? len : 0;
+  }
+  // In-order walk; stops when fn returns false
+  void iter(IterFn fn, void* ctx) {
+    if (_fs && fn && _root != NONE) walk(_root, 0, fn, ctx);
+  }
+  // Copy the live tree and data into the other half
+  bool compact() {
+    if (!_fs) return false;
+    const uint32_t savedNext = _next, savedErased = _erasedTo, savedRoot = _root;
+    const uint8_t from = _active, to = _active ^ 1;
+    if (!_fs->eraseFileRange(BTREEFS_SLOT, halfStart(to), _half)) return false;
+    _active = to;
+    _next = halfStart(to);
+    _erasedTo = halfEnd(to);
+    uint32_t root = NONE;
+    if (_root != NONE && !copyTree(_root, root, 0)) {
+      _active = from;
+      _next = savedNext;
+      _erasedTo = savedErased;
+      return false;
+    }
+    _root = root;
+    if (!commit()) {
+      _active = from;  // the old tree in the old half is still the committed one
+      _root = savedRoot;
+      _next = savedNext;
+      _erasedTo = savedErased;
+      return false;
+    }
+    _st.compactions++;
+    return true;
+  }
+
+  uint32_t fileCount() const {
+    return _count;
+  }
+  uint8_t height() const {
+    return _height;
+  }
+  uint32_t usedBytes() const {
+    return _next - halfStart(activeHalf());
+  }
+  uint32_t halfBytes() const {
+    return _half;
+  }
+  uint32_t nodeBytes() const {
+    return _node;
+  }
+  const Stats& stats() const {
+    return _st;
+  }
+  void resetStats() {
+    _st = Stats();
+  }
+
+private:
+  static const uint32_t NONE = 0xFFFFFFFFu;
+  static const uint32_t MAGIC = 0x42545331u;  // "BTS1"
+  static const uint32_t REC = 32;             // superblock record bytes used (NAND: one page each)
+  static const uint32_t HDR = 8;              // node header
+  static const uint32_t LEAF_E = BTREEFS_NAME_MAX + 12;
+  static const uint32_t INNER_E = BTREEFS_NAME_MAX + 4;
+
+  static uint32_t alignUp(uint32_t v, uint32_t a) {
+    return (v + a - 1) / a * a;
+  }
+  static void wr32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+  }
+  static uint32_t rd32(const uint8_t* p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+  }
+  static bool makeKey(const char* name, uint8_t* key) {
+    const size_t n = name ? strlen(name) : 0;
+    if (n == 0 || n > BTREEFS_NAME_MAX) return false;
+    memset(key, 0, BTREEFS_NAME_MAX);
+    memcpy(key, name, n);
+    return true;
+  }
+
+  // ---- geometry ----
+  void geometry(UnifiedSPIMemSimpleFS& fs) {
+    const uint32_t e = fs.eraseUnit(), p = fs.programUnit();
+    _unit = e > 1 ? e : BTREEFS_SECTOR;
+    _align = p > 1 ? p : 4;
+    _node = p > 1 ? alignUp(BTREEFS_NODE, p) : BTREEFS_NODE;
+    _recStride = p > 1 ? p : REC;
+  }
+  bool attach(UnifiedSPIMemSimpleFS& fs) {
+    uint32_t size = 0, cap = 0;
+    if (!fs.getFileInfo(BTREEFS_SLOT, _addr, size, cap)) return false;
+    geometry(fs);
+    if (size < 2 * _unit || (size - 2 * _unit) % (2 * _unit)) return false;
+    _half = (size - 2 * _unit) / 2;
+    _fs = &fs;
+    return true;
+  }
+  uint32_t halfStart(uint8_t h) const {
+    return 2 * _unit + h * _half;
+  }
+  uint32_t halfEnd(uint8_t h) const {
+    return halfStart(h) + _half;
+  }
+  uint8_t activeHalf() const {
+    return _active;
+  }
+  uint32_t recsPerUnit() const {
+    return _unit / _recStride;
+  }
+  uint16_t leafCap() const {
+    return (uint16_t)((_node - HDR) / LEAF_E);
+  }
+  uint16_t innerCap() const {
+    return (uint16_t)((_node - HDR) / INNER_E);
+  }
+
+  // ---- raw slot I/O ----
+  // Program len bytes at off; SPI-NAND pads the last page with 0xFF
+  bool program(uint32_t off, const uint8_t* data, uint32_t len) {
+    const uint32_t whole = _align > 4 ? len / _align * _align : len;
+    if (whole && !_fs->programFileRange(BTREEFS_SLOT, off, data, whole)) return false;
+    if (whole == len) return true;
+    uint8_t* pg = (uint8_t*)malloc(_align);
+    if (!pg) return false;
+    memset(pg, 0xFF, _align);
+    memcpy(pg, data + whole, len - whole);
+    const bool ok = _fs->programFileRange(BTREEFS_SLOT, off + whole, pg, _align);
+    free(pg);
+    return ok;
+  }
+  bool blank(uint32_t off, uint32_t len) {
+    uint8_t* tmp = (uint8_t*)malloc(_node);
+    bool ok = tmp != nullptr;
+    for (uint32_t p = 0; ok && p < len; p += _node) {
+      const uint32_t n = min<uint32_t>(_node, len - p);
+      ok = _fs->readFileRange(BTREEFS_SLOT, off + p, tmp, n) == n;
+      for (uint32_t i = 0; ok && i < n; ++i) ok = tmp[i] == 0xFF;
+    }
+    free(tmp);
+    return ok;
+  }
+  // Make room for need bytes in the active half, compacting once if necessary
+  bool room(uint32_t need) {
+    return alignUp(_next, _align) + need <= halfEnd(activeHalf()) || (compact() && alignUp(_next, _align) + need <= halfEnd(activeHalf()));
+  }
+  // Next len bytes of the append log, erasing units ahead as the log reaches them
+  bool reserve(uint32_t len, uint32_t& off) {
+    off = alignUp(_next, _align);
+    const uint32_t end = off + alignUp(len, _align);
+    if (end > halfEnd(activeHalf())) return false;
+    while (_erasedTo < end) {
+      if (!_fs->eraseFileRange(BTREEFS_SLOT, _erasedTo, _unit)) return false;
+      _erasedTo += _unit;
+    }
+    _next = end;
+    return true;
+  }
+
+  // ---- superblock log ----
+  bool readRec(uint8_t unit, int32_t slot, uint8_t* r, uint32_t& seq) {
+    if (_fs->readFileRange(BTREEFS_SLOT, unit * _unit + slot * _recStride, r, REC) != REC) return false;
+    if (rd32(r) != MAGIC || rd32(r + 28) != CRC32Fast::compute(r, 28)) return false;
+    seq = rd32(r + 4);
+    return true;
+  }
+  bool recProgrammed(uint8_t unit, int32_t slot) {
+    uint8_t m[4];
+    return _fs->readFileRange(BTREEFS_SLOT, unit * _unit + slot * _recStride, m, 4) == 4 && rd32(m) == MAGIC;
+  }
+  bool applyRec(const uint8_t* r) {
+    _seq = rd32(r + 4);
+    _root = rd32(r + 8);
+    _next = rd32(r + 12);
+    _count = rd32(r + 16);
+    _height = r[20];
+    if (r[21] <= 1) _active = r[21];
+    else _active = (_root != NONE ? _root >= halfStart(1) : _next > halfStart(1)) ? 1 : 0;
+    return _next >= halfStart(_active) && _next <= halfEnd(_active) && _height <= BTREEFS_MAX_DEPTH;
+  }
+  bool commit() {
+    int32_t slot = _sbSlot + 1;
+    uint8_t unit = _sbUnit;
+    if (slot >= (int32_t)recsPerUnit()) {
+      unit ^= 1;
+      slot = 0;
+      if (!_fs->eraseFileRange(BTREEFS_SLOT, unit * _unit, _unit)) return false;
+    }
+    uint8_t r[REC];
+    memset(r, 0xFF, REC);
+    wr32(r, MAGIC);
+    wr32(r + 4, _seq + 1);
+    wr32(r + 8, _root);
+    wr32(r + 12, _next);
+    wr32(r + 16, _count);
+    r[20] = _height;
+    r[21] = _active;
+    wr32(r + 28, CRC32Fast::compute(r, 28));
+    if (!program(unit * _unit + slot * _recStride, r, REC)) return false;
+    _seq++;
+    _sbUnit = unit;
+    _sbSlot = slot;
+    _st.commits++;
+    return true;
+  }
+
+  // ---- nodes ----
+  uint8_t* allocNode() {
+    uint8_t* b = (uint8_t*)malloc(_node + LEAF_E);  // room for one entry of overflow
+    if (b) memset(b, 0xFF, _node + LEAF_E);
+    return b;
+  }
+  static bool isLeaf(const uint8_t* b) {
+    return b[1] == 'L';
+  }
+  static uint16_t count(const uint8_t* b) {
+    return (uint16_t)(b[2] << 8 | b[3]);
+  }
+  static void setCount(uint8_t* b, uint16_t n) {
+    b[2] = (uint8_t)(n >> 8);
+    b[3] = (uint8_t)n;
+  }
+  static uint32_t esize(const uint8_t* b) {
+    return isLeaf(b) ? LEAF_E : INNER_E;
+  }
+  static uint8_t* entry(uint8_t* b, uint16_t i) {
+    return b + HDR + i * esize(b);
+  }
+  bool readNode(uint32_t off, uint8_t* b) {
+    _st.nodeReads++;
+    if (_fs->readFileRange(BTREEFS_SLOT, off, b, _node) != _node || b[0] != 'B' || (b[1] != 'L' && b[1] != 'I')) return false;
+    const uint16_t n = count(b);
+    if (n == 0 || n > (isLeaf(b) ? leafCap() : innerCap())) return false;
+    return rd32(b + 4) == CRC32Fast::compute(b + HDR, n * esize(b));
+  }
+  bool writeNode(uint8_t* b, uint32_t& off) {
+    b[0] = 'B';
+    wr32(b + 4, CRC32Fast::compute(b + HDR, count(b) * esize(b)));
+    if (!reserve(_node, off) || !program(off, b, _node)) return false;
+    _st.nodeWrites++;
+    return true;
+  }
+  // Leaf: first entry >= key; inner: child covering key
+  static uint16_t search(uint8_t* b, const uint8_t* key, bool& exact) {
+    const uint16_t n = count(b);
+    uint16_t lo = 0, hi = n;
+    while (lo < hi) {
+      const uint16_t mid = (lo + hi) / 2;
+      if (memcmp(entry(b, mid), key, BTREEFS_NAME_MAX) < 0) lo = mid + 1;
+      else hi = mid;
+    }
+    exact = lo < n && memcmp(entry(b, lo), key, BTREEFS_NAME_MAX) == 0;
+    if (isLeaf(b) || exact) return lo;
+    return lo ? lo - 1 : 0;
+  }
+  bool find(const char* name, uint32_t& addr, uint32_t& size, uint32_t& crc) {
+    uint8_t key[BTREEFS_NAME_MAX];
+    if (!_fs || !makeKey(name, key) || _root == NONE) return false;
+    _st.lookups++;
+    uint8_t* b = allocNode();
+    if (!b) return false;
+    uint32_t off = _root;
+    bool found = false;
+    for (uint8_t d = 0; d < BTREEFS_MAX_DEPTH && readNode(off, b); ++d) {
+      bool exact = false;
+      const uint16_t i = search(b, key, exact);
+      if (!isLeaf(b)) {
+        off = rd32(entry(b, i) + BTREEFS_NAME_MAX);
+        continue;
+      }
+      if (exact) {
+        const uint8_t* v = entry(b, i) + BTREEFS_NAME_MAX;
+        addr = rd32(v);
+        size = rd32(v + 4);
+        crc = rd32(v + 8);
+        found = true;
+      }
+      break;
+    }
+    free(b);
+    return found;
+  }
+
+  // Copy-on-write insert/replace (val) or delete (val null) along the root path
+  bool update(const uint8_t* key, const uint8_t* val) {
+    uint8_t* path[BTREEFS_MAX_DEPTH] = {};
+    uint16_t idx[BTREEFS_MAX_DEPTH] = {};
+    uint8_t* spill = allocNode();
+    uint8_t depth = 0;
+    int8_t delta = 0;  // file count change
+    bool ok = spill != nullptr;
+    // Descend
+    for (uint32_t off = _root; ok && off != NONE; ++depth) {
+      ok = depth < BTREEFS_MAX_DEPTH && (path[depth] = allocNode()) && readNode(off, path[depth]);
+      if (!ok) break;
+      bool exact = false;
+      idx[depth] = search(path[depth], key, exact);
+      if (isLeaf(path[depth])) {
+        if (val && exact) {
+          memcpy(entry(path[depth], idx[depth]) + BTREEFS_NAME_MAX, val, 12);
+        } else if (val) {
+          insertAt(path[depth], idx[depth], key, val, 12);
+          delta = 1;
+        } else if (exact) {
+          removeAt(path[depth], idx[depth]);
+          delta = -1;
+        } else {
+          ok = false;  // nothing to delete
+        }
+        ++depth;
+        break;
+      }
+      off = rd32(entry(path[depth], idx[depth]) + BTREEFS_NAME_MAX);
+    }
+    // Empty tree: a new one-entry leaf
+    if (ok && depth == 0) {
+      ok = val && (path[0] = allocNode());
+      if (ok) {
+        path[0][1] = 'L';
+        setCount(path[0], 0);
+        insertAt(path[0], 0, key, val, 12);
+        delta = 1;
+        depth = 1;
+      }
+    }
+    // Rewrite bottom-up; each level hands its parent 0, 1 or 2 (first key, offset) pairs
+    uint8_t k[2][BTREEFS_NAME_MAX];
+    uint32_t o[2] = { NONE, NONE };
+    uint8_t produced = 0;
+    uint8_t height = depth;
+    for (int d = (int)depth - 1; ok && d >= 0; --d) {
+      uint8_t* b = path[d];
+      if (!isLeaf(b)) {
+        const uint16_t i = idx[d];
+        if (produced == 0) removeAt(b, i);
+        else {
+          memcpy(entry(b, i), k[0], BTREEFS_NAME_MAX);
+          wr32(entry(b, i) + BTREEFS_NAME_MAX, o[0]);
+          uint8_t c[4];
+          wr32(c, o[1]);
+          if (produced == 2) insertAt(b, i + 1, k[1], c, 4);
+        }
+      }
+      const uint16_t n = count(b), cap = isLeaf(b) ? leafCap() : innerCap();
+      if (n == 0) {
+        produced = 0;
+        continue;
+      }
+      if (d == 0 && !isLeaf(b) && n == 1) {  // root with one child: drop a level
+        memcpy(k[0], entry(b, 0), BTREEFS_NAME_MAX);
+        o[0] = rd32(entry(b, 0) + BTREEFS_NAME_MAX);
+        produced = 1;
+        height = depth - 1;
+        continue;
+      }
+      if (n <= cap) {
+        memcpy(k[0], entry(b, 0), BTREEFS_NAME_MAX);
+        ok = writeNode(b, o[0]);
+        produced = 1;
+        continue;
+      }
+      // Split in two halves
+      const uint16_t left = n / 2;
+      memset(spill, 0xFF, _node);
+      spill[1] = b[1];
+      setCount(spill, n - left);
+      memcpy(spill + HDR, entry(b, left), (n - left) * esize(b));
+      setCount(b, left);
+      memcpy(k[0], entry(b, 0), BTREEFS_NAME_MAX);
+      memcpy(k[1], entry(spill, 0), BTREEFS_NAME_MAX);
+      ok = writeNode(b, o[0]) && writeNode(spill, o[1]);
+      produced = 2;
+    }
+    if (ok) {
+      if (produced == 0) {
+        _root = NONE;
+        height = 0;
+      } else if (produced == 1) {
+        _root = o[0];
+      } else {
+        // Root split: new root above
+        uint8_t* r = spill;
+        memset(r, 0xFF, _node);
+        r[1] = 'I';
+        setCount(r, 0);
+        uint8_t c[4];
+        wr32(c, o[0]);
+        insertAt(r, 0, k[0], c, 4);
+        wr32(c, o[1]);
+        insertAt(r, 1, k[1], c, 4);
+        ok = writeNode(r, _root);
+        height = depth + 1;
+      }
+    }
+    if (ok) {
+      _height = height;
+      _count += delta;
+    }
+    for (uint8_t d = 0; d < BTREEFS_MAX_DEPTH; ++d) free(path[d]);
+    free(spill);
+    return ok;
+  }
+  static void insertAt(uint8_t* b, uint16_t i, const uint8_t* key, const uint8_t* val, uint32_t vlen) {
+    const uint16_t n = count(b);
+    const uint32_t es = esize(b);
+    memmove(b + HDR + (i + 1) * es, b + HDR + i * es, (n - i) * es);
+    memcpy(b + HDR + i * es, key, BTREEFS_NAME_MAX);
+    memcpy(b + HDR + i * es + BTREEFS_NAME_MAX, val, vlen);
+    setCount(b, n + 1);
+  }
+  static void removeAt(uint8_t* b, uint16_t i) {
+    const uint16_t n = count(b);
+    const uint32_t es = esize(b);
+    memmove(b + HDR + i * es, b + HDR + (i + 1) * es, (n - i - 1) * es);
+    setCount(b, n - 1);
+  }
+
+  bool walk(uint32_t off, uint8_t d, IterFn fn, void* ctx) {
+    if (d >= BTREEFS_MAX_DEPTH) return false;
+    uint8_t* b = allocNode();
+    bool more = b && readNode(off, b);
+    for (uint16_t i = 0; more && i < count(b); ++i) {
+      uint8_t* e = entry(b, i);
+      if (!isLeaf(b)) {
+        more = walk(rd32(e + BTREEFS_NAME_MAX), d + 1, fn, ctx);
+        continue;
+      }
+      char name[BTREEFS_NAME_MAX + 1];
+      memcpy(name, e, BTREEFS_NAME_MAX);
+      name[BTREEFS_NAME_MAX] = 0;
+      more = fn(ctx, name, rd32(e + BTREEFS_NAME_MAX + 4));
+    }
+    free(b);
+    return more;
+  }
+  // Post-order copy of a subtree (and its file data) to the append log
+  bool copyTree(uint32_t off, uint32_t& out, uint8_t d) {
+    if (d >= BTREEFS_MAX_DEPTH) return false;
+    uint8_t* b = allocNode();
+    bool ok = b && readNode(off, b);
+    for (uint16_t i = 0; ok && i < count(b); ++i) {
+      uint8_t* v = entry(b, i) + BTREEFS_NAME_MAX;
+      uint32_t nv = 0;
+      ok = isLeaf(b) ? copyData(rd32(v), rd32(v + 4), nv) : copyTree(rd32(v), nv, d + 1);
+      wr32(v, nv);
+    }
+    ok = ok && writeNode(b, out);
+    free(b);
+    return ok;
+  }
+  bool copyData(uint32_t from, uint32_t size, uint32_t& to) {
+    if (!reserve(size, to)) return false;
+    uint8_t* buf = (uint8_t*)malloc(_node);
+    bool ok = buf != nullptr;
+    for (uint32_t p = 0; ok && p < size; p += _node) {
+      const uint32_t n = min<uint32_t>(_node, size - p);
+      ok = _fs->readFileRange(BTREEFS_SLOT, from + p, buf, n) == n && program(to + p, buf, n);
+    }
+    free(buf);
+    return ok;
+  }
+
+  UnifiedSPIMemSimpleFS* _fs = nullptr;
+  uint32_t _addr = 0;       // slot address when bound
+  uint32_t _unit = 0;       // erase unit
+  uint32_t _align = 4;      // append alignment (NAND page)
+  uint32_t _node = 0;       // node bytes
+  uint32_t _recStride = 0;  // superblock record stride
+  uint32_t _half = 0;
+  uint32_t _root = NONE;
+  uint32_t _next = 0;  // append offset in the active half
+  uint32_t _erasedTo = 0;
+  uint32_t _count = 0;
+  uint32_t _seq = 0;
+  uint8_t _height = 0;
+  uint8_t _active = 0;  // half holding the live tree (superblock record)
+  uint8_t _sbUnit = 0;
+  int32_t _sbSlot = -1;
+  Stats _st;
+};
+
+#endif  // BTREE_FS_H
\ No newline at end of file
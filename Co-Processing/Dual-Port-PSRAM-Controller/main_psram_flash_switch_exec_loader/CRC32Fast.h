@@ -0,0 +1,206 @@
+#pragma once
+/*
+  CRC32Fast.h
+  CRC-32 (IEEE 802.3 / zlib) for the protocol, SimpleFS and self-update paths.
+  - Slicing-by-8 tables (8 KiB RAM); CRC32FAST_SLICES=1 uses one 1 KiB table.
+  - RP2040/RP2350: long buffers go through the DMA sniffer (CRC32FAST_USE_DMA=0 disables).
+    It is checked once against the check value of "123456789" and falls back to software.
+  - Call init() from setup() before both cores compute CRCs: it builds the tables and probes
+    the sniffer up front (without it the tables are built on first use and DMA stays off).
+    The sniffer is one peripheral, so the core that finds it busy (hardware spinlock guarded
+    flag) uses the tables instead.
+  - Incremental API: state = begin(); state = update(state, p, n); crc = finish(state).
+    Crc32 wraps the same in a small object.
+  - bitwise() is the original 8-iterations-per-byte loop, kept as a benchmark reference.
+*/
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifndef CRC32FAST_SLICES
+#define CRC32FAST_SLICES 8  // 8 (slicing-by-8) or 1 (byte table)
+#endif
+#ifndef CRC32FAST_USE_DMA
+#define CRC32FAST_USE_DMA 1  // only takes effect on RP2040/RP2350 builds
+#endif
+#ifndef CRC32FAST_DMA_MIN
+#define CRC32FAST_DMA_MIN 512  // shorter buffers are not worth a channel setup
+#endif
+
+#if CRC32FAST_USE_DMA && (defined(ARDUINO_ARCH_RP2040) || defined(PICO_RP2040) || defined(PICO_RP2350))
+#define CRC32FAST_HAVE_DMA 1
+extern "C" {
+#include <hardware/dma.h>
+#include <hardware/sync.h>
+}
+#else
+#define CRC32FAST_HAVE_DMA 0
+#endif
+
+namespace CRC32Fast {
+
+static constexpr uint32_t POLY = 0xEDB88320u;  // reflected 0x04C11DB7
+static constexpr uint32_t CHECK = 0xCBF43926u;  // crc of "123456789"
+
+inline const uint32_t (*tables())[256] {
+  static uint32_t t[CRC32FAST_SLICES][256];
+  static bool built = false;
+  if (!built) {
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; ++k) c = (c >> 1) ^ (POLY & (0u - (c & 1u)));
+      t[0][i] = c;
+    }
+    for (int s = 1; s < CRC32FAST_SLICES; ++s)
+      for (uint32_t i = 0; i < 256; ++i) t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xFFu];
+    built = true;
+  }
+  return t;
+}
+
+// Reference: one bit per iteration
+inline uint32_t bitwise(uint32_t state, const void* data, size_t len) {
+  const uint8_t* p = (const uint8_t*)data;
+  while (len--) {
+    uint32_t c = (state ^ *p++) & 0xFFu;
+    for (int i = 0; i < 8; ++i) c = (c >> 1) ^ (POLY & (0u - (c & 1u)));
+    state = (state >> 8) ^ c;
+  }
+  return state;
+}
+
+// Table-driven software path (state is the raw register, no final xor)
+inline uint32_t software(uint32_t state, const void* data, size_t len) {
+  const uint32_t(*t)[256] = tables();
+  const uint8_t* p = (const uint8_t*)data;
+#if CRC32FAST_SLICES >= 8
+  while (len && ((uintptr_t)p & 3u)) {
+    state = (state >> 8) ^ t[0][(state ^ *p++) & 0xFFu];
+    --len;
+  }
+  while (len >= 8) {
+    // Little-endian word loads (RP2040/RP2350 and hosts), aligned by the loop above
+    uint32_t a, b;
+    memcpy(&a, p, 4);
+    memcpy(&b, p + 4, 4);
+    a ^= state;
+    state = t[7][a & 0xFF] ^ t[6][(a >> 8) & 0xFF] ^ t[5][(a >> 16) & 0xFF] ^ t[4][a >> 24] ^ t[3][b & 0xFF] ^ t[2][(b >> 8) & 0xFF] ^ t[1][(b >> 16) & 0xFF] ^ t[0][b >> 24];
+    p += 8;
+    len -= 8;
+  }
+#endif
+  while (len--) state = (state >> 8) ^ t[0][(state ^ *p++) & 0xFFu];
+  return state;
+}
+
+#if CRC32FAST_HAVE_DMA
+inline uint32_t bitrev32(uint32_t v) {
+  v = ((v >> 1) & 0x55555555u) | ((v & 0x55555555u) << 1);
+  v = ((v >> 2) & 0x33333333u) | ((v & 0x33333333u) << 2);
+  v = ((v >> 4) & 0x0F0F0F0Fu) | ((v & 0x0F0F0F0Fu) << 4);
+  v = ((v >> 8) & 0x00FF00FFu) | ((v & 0x00FF00FFu) << 8);
+  return (v >> 16) | (v << 16);
+}
+// -1 unknown, 0 broken/unavailable, 1 verified
+inline int8_t& dmaState() {
+  static int8_t s = -1;
+  return s;
+}
+inline int& dmaLockNum() {
+  static int n = -1;  // hardware spinlock claimed by init()
+  return n;
+}
+inline volatile bool& dmaBusy() {
+  static volatile bool b = false;
+  return b;
+}
+// Take or release the sniffer; false when the other core has it
+inline bool dmaSniffer(bool take) {
+  spin_lock_t* lk = spin_lock_instance((uint)dmaLockNum());
+  const uint32_t save = spin_lock_blocking(lk);
+  const bool ok = !take || !dmaBusy();
+  if (ok) dmaBusy() = take;
+  spin_unlock(lk, save);
+  return ok;
+}
+// DMA sniffer in bit-reversed CRC-32 mode: a memory-to-dummy byte transfer through the sniffer.
+// Returns false (state untouched) when the sniffer or every channel is in use.
+inline bool dmaUpdate(uint32_t& state, const uint8_t* p, size_t len) {
+  if (dmaLockNum() < 0 || !dmaSniffer(true)) return false;
+  int ch = dma_claim_unused_channel(false);
+  if (ch < 0) {
+    dmaSniffer(false);
+    return false;
+  }
+  static volatile uint8_t sink;
+  dma_channel_config c = dma_channel_get_default_config((uint)ch);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_sniff_enable(&c, true);
+  dma_sniffer_enable((uint)ch, 0x1 /* CRC-32, bit-reversed data */, true);
+  dma_sniffer_set_output_reverse_enabled(true);
+  dma_sniffer_set_data_accumulator(bitrev32(state));  // accumulator runs MSB-first
+  dma_channel_configure((uint)ch, &c, (void*)&sink, p, (uint)len, true);
+  dma_channel_wait_for_finish_blocking((uint)ch);
+  state = dma_sniffer_get_data_accumulator();  // read back reversed == reflected register
+  dma_sniffer_disable();
+  dma_channel_unclaim((uint)ch);
+  dmaSniffer(false);
+  return true;
+}
+inline bool dmaUsable() {
+  return dmaState() == 1;
+}
+#endif
+
+inline void init() {
+  tables();
+#if CRC32FAST_HAVE_DMA
+  if (dmaState() >= 0) return;
+  dmaLockNum() = spin_lock_claim_unused(false);
+  static const uint8_t probe[9] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+  uint32_t st = 0xFFFFFFFFu;
+  dmaState() = (dmaUpdate(st, probe, sizeof(probe)) && (st ^ 0xFFFFFFFFu) == CHECK) ? 1 : 0;
+#endif
+}
+
+inline uint32_t begin() {
+  return 0xFFFFFFFFu;
+}
+inline uint32_t update(uint32_t state, const void* data, size_t len) {
+#if CRC32FAST_HAVE_DMA
+  if (len >= CRC32FAST_DMA_MIN && dmaUsable() && dmaUpdate(state, (const uint8_t*)data, len)) return state;
+#endif
+  return software(state, data, len);
+}
+inline uint32_t finish(uint32_t state) {
+  return state ^ 0xFFFFFFFFu;
+}
+inline uint32_t compute(const void* data, size_t len) {
+  return finish(update(begin(), data, len));
+}
+inline bool dmaActive() {
+#if CRC32FAST_HAVE_DMA
+  return dmaUsable();
+#else
+  return false;
+#endif
+}
+
+class Crc32 {
+public:
+  void reset() {
+    _s = begin();
+  }
+  void update(const void* data, size_t len) {
+    _s = CRC32Fast::update(_s, data, len);
+  }
+  uint32_t value() const {
+    return finish(_s);
+  }
+private:
+  uint32_t _s = 0xFFFFFFFFu;
+};
+
+}  // namespace CRC32Fast
\ No newline at end of file
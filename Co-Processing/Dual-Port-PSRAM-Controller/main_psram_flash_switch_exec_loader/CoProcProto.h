@@ -13,6 +13,7 @@
 #include <stddef.h>
 #include <string.h>
 #include <type_traits>
+#include "CRC32Fast.h"
 
 namespace CoProc {
 
@@ -93,14 +94,9 @@ inline void makeResponseHeader(Frame& h, uint16_t reqCmd, uint32_t seq, uint32_t
 }
 
 // ========== CRC32 (IEEE 802.3) ==========
+// crc seeds the register (callers chain the previous result); see CRC32Fast.h
 inline uint32_t crc32_ieee(const void* data, size_t len, uint32_t crc = 0xFFFFFFFFu) {
-  const uint8_t* p = (const uint8_t*)data;
-  while (len--) {
-    uint32_t c = (crc ^ *p++) & 0xFFu;
-    for (int i = 0; i < 8; ++i) c = (c >> 1) ^ (0xEDB88320u & (-(int)(c & 1u)));
-    crc = (crc >> 8) ^ c;
-  }
-  return crc ^ 0xFFFFFFFFu;
+  return CRC32Fast::finish(CRC32Fast::update(crc, data, len));
 }
 
 // ========== Small PODs ==========
@@ -24,7 +24,7 @@ static bool compileTinyCFileToFile(const char* srcName, const char* dstName) {
     return false;
   }
   uint32_t srcSize = 0;
-  if (!activeFs.getFileSize(srcName, srcSize) || srcSize == 0) {
+  if (!activeFileSize32(srcName, srcSize) || srcSize == 0) {
     Console.println("compile: getFileSize failed or empty source");
     return false;
   }
@@ -11,16 +11,19 @@
 #define MAX_EXEC_ARGS 64
 #endif
 // Simple FS function pointer table injected by the sketch from activeFs binding.
+// The sketch binds it to the volume (never the TieredFS wrappers, which are single-core).
+// Volumes lock internally, so the table could be called from core1, but today it is only
+// used on core0: blobs are loaded there and run on core1 without FS access.
 struct ExecFSTable {
   // The subset needed for exec/coprocessor operations
   bool (*exists)(const char*) = nullptr;
-  bool (*getFileSize)(const char*, uint32_t&) = nullptr;
+  bool (*getFileSize)(const char*, uint64_t&) = nullptr;
   uint32_t (*readFile)(const char*, uint8_t*, uint32_t) = nullptr;
-  uint32_t (*readFileRange)(const char*, uint32_t, uint8_t*, uint32_t) = nullptr;
-  bool (*createFileSlot)(const char*, uint32_t, const uint8_t*, uint32_t) = nullptr;
+  uint32_t (*readFileRange)(const char*, uint64_t, uint8_t*, uint32_t) = nullptr;
+  bool (*createFileSlot)(const char*, uint64_t, const uint8_t*, uint32_t) = nullptr;
   bool (*writeFile)(const char*, const uint8_t*, uint32_t, int) = nullptr;
   bool (*writeFileInPlace)(const char*, const uint8_t*, uint32_t, bool) = nullptr;
-  bool (*getFileInfo)(const char*, uint32_t&, uint32_t&, uint32_t&) = nullptr;
+  bool (*getFileInfo)(const char*, uint64_t&, uint64_t&, uint64_t&) = nullptr;
 };
 // Thumb-call helper; mirrors prior behavior.
 static inline int exechost_call_with_args_thumb(void* entryThumb, uint32_t argc, const int32_t* args) {
@@ -157,7 +160,7 @@ public:
       return false;
     }
     uint32_t sz = 0;
-    if (!_fs.getFileSize(fname, sz) || sz == 0) {
+    if (!fileSize32(fname, sz) || sz == 0) {
       if (_console) _console->println("load: missing/empty");
       return false;
     }
@@ -476,7 +479,7 @@ public:
       return false;
     }
     uint32_t size = 0;
-    if (!_fs.getFileSize(fname, size) || size == 0) {
+    if (!fileSize32(fname, size) || size == 0) {
       if (_console) _console->println("coproc: empty file");
       return false;
     }
@@ -717,7 +720,7 @@ public:
       return false;
     }
     uint32_t size = 0;
-    if (!_fs.getFileSize(fname, size) || size == 0) {
+    if (!fileSize32(fname, size) || size == 0) {
       if (_console) _console->println("coproc script: empty file");
       return false;
     }
@@ -1050,6 +1053,13 @@ private:
     return true;
   }
 private:
+  // Blobs, scripts and the co-processor frames carry 32-bit sizes: false for files of 4 GiB or more
+  bool fileSize32(const char* fname, uint32_t& out) {
+    uint64_t s = 0;
+    if (!_fs.getFileSize(fname, s) || s > 0xFFFFFFFFUL) return false;
+    out = (uint32_t)s;
+    return true;
+  }
   struct ExecJob {
     uintptr_t code;
     uint32_t size;
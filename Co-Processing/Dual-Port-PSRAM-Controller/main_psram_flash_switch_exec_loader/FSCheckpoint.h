@@ -0,0 +1,185 @@
+#pragma once
+#ifndef FS_CHECKPOINT_H
+#define FS_CHECKPOINT_H
+#include <Arduino.h>
+#include "UnifiedSPIMemSimpleFS.h"
+
+/*
+  FSCheckpoint.h - incremental image of a volatile SimpleFS (PSRAM) on a durable one
+
+  - Each source file is kept as FSCKPT_PREFIX + name on the image FS
+  - save(): files whose device granules were not written since the last checkpoint
+    (driver trackChanges() bitmap) or whose size + CRC-32 already match are skipped;
+    changed files on NOR/PSRAM images are patched chunk by chunk (only differing bytes
+    are written), everything else is streamed whole with writeFileFrom(); image files
+    whose source is gone are deleted. The bitmap is taken and cleared atomically when the run
+    starts (writes from the other core meanwhile stay marked) and merged back if it fails.
+  - restore(): streams every image file back (FSCKPT_CHUNK-sized transfers), skipping
+    files that already match, then clears the change bitmap
+  - Names starting with FSCKPT_SKIP_PREFIX (tier mirrors) are never saved
+*/
+
+#ifndef FSCKPT_PREFIX
+#define FSCKPT_PREFIX "@ck/"
+#endif
+#ifndef FSCKPT_SKIP_PREFIX
+#define FSCKPT_SKIP_PREFIX "^"
+#endif
+#ifndef FSCKPT_CHUNK
+#define FSCKPT_CHUNK 2048  // compare/patch granularity (two buffers of this size)
+#endif
+
+namespace FSCheckpoint {
+
+struct Stats {
+  uint32_t files = 0;      // source files considered
+  uint32_t unchanged = 0;  // nothing written
+  uint32_t patched = 0;    // updated in place, changed extents only
+  uint32_t copied = 0;     // written whole
+  uint32_t deleted = 0;    // image entries without a source
+  uint32_t skipped = 0;    // name too long for the prefix
+  uint32_t failed = 0;
+  uint32_t bytes = 0;      // payload bytes written
+  uint32_t ms = 0;
+};
+
+struct Reader {
+  UnifiedSPIMemSimpleFS* fs;
+  const char* name;
+  static bool pull(void* ctx, uint64_t off, uint8_t* buf, uint32_t len) {
+    Reader* r = static_cast<Reader*>(ctx);
+    return r->fs->readFileRange(r->name, off, buf, len) == len;
+  }
+};
+
+inline bool imageName(char* out, size_t cap, const char* name) {
+  int n = snprintf(out, cap, "%s%s", FSCKPT_PREFIX, name);
+  return n > 0 && (size_t)n < cap;
+}
+inline bool sameCrc(UnifiedSPIMemSimpleFS& a, const char* an, UnifiedSPIMemSimpleFS& b, const char* bn) {
+  uint32_t ca = 0, cb = 0;
+  return a.getFileCrc(an, ca) && b.getFileCrc(bn, cb) && ca == cb;
+}
+
+// Write only the chunks of src:name that changed (per chg, from takeChanges()) and differ from
+// img:in (same size, plain files)
+inline bool patch(UnifiedSPIMemSimpleFS& src, const uint8_t* chg, const char* name, UnifiedSPIMemSimpleFS& img, const char* in, uint32_t size, uint8_t* a,
+                  uint8_t* b, Stats& st) {
+  uint32_t addr = 0, stored = 0, cap = 0;
+  if (!src.getFileInfo(name, addr, stored, cap)) return false;
+  for (uint32_t off = 0; off < size; off += FSCKPT_CHUNK) {
+    const uint32_t n = min<uint32_t>(FSCKPT_CHUNK, size - off);
+    if (!src.changedIn(chg, addr + off, n)) continue;
+    if (src.readFileRange(name, off, a, n) != n || img.readFileRange(in, off, b, n) != n) return false;
+    uint32_t lo = 0, hi = n;
+    while (lo < n && a[lo] == b[lo]) ++lo;
+    if (lo == n) continue;
+    while (hi > lo && a[hi - 1] == b[hi - 1]) --hi;
+    if (!img.writeFileRange(in, off + lo, a + lo, hi - lo)) return false;
+    st.bytes += hi - lo;
+  }
+  return true;
+}
+
+inline bool save(UnifiedSPIMemSimpleFS& src, UnifiedSPIMemSimpleFS& img, Stats& st) {
+  st = Stats();
+  const uint32_t t0 = millis();
+  src.sync();
+  uint8_t* a = (uint8_t*)malloc(FSCKPT_CHUNK);
+  uint8_t* b = (uint8_t*)malloc(FSCKPT_CHUNK);
+  if (!a || !b) {
+    free(a);
+    free(b);
+    return false;
+  }
+  uint8_t* chg = src.takeChanges();
+  const size_t prefixLen = strlen(FSCKPT_PREFIX);
+  char in[UnifiedSimpleFS_Generic<UnifiedMemFSDriver>::MAX_NAME + 1];
+  for (size_t i = 0; i < src.fileSlots(); ++i) {
+    const char* name = nullptr;
+    uint32_t size = 0;
+    if (!src.fileAt(i, name, size) || strncmp(name, FSCKPT_SKIP_PREFIX, strlen(FSCKPT_SKIP_PREFIX)) == 0) continue;
+    st.files++;
+    if (!imageName(in, sizeof(in), name)) {
+      st.skipped++;
+      continue;
+    }
+    uint32_t addr = 0, stored = 0, cap = 0, isz = 0, x = 0;
+    bool srcZ = false, imgZ = false;
+    const bool have = img.getFileSize(in, isz) && isz == size;
+    src.getFileInfo(name, addr, stored, cap);
+    if (have && (!src.changedIn(chg, addr, stored) || sameCrc(src, name, img, in))) {
+      st.unchanged++;
+      continue;
+    }
+    src.getStoredSize(name, x, srcZ);
+    img.getStoredSize(in, x, imgZ);
+    const uint32_t before = st.bytes;
+    bool ok;
+    if (have && !srcZ && !imgZ && img.canUpdateInPlace()) {
+      ok = patch(src, chg, name, img, in, size, a, b, st);
+      if (ok && st.bytes == before) st.unchanged++;
+      else if (ok) st.patched++;
+    } else {
+      Reader r = { &src, name };
+      ok = img.writeFileFrom(in, size, &Reader::pull, &r);
+      if (ok) {
+        st.copied++;
+        st.bytes += size;
+      }
+    }
+    if (!ok) st.failed++;
+    yield();
+  }
+  // Drop image files whose source was deleted
+  for (size_t i = 0; i < img.fileSlots(); ++i) {
+    const char* name = nullptr;
+    uint32_t size = 0;
+    if (!img.fileAt(i, name, size) || strncmp(name, FSCKPT_PREFIX, prefixLen) != 0) continue;
+    if (src.exists(name + prefixLen)) continue;
+    strncpy(in, name, sizeof(in) - 1);
+    in[sizeof(in) - 1] = 0;
+    if (img.deleteFile(in)) st.deleted++;
+    else st.failed++;
+  }
+  free(a);
+  free(b);
+  img.sync();
+  if (st.failed == 0) src.dropChanges(chg);
+  else src.mergeChanges(chg);
+  st.ms = millis() - t0;
+  return st.failed == 0;
+}
+
+inline bool restore(UnifiedSPIMemSimpleFS& img, UnifiedSPIMemSimpleFS& dst, Stats& st) {
+  st = Stats();
+  const uint32_t t0 = millis();
+  const size_t prefixLen = strlen(FSCKPT_PREFIX);
+  for (size_t i = 0; i < img.fileSlots(); ++i) {
+    const char* in = nullptr;
+    uint32_t size = 0, dsz = 0;
+    if (!img.fileAt(i, in, size) || strncmp(in, FSCKPT_PREFIX, prefixLen) != 0) continue;
+    const char* name = in + prefixLen;
+    st.files++;
+    if (dst.getFileSize(name, dsz) && dsz == size && sameCrc(img, in, dst, name)) {
+      st.unchanged++;
+      continue;
+    }
+    Reader r = { &img, in };
+    if (dst.writeFileFrom(name, size, &Reader::pull, &r)) {
+      st.copied++;
+      st.bytes += size;
+    } else {
+      st.failed++;
+    }
+    yield();
+  }
+  dst.sync();
+  if (st.failed == 0) dst.clearChanges();
+  st.ms = millis() - t0;
+  return st.failed == 0;
+}
+
+}  // namespace FSCheckpoint
+
+#endif  // FS_CHECKPOINT_H
\ No newline at end of file
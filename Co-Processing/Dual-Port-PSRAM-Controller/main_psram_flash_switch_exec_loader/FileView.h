@@ -0,0 +1,150 @@
+#pragma once
+#ifndef FILE_VIEW_H
+#define FILE_VIEW_H
+#include <Arduino.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+  FileView.h - read-only random access to a stored file through a few cached pages
+
+  - Pages are fetched on demand with a readFileRange-style callback, so one view works
+    over any backend (activeFs, ExecFSTable, a facade wrapper); nothing is materialised
+  - operator[] returns one byte, span() a pointer into a cached page, read() copies out
+  - RAM use is PAGE_SIZE x PAGES; the least recently used page is replaced
+  - Views do not see later writes to the file; call invalidate() (or reopen) after one
+
+  Usage:
+    static FileView<> v;
+    if (v.open("big.bin", activeFs.getFileSize, activeFs.readFileRange)) {
+      uint8_t b = v[12345];
+      uint32_t n = 64;
+      const uint8_t* p = v.span(4096, n);  // n trimmed to what is contiguous in the page
+    }
+*/
+
+#ifndef FILEVIEW_MAX_NAME
+#define FILEVIEW_MAX_NAME 64
+#endif
+
+template<uint32_t PAGE_SIZE = 256, uint8_t PAGES = 4>
+class FileView {
+public:
+  static_assert((PAGE_SIZE & (PAGE_SIZE - 1)) == 0, "FileView: PAGE_SIZE must be a power of two");
+  static_assert(PAGES > 0, "FileView: need at least one page");
+  typedef bool (*SizeFn)(const char*, uint64_t&);
+  typedef uint32_t (*ReadRangeFn)(const char*, uint64_t, uint8_t*, uint32_t);
+
+  FileView() {
+    _name[0] = '\0';
+    invalidate();
+  }
+  bool open(const char* name, SizeFn sizeFn, ReadRangeFn readFn) {
+    close();
+    if (!name || !sizeFn || !readFn) return false;
+    size_t n = strlen(name);
+    if (n == 0 || n >= sizeof(_name)) return false;
+    uint64_t sz = 0;
+    if (!sizeFn(name, sz)) return false;
+    memcpy(_name, name, n + 1);
+    _size = sz;
+    _read = readFn;
+    return true;
+  }
+  void close() {
+    _read = nullptr;
+    _size = 0;
+    _name[0] = '\0';
+    invalidate();
+  }
+  bool isOpen() const {
+    return _read != nullptr;
+  }
+  uint64_t size() const {
+    return _size;
+  }
+  const char* name() const {
+    return _name;
+  }
+  // Drop every cached page (the file was rewritten behind the view)
+  void invalidate() {
+    for (uint8_t i = 0; i < PAGES; ++i) _valid[i] = false;
+  }
+  // Byte at off; 0 past the end or on a read error
+  uint8_t operator[](uint64_t off) {
+    const uint8_t* p = page(off);
+    return p ? p[off & (PAGE_SIZE - 1)] : 0;
+  }
+  // Pointer to len bytes at off. len is trimmed to the bytes contiguous in one page (and the
+  // file); nullptr/0 on error. Valid until PAGES further pages have been fetched.
+  const uint8_t* span(uint64_t off, uint32_t& len) {
+    const uint8_t* p = page(off);
+    if (!p) {
+      len = 0;
+      return nullptr;
+    }
+    uint32_t inPage = (uint32_t)(off & (PAGE_SIZE - 1));
+    uint32_t avail = PAGE_SIZE - inPage;
+    if (avail > _size - off) avail = _size - off;
+    if (len > avail) len = avail;
+    return p + inPage;
+  }
+  // Copy [off, off+len) across pages; returns bytes copied
+  uint32_t read(uint64_t off, uint8_t* dst, uint32_t len) {
+    uint32_t done = 0;
+    while (done < len) {
+      uint32_t n = len - done;
+      const uint8_t* p = span(off + done, n);
+      if (!p || n == 0) break;
+      memcpy(dst + done, p, n);
+      done += n;
+    }
+    return done;
+  }
+  uint32_t hits() const {
+    return _hits;
+  }
+  uint32_t misses() const {
+    return _misses;
+  }
+private:
+  const uint8_t* page(uint64_t off) {
+    if (!_read || off >= _size) return nullptr;
+    const uint64_t base = off & ~(uint64_t)(PAGE_SIZE - 1);
+    for (uint8_t i = 0; i < PAGES; ++i) {
+      if (_valid[i] && _base[i] == base) {
+        _tick[i] = ++_clock;
+        _hits++;
+        return _data[i];
+      }
+    }
+    uint8_t victim = 0;
+    for (uint8_t i = 0; i < PAGES; ++i) {
+      if (!_valid[i]) {
+        victim = i;
+        break;
+      }
+      if (_tick[i] < _tick[victim]) victim = i;
+    }
+    _misses++;
+    const uint32_t n = (uint32_t)min<uint64_t>(_size - base, PAGE_SIZE);
+    _valid[victim] = false;
+    if (_read(_name, base, _data[victim], n) != n) return nullptr;
+    _base[victim] = base;
+    _tick[victim] = ++_clock;
+    _valid[victim] = true;
+    return _data[victim];
+  }
+  char _name[FILEVIEW_MAX_NAME];
+  uint64_t _size = 0;
+  ReadRangeFn _read = nullptr;
+  uint8_t _data[PAGES][PAGE_SIZE];
+  uint64_t _base[PAGES];
+  uint32_t _tick[PAGES];
+  bool _valid[PAGES];
+  uint32_t _clock = 0;
+  uint32_t _hits = 0;
+  uint32_t _misses = 0;
+};
+
+#endif  // FILE_VIEW_H
\ No newline at end of file
@@ -0,0 +1,344 @@
+#pragma once
+#ifndef KV_STORE_H
+#define KV_STORE_H
+#include <Arduino.h>
+#include "UnifiedSPIMemSimpleFS.h"
+
+/*
+  KVStore.h - log-structured key/value store inside one SimpleFS slot
+
+  - The slot file (KVSTORE_SLOT) is two halves of KVSTORE_HALF bytes; the active half is
+    the one with a valid header and the newest generation
+  - put()/del() append one record to the active half with writeFileRange(): the slot keeps
+    its size, so the FS appends no directory record and the bytes land on erased flash
+    (program only, no erase on the hot path). A put with the stored value is a no-op.
+  - A RAM hash table (KVSTORE_MAX_KEYS keys) maps each key to its newest record
+  - When the active half is full, the live records are copied to the other half (one
+    erase + program) and its header is written last, so a reset mid-compaction keeps
+    the old half
+  - Needs in-place range writes (NOR, PSRAM); begin() fails on SPI-NAND
+  - begin(fs, false) only opens an existing store (read paths); begin(fs) creates the slot
+
+  Record: klen, vlen (BE16, 0xFFFF = deleted), 0xA5, CRC-32 (BE) of the first three bytes
+  + key + value, then key and value. Records failing the CRC are skipped.
+
+  Usage:
+    static KVStore kv;
+    if (kv.begin(fs)) kv.put("boot.count", &n, sizeof(n));
+    uint16_t len = 0;
+    if (kv.begin(fs, false) && kv.get("boot.count", &n, sizeof(n), len)) { ... }  // never writes
+*/
+
+#ifndef KVSTORE_SLOT
+#define KVSTORE_SLOT "@kv"
+#endif
+#ifndef KVSTORE_HALF
+#define KVSTORE_HALF 4096UL  // bytes per log half (one NOR sector)
+#endif
+#ifndef KVSTORE_MAX_KEYS
+#define KVSTORE_MAX_KEYS 64  // live keys in the RAM index
+#endif
+#ifndef KVSTORE_KEY_MAX
+#define KVSTORE_KEY_MAX 32
+#endif
+#ifndef KVSTORE_VALUE_MAX
+#define KVSTORE_VALUE_MAX 1024
+#endif
+
+class KVStore {
+public:
+  struct Stats {
+    uint32_t puts = 0;
+    uint32_t unchanged = 0;  // put with the stored value, nothing written
+    uint32_t dels = 0;
+    uint32_t compactions = 0;
+    uint32_t skipped = 0;  // records failing the CRC at load
+  };
+  typedef bool (*IterFn)(void* ctx, const char* key, uint16_t vlen);
+
+  // Open (creating the slot if needed) and index the active half
+  // create: make the slot when it is missing (false: fail instead, nothing is written)
+  bool begin(UnifiedSPIMemSimpleFS& fs, bool create = true) {
+    _fs = nullptr;
+    if (!fs.canUpdateInPlace()) return false;
+    uint32_t size = 0;
+    if (!fs.exists(KVSTORE_SLOT) && !(create && createSlot(fs))) return false;
+    if (!fs.getFileSize(KVSTORE_SLOT, size) || size != 2 * KVSTORE_HALF) return false;
+    uint32_t cap = 0;
+    if (!fs.getFileInfo(KVSTORE_SLOT, _addr, size, cap)) return false;
+    _fs = &fs;
+    uint32_t g0 = 0, g1 = 0;
+    const bool v0 = readHeader(0, g0), v1 = readHeader(1, g1);
+    if (!v0 && !v1) {
+      _fs = nullptr;
+      return false;
+    }
+    _active = (v0 && v1) ? ((int32_t)(g1 - g0) > 0 ? 1 : 0) : (v1 ? 1 : 0);
+    _gen = _active ? g1 : g0;
+    if (!load()) {
+      _fs = nullptr;
+      return false;
+    }
+    return true;
+  }
+  // Still attached to fs and its slot (false after a format or a rewrite of the slot)
+  bool bound(UnifiedSPIMemSimpleFS& fs) {
+    uint32_t a = 0, s = 0, c = 0;
+    return _fs == &fs && fs.getFileInfo(KVSTORE_SLOT, a, s, c) && a == _addr;
+  }
+  bool put(const char* key, const void* val, uint16_t vlen) {
+    const size_t klen = key ? strlen(key) : 0;
+    if (!_fs || klen == 0 || klen > KVSTORE_KEY_MAX || vlen > KVSTORE_VALUE_MAX || (vlen && !val)) return false;
+    const uint32_t h = hash(key);
+    const uint32_t vcrc = CRC32Fast::compute(val, vlen);
+    Slot* s = find(key, h);
+    if (s && s->vlen == vlen && s->vcrc == vcrc) {
+      _st.unchanged++;
+      return true;
+    }
+    if (!s && _live >= KVSTORE_MAX_KEYS) return false;
+    if (!append(key, (uint8_t)klen, (const uint8_t*)val, vlen, h, vcrc)) return false;
+    _st.puts++;
+    return true;
+  }
+  // Copies up to cap bytes; vlen gets the stored length
+  bool get(const char* key, void* buf, uint16_t cap, uint16_t& vlen) {
+    if (!_fs || !key) return false;
+    Slot* s = find(key, hash(key));
+    if (!s) return false;
+    vlen = s->vlen;
+    const uint16_t n = min<uint16_t>(cap, s->vlen);
+    return n == 0 || _fs->readFileRange(KVSTORE_SLOT, base() + s->off + HDR + s->klen, (uint8_t*)buf, n) == n;
+  }
+  bool exists(const char* key) {
+    return _fs && key && find(key, hash(key)) != nullptr;
+  }
+  bool del(const char* key) {
+    if (!_fs || !key) return false;
+    const uint32_t h = hash(key);
+    if (!find(key, h)) return false;
+    if (!append(key, (uint8_t)strlen(key), nullptr, DELETED, h, 0)) return false;
+    _st.dels++;
+    return true;
+  }
+  // Calls fn for every live key until it returns false
+  void iter(IterFn fn, void* ctx) {
+    if (!_fs || !fn) return;
+    char k[KVSTORE_KEY_MAX + 1];
+    for (uint16_t i = 0; i < TABLE; ++i) {
+      const Slot& s = _t[i];
+      if (s.state != USED) continue;
+      if (_fs->readFileRange(KVSTORE_SLOT, base() + s.off + HDR, (uint8_t*)k, s.klen) != s.klen) continue;
+      k[s.klen] = 0;
+      if (!fn(ctx, k, s.vlen)) return;
+    }
+  }
+  // Rewrite the live records into the other half
+  bool compact() {
+    if (!_fs) return false;
+    uint8_t* buf = (uint8_t*)malloc(KVSTORE_HALF);
+    if (!buf) return false;
+    memset(buf, 0xFF, KVSTORE_HALF);
+    uint32_t pos = HALF_HDR;
+    bool ok = true;
+    for (uint16_t i = 0; ok && i < TABLE; ++i) {
+      Slot& s = _t[i];
+      if (s.state != USED) continue;
+      const uint32_t len = HDR + s.klen + s.vlen;
+      ok = _fs->readFileRange(KVSTORE_SLOT, base() + s.off, buf + pos, len) == len;
+      s.off = (uint16_t)pos;
+      pos += len;
+    }
+    const uint8_t next = _active ^ 1;
+    const uint32_t off = next * KVSTORE_HALF;
+    // Body first (header bytes left erased), header last: a torn copy is never selected
+    ok = ok && _fs->writeFileRange(KVSTORE_SLOT, off, buf, KVSTORE_HALF);
+    uint8_t hdr[HALF_HDR];
+    memcpy(hdr, MAGIC, 4);
+    wr32(hdr + 4, _gen + 1);
+    ok = ok && _fs->writeFileRange(KVSTORE_SLOT, off, hdr, HALF_HDR);
+    free(buf);
+    if (!ok) {
+      load();  // offsets were rewritten for the new half; reindex the old one
+      return false;
+    }
+    _active = next;
+    _gen++;
+    _end = pos;
+    _st.compactions++;
+    return true;
+  }
+  size_t count() const {
+    return _live;
+  }
+  uint32_t usedBytes() const {
+    return _end;
+  }
+  uint32_t freeBytes() const {
+    return KVSTORE_HALF - _end;
+  }
+  uint32_t generation() const {
+    return _gen;
+  }
+  const Stats& stats() const {
+    return _st;
+  }
+
+private:
+  static const uint32_t HDR = 8;       // record header
+  static const uint32_t HALF_HDR = 8;  // "KVL1" + generation
+  static const uint16_t DELETED = 0xFFFF;
+  static const uint16_t TABLE = KVSTORE_MAX_KEYS * 2;  // open addressing, load <= 1/2
+  static constexpr const char* MAGIC = "KVL1";
+  enum : uint8_t { EMPTY = 0,
+                   USED = 1,
+                   GONE = 2 };
+  struct Slot {
+    uint32_t hash;
+    uint32_t vcrc;
+    uint16_t off;  // record offset in the active half
+    uint16_t vlen;
+    uint8_t klen;
+    uint8_t state;
+  };
+
+  static uint32_t hash(const char* k) {
+    uint32_t h = 2166136261u;  // FNV-1a
+    while (*k) h = (h ^ (uint8_t)*k++) * 16777619u;
+    return h;
+  }
+  static void wr32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+  }
+  static uint32_t rd32(const uint8_t* p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+  }
+  uint32_t base() const {
+    return (uint32_t)_active * KVSTORE_HALF;
+  }
+  static bool createSlot(UnifiedSPIMemSimpleFS& fs) {
+    uint8_t* buf = (uint8_t*)malloc(2 * KVSTORE_HALF);
+    if (!buf) return false;
+    memset(buf, 0xFF, 2 * KVSTORE_HALF);
+    memcpy(buf, MAGIC, 4);
+    wr32(buf + 4, 1);
+    bool ok = fs.createFileSlot(KVSTORE_SLOT, 2 * KVSTORE_HALF, buf, 2 * KVSTORE_HALF);
+    free(buf);
+    return ok;
+  }
+  bool readHeader(uint8_t half, uint32_t& gen) {
+    uint8_t h[HALF_HDR];
+    if (_fs->readFileRange(KVSTORE_SLOT, half * KVSTORE_HALF, h, HALF_HDR) != HALF_HDR || memcmp(h, MAGIC, 4) != 0) return false;
+    gen = rd32(h + 4);
+    return true;
+  }
+  static uint32_t recordCrc(const uint8_t* hdr, const char* key, uint8_t klen, const uint8_t* val, uint16_t vlen) {
+    uint32_t c = CRC32Fast::update(CRC32Fast::begin(), hdr, 3);
+    c = CRC32Fast::update(c, key, klen);
+    if (vlen != DELETED) c = CRC32Fast::update(c, val, vlen);
+    return CRC32Fast::finish(c);
+  }
+  // Rebuild the index from the active half
+  bool load() {
+    memset(_t, 0, sizeof(_t));
+    _live = 0;
+    uint8_t* buf = (uint8_t*)malloc(KVSTORE_HALF);
+    if (!buf) return false;
+    if (_fs->readFileRange(KVSTORE_SLOT, base(), buf, KVSTORE_HALF) != KVSTORE_HALF) {
+      free(buf);
+      return false;
+    }
+    uint32_t pos = HALF_HDR;
+    while (pos + HDR <= KVSTORE_HALF && buf[pos] != 0xFF) {
+      const uint8_t* r = buf + pos;
+      const uint8_t klen = r[0];
+      const uint16_t vlen = (uint16_t)(r[1] << 8 | r[2]);
+      const uint32_t len = HDR + klen + (vlen == DELETED ? 0 : vlen);
+      if (klen == 0 || klen > KVSTORE_KEY_MAX || r[3] != 0xA5 || pos + len > KVSTORE_HALF) break;  // torn header: log ends
+      const char* key = (const char*)r + HDR;
+      const uint8_t* val = r + HDR + klen;
+      if (rd32(r + 4) != recordCrc(r, key, klen, val, vlen)) {
+        _st.skipped++;
+      } else {
+        char k[KVSTORE_KEY_MAX + 1];
+        memcpy(k, key, klen);
+        k[klen] = 0;
+        index(k, hash(k), klen, (uint16_t)pos, vlen, vlen == DELETED ? 0 : CRC32Fast::compute(val, vlen));
+      }
+      pos += len;
+    }
+    _end = pos;
+    free(buf);
+    return true;
+  }
+  bool keyAt(const Slot& s, const char* key) {
+    char k[KVSTORE_KEY_MAX];
+    return _fs->readFileRange(KVSTORE_SLOT, base() + s.off + HDR, (uint8_t*)k, s.klen) == s.klen && memcmp(k, key, s.klen) == 0;
+  }
+  Slot* find(const char* key, uint32_t h) {
+    const uint8_t klen = (uint8_t)strlen(key);
+    for (uint16_t n = 0, i = h % TABLE; n < TABLE; ++n, i = (i + 1) % TABLE) {
+      Slot& s = _t[i];
+      if (s.state == EMPTY) return nullptr;
+      if (s.state == USED && s.hash == h && s.klen == klen && keyAt(s, key)) return &s;
+    }
+    return nullptr;
+  }
+  // Point key at the record at off (vlen DELETED drops it)
+  void index(const char* key, uint32_t h, uint8_t klen, uint16_t off, uint16_t vlen, uint32_t vcrc) {
+    Slot* s = find(key, h);
+    if (vlen == DELETED) {
+      if (s) {
+        s->state = GONE;
+        _live--;
+      }
+      return;
+    }
+    if (!s) {
+      if (_live >= KVSTORE_MAX_KEYS) return;
+      uint16_t i = h % TABLE;
+      while (_t[i].state == USED) i = (i + 1) % TABLE;
+      s = &_t[i];
+      s->state = USED;
+      _live++;
+    }
+    s->hash = h;
+    s->vcrc = vcrc;
+    s->off = off;
+    s->vlen = vlen;
+    s->klen = klen;
+  }
+  bool append(const char* key, uint8_t klen, const uint8_t* val, uint16_t vlen, uint32_t h, uint32_t vcrc) {
+    const uint32_t len = HDR + klen + (vlen == DELETED ? 0 : vlen);
+    if (_end + len > KVSTORE_HALF && (!compact() || _end + len > KVSTORE_HALF)) return false;
+    uint8_t* r = (uint8_t*)malloc(len);
+    if (!r) return false;
+    r[0] = klen;
+    r[1] = (uint8_t)(vlen >> 8);
+    r[2] = (uint8_t)vlen;
+    r[3] = 0xA5;
+    wr32(r + 4, recordCrc(r, key, klen, val, vlen));
+    memcpy(r + HDR, key, klen);
+    if (vlen != DELETED && vlen) memcpy(r + HDR + klen, val, vlen);
+    const bool ok = _fs->writeFileRange(KVSTORE_SLOT, base() + _end, r, len);
+    free(r);
+    if (!ok) return false;
+    index(key, h, klen, (uint16_t)_end, vlen, vcrc);
+    _end += len;
+    return true;
+  }
+
+  UnifiedSPIMemSimpleFS* _fs = nullptr;
+  uint32_t _addr = 0;  // slot address when bound
+  uint8_t _active = 0;
+  uint32_t _gen = 0;
+  uint32_t _end = 0;  // append offset in the active half
+  Slot _t[TABLE] = {};
+  size_t _live = 0;
+  Stats _st;
+};
+
+#endif  // KV_STORE_H
\ No newline at end of file
@@ -0,0 +1,243 @@
+#pragma once
+#ifndef RING_FILE_H
+#define RING_FILE_H
+#include <Arduino.h>
+#include "UnifiedSPIMemSimpleFS.h"
+
+/*
+  RingFile.h - fixed-capacity circular log of sequence-stamped records in one SimpleFS slot
+
+  - create() makes a fixed-size file (createFixedFile) of N >= 3 sectors; a sector is the
+    device erase unit (RINGFILE_SECTOR on PSRAM). The file never grows, so appends add no
+    directory records.
+  - Record seq s lives at sector (s / P) % N, slot s % P (P records per sector); reads by
+    sequence number are O(1)
+  - Entering a sector stamps its header; the next sector is then erased, so one sector is
+    always erased ahead of the writer and appends are program-only. The ring keeps the last
+    N-1 sectors of records.
+  - open() finds the head by binary search: sector headers increase up to the head sector,
+    then drop (erased or an older lap); inside that sector the programmed slots form a prefix.
+    A torn last record fails its CRC and is skipped by readers.
+  - Needs in-place range writes (NOR, PSRAM); create()/open() fail on SPI-NAND
+
+  Sector header: "RG", record size (BE16), seq of its first slot (BE32).
+  Slot: seq (BE32), record (zero padded), CRC-32 (BE) of seq + record.
+
+  Usage:
+    RingFile::create(fs, "samples", 64 * 1024, 16);
+    static RingFile ring;
+    if (ring.open(fs, "samples")) ring.append(&sample, sizeof(sample));
+*/
+
+#ifndef RINGFILE_SECTOR
+#define RINGFILE_SECTOR 4096UL  // sector size when the device has no erase unit (PSRAM)
+#endif
+#ifndef RINGFILE_NAME_MAX
+#define RINGFILE_NAME_MAX 32
+#endif
+
+class RingFile {
+public:
+  struct Stats {
+    uint32_t appends = 0;
+    uint32_t sectors = 0;  // sectors entered (each erases the one ahead)
+    uint32_t torn = 0;     // reads failing the CRC
+    uint32_t probes = 0;   // device reads of the last open()
+  };
+
+  static bool create(UnifiedSPIMemSimpleFS& fs, const char* name, uint32_t capacity, uint16_t recordSize) {
+    if (!fs.canUpdateInPlace() || !name || strlen(name) > RINGFILE_NAME_MAX || recordSize == 0) return false;
+    const uint32_t sec = sectorSize(fs);
+    if (SEC_HDR + slotLen(recordSize) > sec) return false;
+    uint32_t n = (capacity + sec - 1) / sec;
+    if (n < 3) n = 3;
+    if (!fs.createFixedFile(name, n * sec)) return false;
+    uint8_t h[SEC_HDR];
+    header(h, recordSize, 0);
+    return fs.writeFileRange(name, 0, h, SEC_HDR);
+  }
+
+  bool open(UnifiedSPIMemSimpleFS& fs, const char* name) {
+    _fs = nullptr;
+    _st.probes = 0;
+    uint32_t size = 0;
+    if (!fs.canUpdateInPlace() || !name || strlen(name) > RINGFILE_NAME_MAX || !fs.getFileSize(name, size)) return false;
+    strcpy(_name, name);
+    _fs = &fs;
+    _sec = sectorSize(fs);
+    _n = size / _sec;
+    // Sector 0 or 1 always holds a header (only the one ahead of the writer is erased)
+    uint8_t h[SEC_HDR];
+    uint32_t r = 0, base0 = 0;
+    if (_n < 3 || size % _sec || !(readRecSize(0, h) || readRecSize(++r, h))) {
+      _fs = nullptr;
+      return false;
+    }
+    if (!sectorBase(r, base0)) {
+      _fs = nullptr;
+      return false;
+    }
+    // Last sector of the newest lap
+    uint32_t lo = r, hi = _n - 1, b = 0;
+    while (lo < hi) {
+      const uint32_t mid = (lo + hi + 1) / 2;
+      if (sectorBase(mid, b) && b >= base0) lo = mid;
+      else hi = mid - 1;
+    }
+    sectorBase(lo, b);
+    // Programmed slots of that sector
+    uint32_t sl = 0, sh = _per;
+    while (sl < sh) {
+      const uint32_t mid = (sl + sh) / 2;
+      if (slotUsed(lo, mid)) sl = mid + 1;
+      else sh = mid;
+    }
+    _head = b + sl;
+    // A reset may have hit between stamping a sector and erasing the next one
+    if (!_fs->eraseFileRange(_name, ((lo + 1) % _n) * _sec, _sec)) {
+      _fs = nullptr;
+      return false;
+    }
+    return true;
+  }
+  bool isOpen() const {
+    return _fs != nullptr;
+  }
+  const char* name() const {
+    return _name;
+  }
+
+  // Append one record (len <= recordSize(), the rest is zero padded)
+  bool append(const void* data, uint16_t len) {
+    if (!_fs || len > _rec || (len && !data)) return false;
+    const uint32_t sec = (_head / _per) % _n, slot = _head % _per;
+    const uint32_t off = sec * _sec;
+    if (slot == 0 && !enterSector(sec)) return false;
+    const uint32_t sl = slotLen(_rec);
+    uint8_t* buf = (uint8_t*)malloc(sl);
+    if (!buf) return false;
+    wr32(buf, _head);
+    memcpy(buf + 4, data, len);
+    memset(buf + 4 + len, 0, _rec - len);
+    wr32(buf + 4 + _rec, CRC32Fast::compute(buf, 4 + _rec));
+    const bool ok = _fs->writeFileRange(_name, off + SEC_HDR + slot * sl, buf, sl);
+    free(buf);
+    if (!ok) return false;
+    if (slot == 0 && !_fs->eraseFileRange(_name, ((sec + 1) % _n) * _sec, _sec)) return false;
+    _head++;
+    _st.appends++;
+    return true;
+  }
+  // Record seq (tail() <= seq < head()); false when overwritten, not yet written or torn
+  bool read(uint32_t seq, void* out) {
+    if (!_fs || seq < tail() || seq >= _head) return false;
+    const uint32_t sl = slotLen(_rec);
+    uint8_t* buf = (uint8_t*)malloc(sl);
+    if (!buf) return false;
+    const uint32_t addr = ((seq / _per) % _n) * _sec + SEC_HDR + (seq % _per) * sl;
+    bool ok = _fs->readFileRange(_name, addr, buf, sl) == sl && rd32(buf) == seq && rd32(buf + 4 + _rec) == CRC32Fast::compute(buf, 4 + _rec);
+    if (ok) memcpy(out, buf + 4, _rec);
+    else _st.torn++;
+    free(buf);
+    return ok;
+  }
+  // Next sequence number to be written
+  uint32_t head() const {
+    return _head;
+  }
+  // Oldest sequence number still stored: the last N-1 sectors
+  uint32_t tail() const {
+    if (_head == 0) return 0;
+    const uint32_t last = (_head - 1) / _per;
+    return last >= _n - 2 ? (last - (_n - 2)) * _per : 0;
+  }
+  uint16_t recordSize() const {
+    return _rec;
+  }
+  // Records kept once the ring has wrapped
+  uint32_t capacityRecords() const {
+    return (_n - 1) * _per;
+  }
+  uint32_t sectors() const {
+    return _n;
+  }
+  uint32_t sectorBytes() const {
+    return _sec;
+  }
+  const Stats& stats() const {
+    return _st;
+  }
+
+private:
+  static const uint32_t SEC_HDR = 8;
+  static uint32_t slotLen(uint16_t rec) {
+    return 4 + rec + 4;
+  }
+  static uint32_t sectorSize(UnifiedSPIMemSimpleFS& fs) {
+    const uint32_t e = fs.eraseUnit();
+    return e > 1 ? e : RINGFILE_SECTOR;
+  }
+  static void wr32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+  }
+  static uint32_t rd32(const uint8_t* p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+  }
+  static void header(uint8_t* h, uint16_t rec, uint32_t base) {
+    h[0] = 'R';
+    h[1] = 'G';
+    h[2] = (uint8_t)(rec >> 8);
+    h[3] = (uint8_t)rec;
+    wr32(h + 4, base);
+  }
+  bool readHeader(uint32_t sec, uint8_t* h) {
+    _st.probes++;
+    return _fs->readFileRange(_name, sec * _sec, h, SEC_HDR) == SEC_HDR;
+  }
+  // Take the geometry from the header of sec
+  bool readRecSize(uint32_t sec, uint8_t* h) {
+    if (!readHeader(sec, h) || h[0] != 'R' || h[1] != 'G') return false;
+    _rec = (uint16_t)(h[2] << 8 | h[3]);
+    if (_rec == 0 || SEC_HDR + slotLen(_rec) > _sec) return false;
+    _per = (_sec - SEC_HDR) / slotLen(_rec);
+    return true;
+  }
+  // First seq of a stamped sector (header must match the geometry and position)
+  bool sectorBase(uint32_t sec, uint32_t& base) {
+    uint8_t h[SEC_HDR];
+    if (!readHeader(sec, h) || h[0] != 'R' || h[1] != 'G' || (uint16_t)(h[2] << 8 | h[3]) != _rec) return false;
+    base = rd32(h + 4);
+    return base % _per == 0 && (base / _per) % _n == sec;
+  }
+  bool slotUsed(uint32_t sec, uint32_t slot) {
+    uint8_t s[4];
+    _st.probes++;
+    return _fs->readFileRange(_name, sec * _sec + SEC_HDR + slot * slotLen(_rec), s, 4) == 4 && rd32(s) != 0xFFFFFFFFu;
+  }
+  // Stamp sec for the record at _head; it was erased ahead unless a torn or stale header says otherwise
+  bool enterSector(uint32_t sec) {
+    uint8_t h[SEC_HDR], want[SEC_HDR];
+    header(want, _rec, _head);
+    if (!readHeader(sec, h)) return false;
+    _st.sectors++;
+    if (!memcmp(h, want, SEC_HDR)) return true;
+    bool blank = true;
+    for (uint32_t i = 0; i < SEC_HDR; ++i) blank = blank && h[i] == 0xFF;
+    if (!blank && !_fs->eraseFileRange(_name, sec * _sec, _sec)) return false;
+    return _fs->writeFileRange(_name, sec * _sec, want, SEC_HDR);
+  }
+
+  UnifiedSPIMemSimpleFS* _fs = nullptr;
+  char _name[RINGFILE_NAME_MAX + 1] = {};
+  uint32_t _sec = 0;   // sector bytes
+  uint32_t _n = 0;     // sectors
+  uint32_t _per = 0;   // records per sector
+  uint16_t _rec = 0;   // record bytes
+  uint32_t _head = 0;  // next seq
+  Stats _st;
+};
+
+#endif  // RING_FILE_H
\ No newline at end of file
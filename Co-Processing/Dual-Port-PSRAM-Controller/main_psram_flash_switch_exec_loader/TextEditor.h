@@ -194,33 +194,43 @@ struct NanoEditor {
       modified = false;
       return true;
     }
-    uint32_t sz = 0;
-    if (!activeFs.getFileSize(path, sz)) return false;
-    char* tmp = (char*)malloc(sz + 1);
-    if (!tmp) return false;
-    uint32_t got = activeFs.readFile(path, (uint8_t*)tmp, sz);
-    if (got != sz) {
-      free(tmp);
-      return false;
-    }
-    tmp[sz] = 0;
-    char* p = tmp;
-    while (*p && lineCount < MAX_LINES) {
-      char* e = p;
-      while (*e && *e != '\n' && *e != '\r') ++e;
-      int L = (int)(e - p);
-      if (L >= MAX_COLS) L = MAX_COLS - 1;
-      memcpy(lines[lineCount], p, L);
-      lines[lineCount][L] = 0;
-      lineCount++;
-      while (*e == '\n' || *e == '\r') ++e;
-      p = e;
+    // Paged in through a FileView rather than copied whole into a malloc'd buffer
+    static FileView<> view;
+    if (!view.open(path, activeFs.getFileSize, activeFs.readFileRange)) return false;
+    int L = 0;
+    bool inLine = false, inBreak = false;
+    for (uint64_t off = 0; off < view.size() && lineCount < MAX_LINES;) {
+      uint32_t n = view.size() - off > 0xFFFFFFFFull ? 0xFFFFFFFFu : (uint32_t)(view.size() - off);
+      const uint8_t* p = view.span(off, n);
+      if (!p) {
+        view.close();
+        return false;
+      }
+      off += n;
+      for (uint32_t i = 0; i < n && lineCount < MAX_LINES; ++i) {
+        char c = (char)p[i];
+        if (c == 0) {  // text ends at a NUL
+          off = view.size();
+          break;
+        }
+        if (c == '\n' || c == '\r') {
+          if (!inBreak) lines[lineCount++][L] = 0;  // a run of line breaks ends one line
+          L = 0;
+          inLine = false;
+          inBreak = true;
+        } else {
+          if (L < MAX_COLS - 1) lines[lineCount][L++] = c;
+          inLine = true;
+          inBreak = false;
+        }
+      }
     }
+    if (inLine && lineCount < MAX_LINES) lines[lineCount++][L] = 0;
+    view.close();
     if (lineCount == 0) {
       lineCount = 1;
       lines[0][0] = 0;
     }
-    free(tmp);
     cx = cy = rowOff = colOff = prefCol = 0;
     modified = false;
     return true;
@@ -0,0 +1,344 @@
+#pragma once
+#ifndef TIERED_FS_H
+#define TIERED_FS_H
+#include <Arduino.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+  TieredFS.h - hot-file mirroring from a durable FS (NOR/NAND) into a fast one (PSRAM)
+
+  - The lower FS stays the only durable copy. The upper FS holds one fixed-size pool file
+    (TIERFS_POOL, exactly budget bytes) and mirrors are extents inside it, so the budget
+    bounds the real upper-FS use: one directory entry and one data slot, whatever is
+    promoted or evicted (the SimpleFS data region is append-only, per-file mirrors would
+    leak a slot each). The pool is recreated only when the budget changes.
+  - Reads are counted per file; once a file reaches TIERFS_PROMOTE_READS it is copied
+    up into the first free gap of the pool (colder mirrors are evicted until one fits)
+  - Every read checks the lower file's identity (address, stored size, CRC-32, and the
+    generation the lower FS renews on every write, in-place ones included); a file
+    changed behind the tier (e.g. by fscp or a record store) is dropped back to the lower copy
+  - Whole-file writes through the tier are written through to a live mirror; partial
+    writes and deletes drop it
+  - Counts are halved every TIERFS_DECAY_READS reads so old heat fades
+
+  Usage:
+    static TieredFS tier;
+    tier.attach(lowerOps, upperOps);
+    uint32_t n = tier.readFileRange("big.bin", 0, buf, 256);
+*/
+
+#ifndef TIERFS_MAX_FILES
+#define TIERFS_MAX_FILES 16  // tracked files (read counters + mirror state)
+#endif
+#ifndef TIERFS_NAME_MAX
+#define TIERFS_NAME_MAX 32
+#endif
+#ifndef TIERFS_POOL
+#define TIERFS_POOL "^tier"  // pool file in the upper FS
+#endif
+#ifndef TIERFS_PROMOTE_READS
+#define TIERFS_PROMOTE_READS 4
+#endif
+#ifndef TIERFS_MAX_FILE
+#define TIERFS_MAX_FILE (64UL * 1024UL)  // larger files are never mirrored (promotion buffers the file)
+#endif
+#ifndef TIERFS_BUDGET
+#define TIERFS_BUDGET (256UL * 1024UL)  // default pool size
+#endif
+#ifndef TIERFS_DECAY_READS
+#define TIERFS_DECAY_READS 1024UL
+#endif
+
+// Function table for one tier (fields a tier does not need may stay null)
+struct TierOps {
+  bool (*exists)(const char*) = nullptr;
+  bool (*getFileSize)(const char*, uint64_t&) = nullptr;
+  bool (*getFileInfo)(const char*, uint64_t&, uint64_t&, uint64_t&) = nullptr;
+  bool (*getFileCrc)(const char*, uint32_t&) = nullptr;
+  bool (*getFileGeneration)(const char*, uint32_t&) = nullptr;
+  uint32_t (*readFile)(const char*, uint8_t*, uint32_t) = nullptr;
+  uint32_t (*readFileRange)(const char*, uint64_t, uint8_t*, uint32_t) = nullptr;
+  bool (*createFixedFile)(const char*, uint64_t) = nullptr;
+  bool (*writeFileRange)(const char*, uint64_t, const uint8_t*, uint32_t) = nullptr;
+  bool (*deleteFile)(const char*) = nullptr;
+};
+
+class TieredFS {
+public:
+  struct Entry {
+    char name[TIERFS_NAME_MAX + 1];
+    uint32_t reads;  // decayed access count
+    uint32_t hits;   // reads served by the mirror
+    uint32_t size;   // bytes of the mirror
+    uint32_t off;    // its offset in the pool
+    bool used;
+    bool mirrored;
+    // lower-file identity when mirrored
+    uint64_t addr, stored;
+    uint32_t crc, gen;
+    bool hasCrc, hasGen;
+  };
+  struct Stats {
+    uint32_t reads = 0;
+    uint32_t upperHits = 0;
+    uint32_t promotions = 0;
+    uint32_t evictions = 0;
+    uint32_t invalidations = 0;  // writes/deletes, or the lower file changed underneath
+    uint32_t promoteFails = 0;
+    uint32_t writeThrough = 0;
+  };
+
+  void attach(const TierOps& lower, const TierOps& upper) {
+    _lo = lower;
+    _up = upper;
+    _attached = true;
+    _poolReady = false;
+    reset();
+  }
+  void detach() {
+    _attached = false;
+    reset();
+  }
+  bool attached() const {
+    return _attached;
+  }
+  // Forget every entry; the pool stays in the upper FS and is reused as free space
+  void reset() {
+    for (uint8_t i = 0; i < TIERFS_MAX_FILES; ++i) _e[i].used = false;
+    _used = 0;
+    _sinceDecay = 0;
+  }
+  void resetStats() {
+    _st = Stats();
+  }
+  // Resizing replaces the pool, so every mirror is evicted
+  void setBudget(uint32_t bytes) {
+    if (bytes == _budget) return;
+    while (evictColdest(0xFFFFFFFFu)) {}
+    if (_attached && _up.deleteFile) _up.deleteFile(TIERFS_POOL);
+    _poolReady = false;
+    _budget = bytes;
+  }
+  uint32_t budget() const {
+    return _budget;
+  }
+  uint32_t usedBytes() const {
+    return _used;
+  }
+  const Stats& stats() const {
+    return _st;
+  }
+  uint8_t capacity() const {
+    return TIERFS_MAX_FILES;
+  }
+  const Entry& entry(uint8_t i) const {
+    return _e[i];
+  }
+
+  uint32_t readFile(const char* name, uint8_t* buf, uint32_t sz) {
+    if (!_attached) return 0;
+    Entry* e = touch(name);
+    if (e && e->mirrored && stillValid(e)) {
+      const uint32_t want = sz < e->size ? sz : e->size;
+      if (!want || _up.readFileRange(TIERFS_POOL, e->off, buf, want) == want) {
+        e->hits++;
+        _st.upperHits++;
+        return want;
+      }
+      drop(e);
+    }
+    uint32_t n = _lo.readFile(name, buf, sz);
+    maybePromote(e);
+    return n;
+  }
+  uint32_t readFileRange(const char* name, uint64_t off, uint8_t* buf, uint32_t len) {
+    if (!_attached) return 0;
+    Entry* e = touch(name);
+    if (e && e->mirrored && stillValid(e)) {
+      const uint32_t want = off >= e->size ? 0 : (uint32_t)min<uint64_t>(len, e->size - off);
+      if (!want || _up.readFileRange(TIERFS_POOL, e->off + off, buf, want) == want) {
+        e->hits++;
+        _st.upperHits++;
+        return want;
+      }
+      drop(e);
+    }
+    uint32_t n = _lo.readFileRange(name, off, buf, len);
+    maybePromote(e);
+    return n;
+  }
+  // After a successful whole-file write to the lower FS: refresh a live mirror, else forget it
+  void noteWrite(const char* name, const uint8_t* data, uint32_t size) {
+    Entry* e = find(name);
+    if (!e || !e->mirrored) return;
+    _used -= e->size;
+    e->mirrored = false;
+    uint32_t at = 0;
+    if (size <= TIERFS_MAX_FILE && place(size, at) && storeMirror(at, data, size) && identity(e)) {
+      e->mirrored = true;
+      e->off = at;
+      e->size = size;
+      _used += size;
+      _st.writeThrough++;
+      return;
+    }
+    _st.invalidations++;
+  }
+  // Partial write or delete: the mirror no longer matches
+  void invalidate(const char* name) {
+    Entry* e = find(name);
+    if (e && e->mirrored) drop(e);
+  }
+  // Subtree delete (rmdir -r): every mirror under prefix
+  void invalidatePrefix(const char* prefix) {
+    const size_t lp = strlen(prefix);
+    for (uint8_t i = 0; i < TIERFS_MAX_FILES; ++i)
+      if (_e[i].used && _e[i].mirrored && strncmp(_e[i].name, prefix, lp) == 0) drop(&_e[i]);
+  }
+
+private:
+  Entry* find(const char* name) {
+    for (uint8_t i = 0; i < TIERFS_MAX_FILES; ++i)
+      if (_e[i].used && strcmp(_e[i].name, name) == 0) return &_e[i];
+    return nullptr;
+  }
+  // Count one read of name; allocates an entry (replacing the coldest unmirrored one)
+  Entry* touch(const char* name) {
+    _st.reads++;
+    if (++_sinceDecay >= TIERFS_DECAY_READS) {
+      _sinceDecay = 0;
+      for (uint8_t i = 0; i < TIERFS_MAX_FILES; ++i) _e[i].reads >>= 1;
+    }
+    Entry* e = find(name);
+    if (!e) {
+      if (strlen(name) > TIERFS_NAME_MAX) return nullptr;
+      for (uint8_t i = 0; i < TIERFS_MAX_FILES; ++i) {
+        if (!_e[i].used) {
+          e = &_e[i];
+          break;
+        }
+        if (!_e[i].mirrored && (!e || _e[i].reads < e->reads)) e = &_e[i];
+      }
+      if (!e) return nullptr;  // every slot holds a mirror
+      memset(e, 0, sizeof(*e));
+      strcpy(e->name, name);
+      e->used = true;
+    }
+    e->reads++;
+    return e;
+  }
+  bool identity(Entry* e) {
+    uint64_t cap = 0;
+    if (!_lo.getFileInfo || !_lo.getFileInfo(e->name, e->addr, e->stored, cap)) return false;
+    e->hasCrc = _lo.getFileCrc && _lo.getFileCrc(e->name, e->crc);
+    e->hasGen = _lo.getFileGeneration && _lo.getFileGeneration(e->name, e->gen);
+    return true;
+  }
+  bool stillValid(Entry* e) {
+    uint64_t a = 0, s = 0, cap = 0;
+    uint32_t c = 0, g = 0;
+    bool ok = _lo.getFileInfo && _lo.getFileInfo(e->name, a, s, cap) && a == e->addr && s == e->stored;
+    if (ok) {
+      bool hc = _lo.getFileCrc && _lo.getFileCrc(e->name, c);
+      ok = (hc == e->hasCrc) && (!hc || c == e->crc);
+    }
+    if (ok) {
+      // Same-size in-place writes keep address, size and (absent) CRC: only this moves
+      bool hg = _lo.getFileGeneration && _lo.getFileGeneration(e->name, g);
+      ok = (hg == e->hasGen) && (!hg || g == e->gen);
+    }
+    if (!ok) drop(e);
+    return ok;
+  }
+  void drop(Entry* e) {
+    e->mirrored = false;
+    _used -= e->size;
+    _st.invalidations++;
+  }
+  // Evict the coldest mirror with fewer than maxReads reads
+  bool evictColdest(uint32_t maxReads) {
+    Entry* v = nullptr;
+    for (uint8_t i = 0; i < TIERFS_MAX_FILES; ++i)
+      if (_e[i].used && _e[i].mirrored && _e[i].reads < maxReads && (!v || _e[i].reads < v->reads)) v = &_e[i];
+    if (!v) return false;
+    v->mirrored = false;
+    _used -= v->size;
+    _st.evictions++;
+    return true;
+  }
+  // The pool exists with the current budget as its size (created on first use)
+  bool ensurePool() {
+    if (_poolReady) return true;
+    if (!_up.getFileSize || !_up.createFixedFile || _budget == 0) return false;
+    uint64_t sz = 0;
+    if (_up.getFileSize(TIERFS_POOL, sz)) {
+      if (sz == _budget) return _poolReady = true;
+      if (!_up.deleteFile || !_up.deleteFile(TIERFS_POOL)) return false;
+    }
+    return _poolReady = _up.createFixedFile(TIERFS_POOL, _budget);
+  }
+  // First gap of size bytes between live mirrors
+  bool place(uint32_t size, uint32_t& at) {
+    if (!ensurePool()) return false;
+    at = 0;
+    for (;;) {
+      bool moved = false;
+      for (uint8_t i = 0; i < TIERFS_MAX_FILES; ++i) {
+        const Entry& o = _e[i];
+        if (o.used && o.mirrored && o.size && at < o.off + o.size && o.off < at + size) {
+          at = o.off + o.size;
+          moved = true;
+        }
+      }
+      if (!moved) return (uint64_t)at + size <= _budget;
+    }
+  }
+  bool storeMirror(uint32_t at, const uint8_t* data, uint32_t size) {
+    return !size || (_up.writeFileRange && _up.writeFileRange(TIERFS_POOL, at, data, size));
+  }
+  void maybePromote(Entry* e) {
+    if (!e || e->mirrored || e->reads < TIERFS_PROMOTE_READS) return;
+    uint64_t size64 = 0;
+    if (!_lo.getFileSize || !_lo.getFileSize(e->name, size64) || size64 > TIERFS_MAX_FILE || size64 > _budget) return;
+    const uint32_t size = (uint32_t)size64;
+    // Room is made only from strictly colder mirrors; otherwise wait until this file is hotter
+    uint32_t room = _budget - _used;
+    for (uint8_t i = 0; i < TIERFS_MAX_FILES && room < size; ++i)
+      if (_e[i].used && _e[i].mirrored && _e[i].reads < e->reads) room += _e[i].size;
+    if (room < size) return;
+    uint32_t at = 0;
+    while (!place(size, at)) {
+      if (!_poolReady) {
+        _st.promoteFails++;
+        e->reads = 0;
+        return;
+      }
+      if (!evictColdest(e->reads)) return;  // fragmented: wait until this file is hotter
+    }
+    uint8_t* buf = (uint8_t*)malloc(size ? size : 1);
+    bool ok = buf && _lo.readFile(e->name, buf, size) == size && identity(e) && storeMirror(at, buf, size);
+    free(buf);
+    if (!ok) {
+      _st.promoteFails++;
+      e->reads = 0;  // do not retry on every read
+      return;
+    }
+    e->mirrored = true;
+    e->off = at;
+    e->size = size;
+    _used += size;
+    _st.promotions++;
+  }
+
+  TierOps _lo, _up;
+  Entry _e[TIERFS_MAX_FILES] = {};
+  Stats _st;
+  bool _attached = false;
+  bool _poolReady = false;
+  uint32_t _budget = TIERFS_BUDGET;
+  uint32_t _used = 0;
+  uint32_t _sinceDecay = 0;
+};
+
+#endif  // TIERED_FS_H
\ No newline at end of file
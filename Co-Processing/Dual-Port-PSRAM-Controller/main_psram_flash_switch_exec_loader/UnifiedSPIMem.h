@@ -17,6 +17,15 @@
         * Create a pool (all devices or by type), open/release from pool
     - PSRAM retention:
         * setPreservePsramContents(true) to avoid PSRAM reset during identification
+    - Async program/erase:
+        * MemDevice::submitAsync() + pollAsync() from the main loop; NOR/NAND advance one
+          page/erase unit per poll instead of spinning in waitWhileBusy()/waitReady()
+        * NOR reads preempt an in-flight erase/program via suspend/resume (0x75/0x7A)
+    - Dual-core:
+        * Every device transaction (read/write/erase, async submit/poll, prefetch) and every
+          probe holds busLock(): one recursive mutex for the shared SPI bus, backed by an
+          RP2040 hardware spinlock (pico_sync). Either core may drive a device; the other
+          waits per call.
   Defaults:
     UNIFIED_SPI_INSTANCE = SPI1
     UNIFIED_SPI_CLOCK_HZ = 8 MHz
@@ -43,6 +52,12 @@
 #ifndef UNIFIED_MAX_CS
 #define UNIFIED_MAX_CS 16
 #endif
+#ifndef UNIFIED_SPI_LOCKING
+#define UNIFIED_SPI_LOCKING 1  // 0: single-core builds, locks compile to nothing
+#endif
+#if UNIFIED_SPI_LOCKING && defined(ARDUINO_ARCH_RP2040)
+#include <pico/mutex.h>
+#endif
 // Bind W25Q HW-SPI defaults to unified defaults (unless user overrides)
 #ifndef W25Q_USE_HW_SPI
 #define W25Q_USE_HW_SPI 1
@@ -449,28 +464,76 @@ public:
     while (off < len) {
       size_t pageOff = (addr & 0xFF), pageSpace = 256 - pageOff;
       size_t chunk = (len - off < pageSpace) ? (len - off) : pageSpace;
-      if (!writeEnable()) return false;
-      csLow();
-      beginTx();
-      W25Q_SPI_INSTANCE.transfer((uint8_t)0x02);
-      sendAddr24(addr);
-      for (size_t i = 0; i < chunk; ++i) W25Q_SPI_INSTANCE.transfer(data[off + i]);
-      endTx();
-      csHigh();
+      if (startPageProgram(addr, data + off, chunk) != chunk) return false;
       if (!waitWhileBusy(chunkTimeoutMs)) return false;
       addr += chunk;
       off += chunk;
     }
     return true;
   }
-  bool sectorErase4K(uint32_t addr, uint32_t timeoutMs = 4000) {
+  // Non-blocking primitives (async path): issue the command and return; poll isBusy() for completion.
+  // Programs up to the end of the current 256-byte page; returns bytes issued (0 on WEL failure).
+  size_t startPageProgram(uint32_t addr, const uint8_t* data, size_t len) {
+    size_t pageSpace = 256 - (addr & 0xFF);
+    size_t chunk = (len < pageSpace) ? len : pageSpace;
+    if (!data || chunk == 0 || !writeEnable()) return 0;
+    csLow();
+    beginTx();
+    W25Q_SPI_INSTANCE.transfer((uint8_t)0x02);
+    sendAddr24(addr);
+    for (size_t i = 0; i < chunk; ++i) W25Q_SPI_INSTANCE.transfer(data[i]);
+    endTx();
+    csHigh();
+    return chunk;
+  }
+  // op: 0x20 (4K), 0x52 (32K), 0xD8 (64K)
+  bool startErase(uint8_t op, uint32_t addr) {
     if (!writeEnable()) return false;
     csLow();
     beginTx();
-    W25Q_SPI_INSTANCE.transfer((uint8_t)0x20);
+    W25Q_SPI_INSTANCE.transfer(op);
     sendAddr24(addr);
     endTx();
     csHigh();
+    return true;
+  }
+  uint8_t readStatus2() {
+    csLow();
+    beginTx();
+    W25Q_SPI_INSTANCE.transfer((uint8_t)0x35);
+    uint8_t v = W25Q_SPI_INSTANCE.transfer((uint8_t)0x00);
+    endTx();
+    csHigh();
+    return v;
+  }
+  bool isSuspended() {
+    return (readStatus2() & 0x80) != 0;  // SR2.SUS
+  }
+  // Erase/program suspend (0x75); returns once the array is idle and reads outside the
+  // suspended block are allowed. resume() (0x7A) continues the operation.
+  bool suspend(uint32_t timeoutMs = 2) {
+    command(0x75);
+    return waitWhileBusy(timeoutMs);
+  }
+  void resume() {
+    command(0x7A);
+  }
+  bool sectorErase4K(uint32_t addr, uint32_t timeoutMs = 4000) {
+    return eraseCmd(0x20, addr, timeoutMs);
+  }
+  bool blockErase32K(uint32_t addr, uint32_t timeoutMs = 8000) {
+    return eraseCmd(0x52, addr, timeoutMs);
+  }
+  bool blockErase64K(uint32_t addr, uint32_t timeoutMs = 8000) {
+    return eraseCmd(0xD8, addr, timeoutMs);
+  }
+  bool chipErase(uint32_t timeoutMs = 400000) {
+    if (!writeEnable()) return false;
+    csLow();
+    beginTx();
+    W25Q_SPI_INSTANCE.transfer((uint8_t)0xC7);
+    endTx();
+    csHigh();
     return waitWhileBusy(timeoutMs);
   }
 private:
@@ -493,6 +556,17 @@ private:
     W25Q_SPI_INSTANCE.transfer((uint8_t)(addr >> 8));
     W25Q_SPI_INSTANCE.transfer((uint8_t)addr);
   }
+  inline void command(uint8_t op) {
+    csLow();
+    beginTx();
+    W25Q_SPI_INSTANCE.transfer(op);
+    endTx();
+    csHigh();
+  }
+  bool eraseCmd(uint8_t op, uint32_t addr, uint32_t timeoutMs) {
+    if (!startErase(op, addr)) return false;
+    return waitWhileBusy(timeoutMs);
+  }
 };
 #else  // W25Q_USE_HW_SPI
 #include <inttypes.h>
@@ -579,24 +653,72 @@ public:
     while (off < len) {
       size_t pageOff = (addr & 0xFF), pageSpace = 256 - pageOff;
       size_t chunk = (len - off < pageSpace) ? (len - off) : pageSpace;
-      if (!writeEnable()) return false;
-      csLow();
-      xfer(0x02);
-      sendAddr24(addr);
-      for (size_t i = 0; i < chunk; ++i) xfer(data[off + i]);
-      csHigh();
+      if (startPageProgram(addr, data + off, chunk) != chunk) return false;
       if (!waitWhileBusy(chunkTimeoutMs)) return false;
       addr += chunk;
       off += chunk;
     }
     return true;
   }
-  bool sectorErase4K(uint32_t addr, uint32_t timeoutMs = 4000) {
+  // Non-blocking primitives (async path): issue the command and return; poll isBusy() for completion.
+  // Programs up to the end of the current 256-byte page; returns bytes issued (0 on WEL failure).
+  size_t startPageProgram(uint32_t addr, const uint8_t* data, size_t len) {
+    size_t pageSpace = 256 - (addr & 0xFF);
+    size_t chunk = (len < pageSpace) ? len : pageSpace;
+    if (!data || chunk == 0 || !writeEnable()) return 0;
+    csLow();
+    xfer(0x02);
+    sendAddr24(addr);
+    for (size_t i = 0; i < chunk; ++i) xfer(data[i]);
+    csHigh();
+    return chunk;
+  }
+  // op: 0x20 (4K), 0x52 (32K), 0xD8 (64K)
+  bool startErase(uint8_t op, uint32_t addr) {
     if (!writeEnable()) return false;
     csLow();
-    xfer(0x20);
+    xfer(op);
     sendAddr24(addr);
     csHigh();
+    return true;
+  }
+  uint8_t readStatus2() {
+    csLow();
+    xfer(0x35);
+    uint8_t v = xfer(0x00);
+    csHigh();
+    return v;
+  }
+  bool isSuspended() {
+    return (readStatus2() & 0x80) != 0;  // SR2.SUS
+  }
+  // Erase/program suspend (0x75); returns once the array is idle and reads outside the
+  // suspended block are allowed. resume() (0x7A) continues the operation.
+  bool suspend(uint32_t timeoutMs = 2) {
+    csLow();
+    xfer(0x75);
+    csHigh();
+    return waitWhileBusy(timeoutMs);
+  }
+  void resume() {
+    csLow();
+    xfer(0x7A);
+    csHigh();
+  }
+  bool sectorErase4K(uint32_t addr, uint32_t timeoutMs = 4000) {
+    return eraseCmd(0x20, addr, timeoutMs);
+  }
+  bool blockErase32K(uint32_t addr, uint32_t timeoutMs = 8000) {
+    return eraseCmd(0x52, addr, timeoutMs);
+  }
+  bool blockErase64K(uint32_t addr, uint32_t timeoutMs = 8000) {
+    return eraseCmd(0xD8, addr, timeoutMs);
+  }
+  bool chipErase(uint32_t timeoutMs = 400000) {
+    if (!writeEnable()) return false;
+    csLow();
+    xfer(0xC7);
+    csHigh();
     return waitWhileBusy(timeoutMs);
   }
 private:
@@ -642,6 +764,10 @@ private:
     xfer((uint8_t)(addr >> 8));
     xfer((uint8_t)addr);
   }
+  bool eraseCmd(uint8_t op, uint32_t addr, uint32_t timeoutMs) {
+    if (!startErase(op, addr)) return false;
+    return waitWhileBusy(timeoutMs);
+  }
 #ifdef BB_USE_RP2040_SIO
   uint32_t _maskMISO = 0, _maskCS = 0, _maskSCK = 0, _maskMOSI = 0;
 #endif
@@ -649,6 +775,49 @@ private:
 #endif  // W25Q_USE_HW_SPI
 // --------------------------- Unified facade (scan + list + reservation) ---------------------------
 namespace UnifiedSpiMem {
+// Recursive cross-core mutex (pico recursive_mutex: hardware spinlock + owner/count); no-op off RP2040
+class RecursiveLock {
+public:
+#if UNIFIED_SPI_LOCKING && defined(ARDUINO_ARCH_RP2040)
+  RecursiveLock() {
+    recursive_mutex_init(&_m);
+  }
+  void lock() {
+    recursive_mutex_enter_blocking(&_m);
+  }
+  void unlock() {
+    recursive_mutex_exit(&_m);
+  }
+private:
+  recursive_mutex_t _m;
+#else
+  void lock() {}
+  void unlock() {}
+#endif
+};
+class LockGuard {
+public:
+  explicit LockGuard(RecursiveLock& l)
+    : _l(l) {
+    _l.lock();
+  }
+  ~LockGuard() {
+    _l.unlock();
+  }
+private:
+  RecursiveLock& _l;
+  LockGuard(const LockGuard&) = delete;
+  LockGuard& operator=(const LockGuard&) = delete;
+};
+// All devices share UNIFIED_SPI_INSTANCE (the bit-banged PSRAM reuses its pins): one bus lock
+inline RecursiveLock& busLock() {
+  static RecursiveLock lock;
+  return lock;
+}
+struct BusGuard : LockGuard {
+  BusGuard()
+    : LockGuard(busLock()) {}
+};
 enum class DeviceType : uint8_t {
   Unknown = 0,
   NorW25Q,
@@ -761,6 +930,7 @@ public:
     for (size_t i = 0; i < UNIFIED_MAX_DETECTED; ++i) _reserved[i] = false;
   }
   void begin() {
+    BusGuard bus;  // also constructs the lock before core1 can touch the bus
     W25Q_SPI_INSTANCE.setRX(_miso);
     W25Q_SPI_INSTANCE.setTX(_mosi);
     W25Q_SPI_INSTANCE.setSCK(_sck);
@@ -927,6 +1097,7 @@ public:
   bool release(MemDevice* dev);
   // Identify a single CS (public; re-used internally)
   bool identifyCS(uint8_t cs, DeviceInfo& out, uint32_t spiHzForId = UNIFIED_SPI_CLOCK_HZ) {
+    BusGuard bus;
     out = DeviceInfo{};
     out.cs = cs;
     ensureAllCsHigh();
@@ -1102,6 +1273,51 @@ public:
   virtual uint32_t eraseSize() const {
     return 4096;
   }
+  // Largest erase unit eraseRange() can issue for a suitably aligned range
+  virtual uint32_t blockEraseSize() const {
+    return eraseSize();
+  }
+  // Read-ahead hint: addr is likely read next. Devices with an array-to-buffer step (NAND tR)
+  // may start it now so it overlaps the caller's work; others ignore it.
+  virtual void prefetch(uint64_t /*addr*/) {}
+  // ---- Asynchronous program/erase ----
+  // submitAsync() starts one request and returns; pollAsync() advances it and fires the
+  // callback on completion. Devices without async support complete inside submitAsync().
+  // read() may preempt an in-flight request; write()/eraseRange() drain it first.
+  enum class AsyncOp : uint8_t { None = 0,
+                                 Write,
+                                 Erase };
+  typedef void (*AsyncCallback)(void* ctx, bool ok);
+  struct AsyncRequest {
+    AsyncOp op = AsyncOp::None;
+    uint64_t addr = 0;
+    uint64_t len = 0;
+    const uint8_t* data = nullptr;  // Write: must stay valid until the callback
+    AsyncCallback cb = nullptr;
+    void* ctx = nullptr;
+  };
+  virtual bool submitAsync(const AsyncRequest& req) {
+    bool ok = false;
+    if (req.op == AsyncOp::Write) ok = write(req.addr, req.data, (size_t)req.len);
+    else if (req.op == AsyncOp::Erase) ok = eraseRange(req.addr, req.len);
+    if (req.cb) req.cb(req.ctx, ok);
+    return ok;
+  }
+  // Returns true while a request is still in flight
+  virtual bool pollAsync() {
+    return false;
+  }
+  bool asyncBusy() const {
+    return _aActive;
+  }
+  bool drainAsync(uint32_t timeoutMs = 10000) {
+    uint32_t t0 = millis();
+    while (pollAsync()) {
+      if ((millis() - t0) > timeoutMs) return false;
+      yield();
+    }
+    return true;
+  }
   uint8_t cs() const {
     return _cs;
   }
@@ -1109,7 +1325,37 @@ public:
 protected:
   explicit MemDevice(uint8_t cs)
     : _cs(cs) {}
+  // Shared async bookkeeping for devices that implement pollAsync()
+  bool beginAsync(const AsyncRequest& req, uint64_t align) {
+    if (_aActive || req.op == AsyncOp::None) return false;
+    if (req.op == AsyncOp::Write && !req.data) return false;
+    if (req.op == AsyncOp::Erase && align == 0) return false;
+    _aReq = req;
+    if (req.op == AsyncOp::Erase) {
+      _aPos = (req.addr / align) * align;
+      _aEnd = ((req.addr + req.len + align - 1) / align) * align;
+    } else {
+      _aPos = req.addr;
+      _aEnd = req.addr + req.len;
+    }
+    _aUnitLen = 0;
+    _aActive = true;
+    return true;
+  }
+  void finishAsync(bool ok) {
+    AsyncRequest r = _aReq;
+    _aActive = false;
+    _aUnitLen = 0;
+    _aReq = AsyncRequest();
+    if (r.cb) r.cb(r.ctx, ok);
+  }
   uint8_t _cs;
+  AsyncRequest _aReq;
+  bool _aActive = false;
+  uint64_t _aPos = 0, _aEnd = 0;  // remaining span
+  uint64_t _aUnitAddr = 0;        // unit currently in the array (_aUnitLen == 0: none)
+  uint32_t _aUnitLen = 0;
+  uint32_t _aT0 = 0;
 };
 // NOR adapter
 class NorMemDevice : public MemDevice {
@@ -1135,8 +1381,25 @@ public:
   uint32_t eraseSize() const override {
     return 4096;
   }
+  uint32_t blockEraseSize() const override {
+    return 65536;
+  }
   size_t read(uint64_t addr, uint8_t* buf, size_t len) override {
     if (!buf || len == 0) return 0;
+    BusGuard bus;
+    bool resumeAfter = false;
+    if (_aActive && _aUnitLen && _nor.isBusy()) {
+      // Data inside the unit being modified is undefined while suspended: wait for it.
+      // Anything else suspends the erase/program for the duration of the read.
+      bool overlaps = (addr < _aUnitAddr + _aUnitLen) && (_aUnitAddr < addr + len);
+      if (!overlaps) {
+        uint32_t since = micros() - _lastResumeUs;  // tSUS between resume and next suspend
+        if (since < 20) delayMicroseconds(20 - since);
+        _nor.suspend();
+      }
+      _nor.waitWhileBusy(unitTimeoutMs());
+      resumeAfter = _nor.isSuspended();
+    }
     size_t total = 0;
     uint32_t a = (uint32_t)addr;
     while (total < len) {
@@ -1144,21 +1407,102 @@ public:
       total += _nor.readData(a, buf + total, chunk);
       a += chunk;
     }
+    if (resumeAfter) {
+      _nor.resume();
+      _lastResumeUs = micros();
+    }
     return total;
   }
   bool write(uint64_t addr, const uint8_t* buf, size_t len) override {
     if (!buf || len == 0) return true;
+    BusGuard bus;
+    if (_aActive && !drainAsync()) return false;
     return _nor.pageProgram((uint32_t)addr, buf, len);
   }
+  // Splits the range into the largest aligned units: chip, 64K, 32K, then 4K
   bool eraseRange(uint64_t addr, uint64_t len) override {
     if (len == 0) return true;
-    uint64_t start = addr & ~(uint64_t)(eraseSize() - 1);
-    uint64_t end = (addr + len + eraseSize() - 1) & ~(uint64_t)(eraseSize() - 1);
-    for (uint64_t a = start; a < end; a += eraseSize())
-      if (!_nor.sectorErase4K((uint32_t)a)) return false;
+    BusGuard bus;
+    if (_aActive && !drainAsync()) return false;
+    uint64_t a = addr & ~(uint64_t)(SECTOR_4K - 1);
+    uint64_t end = (addr + len + SECTOR_4K - 1) & ~(uint64_t)(SECTOR_4K - 1);
+    if (a == 0 && _capacity && end >= _capacity) return _nor.chipErase();
+    while (a < end) {
+      uint8_t op;
+      uint64_t n = eraseUnitAt(a, end, op);
+      if (!_nor.startErase(op, (uint32_t)a)) return false;
+      if (!_nor.waitWhileBusy(ERASE_TIMEOUT_MS)) return false;
+      a += n;
+    }
+    return true;
+  }
+  // Async erase never uses chip erase so reads can still suspend it
+  bool submitAsync(const AsyncRequest& req) override {
+    BusGuard bus;
+    if (!beginAsync(req, SECTOR_4K)) return false;
+    pollAsync();
+    return true;
+  }
+  bool pollAsync() override {
+    BusGuard bus;  // before the _aActive test: the other core may finish the request
+    if (!_aActive) return false;
+    if (_aUnitLen) {
+      if (_nor.isBusy()) {
+        if ((millis() - _aT0) > unitTimeoutMs()) {
+          finishAsync(false);
+          return false;
+        }
+        return true;
+      }
+      _aUnitLen = 0;
+    }
+    if (_aPos >= _aEnd) {
+      finishAsync(true);
+      return false;
+    }
+    uint64_t n;
+    if (_aReq.op == AsyncOp::Erase) {
+      uint8_t op;
+      n = eraseUnitAt(_aPos, _aEnd, op);
+      if (!_nor.startErase(op, (uint32_t)_aPos)) n = 0;
+    } else {
+      const uint8_t* src = _aReq.data + (size_t)(_aPos - _aReq.addr);
+      n = _nor.startPageProgram((uint32_t)_aPos, src, (size_t)(_aEnd - _aPos));
+    }
+    if (n == 0) {
+      finishAsync(false);
+      return false;
+    }
+    _aUnitAddr = _aPos;
+    _aUnitLen = (uint32_t)n;
+    _aT0 = millis();
+    _aPos += n;
     return true;
   }
 private:
+  static constexpr uint64_t SECTOR_4K = 4096;
+  static constexpr uint64_t BLOCK_32K = 32768;
+  static constexpr uint64_t BLOCK_64K = 65536;
+  static constexpr uint32_t ERASE_TIMEOUT_MS = 8000;
+  static constexpr uint32_t PROGRAM_TIMEOUT_MS = 10;
+  // Largest aligned erase unit starting at a (never past end); op receives the opcode
+  static uint64_t eraseUnitAt(uint64_t a, uint64_t end, uint8_t& op) {
+    uint64_t remain = end - a;
+    if ((a & (BLOCK_64K - 1)) == 0 && remain >= BLOCK_64K) {
+      op = 0xD8;
+      return BLOCK_64K;
+    }
+    if ((a & (BLOCK_32K - 1)) == 0 && remain >= BLOCK_32K) {
+      op = 0x52;
+      return BLOCK_32K;
+    }
+    op = 0x20;
+    return SECTOR_4K;
+  }
+  uint32_t unitTimeoutMs() const {
+    return (_aReq.op == AsyncOp::Erase) ? ERASE_TIMEOUT_MS : PROGRAM_TIMEOUT_MS;
+  }
+  uint32_t _lastResumeUs = 0;
   uint8_t _miso, _sck, _mosi;
   uint64_t _capacity;
   W25QBitbang _nor;
@@ -1189,6 +1533,7 @@ public:
   }
   size_t read(uint64_t addr, uint8_t* buf, size_t len) override {
     if (!buf || len == 0) return 0;
+    BusGuard bus;
     size_t total = 0;
     while (total < len) {
       size_t chunk = (len - total > 4096) ? 4096 : (len - total);
@@ -1206,6 +1551,7 @@ public:
   }
   bool write(uint64_t addr, const uint8_t* buf, size_t len) override {
     if (!buf || len == 0) return true;
+    BusGuard bus;
     size_t total = 0;
     while (total < len) {
       size_t chunk = (len - total > 4096) ? 4096 : (len - total);
@@ -1288,6 +1634,8 @@ public:
     return _geo.pageSize * _geo.pagesPerBlock;
   }
   void setGeometry(const Geometry& g) {
+    settlePrefetch();
+    _cacheRow = NO_ROW;
     _geo = g;
     if (_geo.blocks == 0 && _geo.pageSize && _geo.pagesPerBlock) _geo.blocks = (uint32_t)(_capacity / (uint64_t)(_geo.pageSize * _geo.pagesPerBlock));
   }
@@ -1297,12 +1645,16 @@ public:
   }
   size_t read(uint64_t addr, uint8_t* buf, size_t len) override {
     if (!buf || len == 0) return 0;
+    BusGuard bus;
+    if (_aActive) drainAsync();  // MX35LF has no suspend; reads wait for the background op
     size_t total = 0;
     while (total < len) {
       uint32_t page = (uint32_t)(addr / _geo.pageSize);
       uint16_t col = (uint16_t)(addr % _geo.pageSize);
       size_t chunk = min<size_t>(len - total, (size_t)(_geo.pageSize - col));
-      if (!pageReadToCache(page)) break;
+      if (page == _cacheRow) {
+        if (!settlePrefetch()) break;  // page already in (or on its way to) the cache register
+      } else if (!pageReadToCache(page)) break;
       if (!readFromCache(col, buf + total, chunk)) break;
       addr += chunk;
       total += chunk;
@@ -1311,6 +1663,8 @@ public:
   }
   bool write(uint64_t addr, const uint8_t* buf, size_t len) override {
     if (!buf || len == 0) return true;
+    BusGuard bus;
+    if (_aActive && !drainAsync()) return false;
     while (len > 0) {
       uint32_t page = (uint32_t)(addr / _geo.pageSize);
       uint16_t col = (uint16_t)(addr % _geo.pageSize);
@@ -1328,21 +1682,83 @@ public:
     uint64_t esize = eraseSize();
     uint64_t start = (addr / esize) * esize;
     uint64_t end = ((addr + len + esize - 1) / esize) * esize;
+    BusGuard bus;
+    if (_aActive && !drainAsync()) return false;
     for (uint64_t a = start; a < end; a += esize) {
       uint32_t pageRow = (uint32_t)(a / _geo.pageSize);
       if (!blockErase(pageRow)) return false;
     }
     return true;
   }
+  bool submitAsync(const AsyncRequest& req) override {
+    BusGuard bus;
+    if (!beginAsync(req, eraseSize())) return false;
+    pollAsync();
+    return true;
+  }
+  // Start the page read (13h) without waiting; read() of that page then only waits out tR
+  void prefetch(uint64_t addr) override {
+    BusGuard bus;
+    if (_aActive || addr >= _capacity) return;
+    uint32_t row = (uint32_t)(addr / _geo.pageSize);
+    if (row == _cacheRow || !settlePrefetch()) return;
+    startPageRead(row);
+    _cacheRow = row;
+    _pfPending = true;
+  }
+  bool pollAsync() override {
+    BusGuard bus;
+    if (!_aActive) return false;
+    if (_aUnitLen) {
+      uint8_t st = getFeature(0xC0);
+      if (st & 0x01) {  // OIP
+        uint32_t limit = (_aReq.op == AsyncOp::Erase) ? 120u : 6u;
+        if ((millis() - _aT0) > limit) {
+          finishAsync(false);
+          return false;
+        }
+        return true;
+      }
+      uint8_t failBit = (_aReq.op == AsyncOp::Erase) ? (1u << 2) : (1u << 3);  // EFAIL / PFAIL
+      if (st & failBit) {
+        finishAsync(false);
+        return false;
+      }
+      _aUnitLen = 0;
+    }
+    if (_aPos >= _aEnd) {
+      finishAsync(true);
+      return false;
+    }
+    uint32_t page = (uint32_t)(_aPos / _geo.pageSize);
+    uint32_t n;
+    bool ok;
+    if (_aReq.op == AsyncOp::Erase) {
+      n = eraseSize();
+      ok = startBlockErase(page);
+    } else {
+      uint16_t col = (uint16_t)(_aPos % _geo.pageSize);
+      n = (uint32_t)min<uint64_t>(_aEnd - _aPos, (uint64_t)(_geo.pageSize - col));
+      const uint8_t* src = _aReq.data + (size_t)(_aPos - _aReq.addr);
+      ok = programLoad(col, src, n) && startProgramExecute(page);
+    }
+    if (!ok) {
+      finishAsync(false);
+      return false;
+    }
+    _aUnitAddr = _aPos;
+    _aUnitLen = n;
+    _aT0 = millis();
+    _aPos += n;
+    return true;
+  }
   // Low-level API (used by helpers)
   bool pageReadToCache(uint32_t row) {
-    beginTx();
-    csLow();
-    W25Q_SPI_INSTANCE.transfer((uint8_t)0x13);
-    sendRowAddr24(row);
-    csHigh();
-    endTx();
-    return waitReady(2);  // ~2ms timeout
+    if (!settlePrefetch()) return false;
+    startPageRead(row);
+    if (!waitReady(2)) return false;  // ~2ms timeout
+    _cacheRow = row;
+    return true;
   }
   bool readFromCache(uint16_t col, uint8_t* buf, size_t len) {
     if (!buf || len == 0) return true;
@@ -1361,6 +1777,8 @@ public:
   }
   bool programLoad(uint16_t col, const uint8_t* data, size_t len) {
     if (!data || len == 0) return true;
+    if (!settlePrefetch()) return false;
+    _cacheRow = NO_ROW;  // program load overwrites the cache register
     if (!writeEnable()) return false;
     beginTx();
     csLow();
@@ -1373,18 +1791,32 @@ public:
     return true;
   }
   bool programExecute(uint32_t row) {
+    if (!startProgramExecute(row)) return false;
+    if (!waitReady(6)) return false;  // up to ~6ms
+    uint8_t st = getFeature(0xC0);
+    if (st & (1u << 3)) return false;  // PFAIL
+    return true;
+  }
+  bool blockErase(uint32_t row) {
+    if (!startBlockErase(row)) return false;
+    if (!waitReady(120)) return false;  // up to ~120ms
+    uint8_t st = getFeature(0xC0);
+    if (st & (1u << 2)) return false;  // EFAIL
+    return true;
+  }
+  // Non-blocking halves of programExecute()/blockErase(); poll OIP via getFeature(0xC0)
+  bool startProgramExecute(uint32_t row) {
     beginTx();
     csLow();
     W25Q_SPI_INSTANCE.transfer((uint8_t)0x10);
     sendRowAddr24(row);
     csHigh();
     endTx();
-    if (!waitReady(6)) return false;  // up to ~6ms
-    uint8_t st = getFeature(0xC0);
-    if (st & (1u << 3)) return false;  // PFAIL
     return true;
   }
-  bool blockErase(uint32_t row) {
+  bool startBlockErase(uint32_t row) {
+    if (!settlePrefetch()) return false;
+    _cacheRow = NO_ROW;
     if (!writeEnable()) return false;
     beginTx();
     csLow();
@@ -1392,9 +1824,6 @@ public:
     sendRowAddr24(row);
     csHigh();
     endTx();
-    if (!waitReady(120)) return false;  // up to ~120ms
-    uint8_t st = getFeature(0xC0);
-    if (st & (1u << 2)) return false;  // EFAIL
     return true;
   }
   uint8_t getFeature(uint8_t addr) {
@@ -1435,6 +1864,23 @@ private:
     W25Q_SPI_INSTANCE.transfer((uint8_t)(row >> 8));
     W25Q_SPI_INSTANCE.transfer((uint8_t)row);
   }
+  void startPageRead(uint32_t row) {
+    _cacheRow = NO_ROW;
+    beginTx();
+    csLow();
+    W25Q_SPI_INSTANCE.transfer((uint8_t)0x13);
+    sendRowAddr24(row);
+    csHigh();
+    endTx();
+  }
+  // Wait out a prefetch page read before issuing any other command
+  bool settlePrefetch() {
+    if (!_pfPending) return true;
+    _pfPending = false;
+    if (waitReady(2)) return true;
+    _cacheRow = NO_ROW;
+    return false;
+  }
   bool writeEnable() {
     beginTx();
     csLow();
@@ -1456,6 +1902,9 @@ private:
   uint64_t _capacity;
   Geometry _geo;
   uint32_t _spiHz = 20000000UL;  // safer default for SPI-NAND
+  static constexpr uint32_t NO_ROW = 0xFFFFFFFFUL;
+  uint32_t _cacheRow = NO_ROW;  // page held in the cache register
+  bool _pfPending = false;      // 13h issued by prefetch(), tR not yet waited out
 };
 // Manager: device construction
 inline MemDevice* Manager::createDevice(const DeviceInfo& info) {
@@ -11,15 +11,77 @@
   - Omits any 74HC-series features (no external decoder content)
   Notes:
     - The SimpleFS core is append-only directory + linear data region:
-        DIR: 64 KiB at 0x000000, entries of 32 bytes (NOR/PSRAM) or 1 NAND page each (NAND)
-        DATA: starts at 0x00010000
+        DIR: at 0x000000, entries of 32 bytes (NOR/PSRAM) or 1 NAND page each (NAND)
+        DATA: starts right after the directory
+    - format() sizes the directory for the device (UNIFIED_FS_DIR_SHARE of the capacity, or
+      UNIFIED_FS_DIR_SIZE / setFormatDirSize()) and stamps a superblock in its first slot:
+      layout version, directory size, stride, erase unit, data start. mount() reads it; volumes
+      without one keep the legacy layout (64 KiB directory, data at 0x00010000)
+    - Addresses, sizes and the capacity are 64-bit; a file may fill the device (no 16 MiB cap).
+      Records keep their 32-bit address/size fields; an extent reaching past 4 GiB also writes
+      the high words into its extension record (flag EXT_HIGH). Only layout version 2+ volumes
+      (format() stamps the current version) take such records, so v1 and legacy directories mount unchanged and
+      stay readable by older firmware as long as they are not reformatted
+    - The in-memory index is kept in name order, so lookups are a binary search and a folder
+      ("dir/" prefix) is one contiguous run: visitPrefix() lists it without touching the device.
+      deletePrefix() removes a subtree with a single prefix tombstone (flags 0x01|0x08) on
+      layout version 3 volumes; older volumes get one tombstone per file
+    - Dual-core: each UnifiedSPIMemSimpleFS volume has a recursive mutex (pico hardware spinlock
+      on RP2040) held by every mutating call and every device read, and the device layer holds
+      the shared SPI bus lock per transaction, so core1 may read files while core0 writes.
+      Index-only lookups (exists, getFileSize, getFileInfo, getStoredSize, getFileCrc, fileCount)
+      take no lock: they read the RAM index under a seqlock and retry under the lock only when a
+      writer was inside. Objects layered on a volume (TieredFS, KVStore, BTreeFS, RingFile) keep
+      their own RAM state and belong to one core each.
     - NOR/NAND specifics:
         * Erasing is required before programming (NOR: 4K sectors, NAND: block size)
+        * NOR erases are coalesced into 64K/32K block erases (chip erase for the whole part);
+          large slots are placed on 64K boundaries so they erase in whole blocks
+        * NOR writes over programmed data skip the erase when only 1->0 bit changes are needed
+          (or the data is identical); writeStats() counts per-sector outcomes
+        * A RAM bitmap of known-erased granules (UNIFIED_FS_ERASED_MAP_BITS) replaces the
+          read-back check once a range has been verified/erased; UNIFIED_FS_VERIFY_ERASED=1
+          or setVerifyErased(true) always reads back
+        * An LRU line cache in the driver serves repeated small reads (all backends);
+          write-through by default, write-back selectable for PSRAM (sync() flushes)
+        * Sequential readFileRange() calls on one file are served from a read-ahead window
+          (UNIFIED_FS_READAHEAD_BYTES) filled by one device read; on NAND the next page read
+          is started early so its tR overlaps the caller's processing
+        * writeFileCompressed() stores an LZSS stream (record flag 0x02, 1 KiB window);
+          readFile/readFileRange/getFileSize see the raw bytes, decoding on the fly. The stream
+          restarts every 4 KiB and a table of restart offsets follows the header, so a seek
+          decodes at most one block. writeFileCompressedFrom() compresses from a ChunkSource
+        * Whole-file writes append an extension record ('W''X', at +32 from the record) carrying
+          the CRC-32 of the file contents; getFileCrc() returns it
+        * Rewriting a file with the contents it already holds (same size and CRC-32) programs
+          nothing and appends no record (UNIFIED_FS_SKIP_IDENTICAL); counted as filesUnchanged
+        * trackChanges(true) keeps a bitmap of device granules written since clearChanges();
+          checkpointing uses it to copy only the extents that changed
+        * Small files are packed into the directory instead of the data region (record flag 0x04):
+          the record, its extension and the data share one append (NOR: 32-byte slots, at most
+          192 bytes of data; NAND: the rest of the record's page). NOR slot requests of one erase
+          unit or less holding such a file no longer burn a whole sector; on NAND every small
+          write goes inline. The data dies with its record, like any superseded entry.
+        * reserveIndexSnapshot() sets aside UNIFIED_FS_SNAPSHOT_BYTES at the device tail for a
+          copy of the RAM index; saveIndexSnapshot(epoch) refreshes it, mountFromSnapshot(epoch)
+          reuses it after a warm reboot when the epoch and CRC match and the directory log still
+          ends where the copy says (O(1): one erased slot + the last record's seq). The first
+          device write after a save zeroes the snapshot magic, so a stale copy is never loaded
+        * On flash/NAND the snapshot is durable: sync() rewrites it once UNIFIED_FS_SNAPSHOT_EVERY
+          records were appended since the last one, and mount() loads it and replays only the
+          records after it. Two areas are reserved and written in turn, so a reset while one is
+          erased or reprogrammed leaves the other (mount takes the newer valid copy). A CRC
+          mismatch, or a log whose record at the saved offset no longer carries the saved seq,
+          falls back to the older copy, then to the full directory scan; format() erases both
+        * preEraseStep() (call from the main loop when idle) keeps UNIFIED_FS_PREERASE_BYTES
+          past the data head erased in the background, so foreground writes are program-only
         * This layer auto-detects and performs erases when writing:
-            - If the payload is all 0xFF: it issues eraseRange() on the covered range.
+            - If the payload is all 0xFF: it issues eraseRange() on the covered range
+              (skipped when the range already reads erased).
             - If the payload is not all 0xFF:
                 - For DIR writes: it assumes the destination bytes are already erased (0xFF).
-                  If they are not, write fails (to avoid erasing earlier directory entries).
+                  If they are not, write fails (to avoid erasing earlier directory entries),
+                  except NOR bit-clear-only updates, which are programmed in place.
                 - For DATA writes: if any byte is not erased, it erases the covering range before programming.
         * For NAND (MX35LF): the directory entry is written as one full page at a time
           (the 32-byte record is placed at page start, rest 0xFF) to avoid partial-page program limits.
@@ -43,6 +105,66 @@
 #include <stddef.h>
 #include <string.h>
 #include "UnifiedSPIMem.h"
+#include "CRC32Fast.h"
+
+#ifndef UNIFIED_FS_ERASED_MAP_BITS
+#define UNIFIED_FS_ERASED_MAP_BITS 32768UL  // known-erased bitmap size (4 KiB RAM per NOR/NAND driver)
+#endif
+#ifndef UNIFIED_FS_VERIFY_ERASED
+#define UNIFIED_FS_VERIFY_ERASED 0  // 1: always read back before programming (bitmap ignored)
+#endif
+#ifndef UNIFIED_FS_RMW_MAX
+#define UNIFIED_FS_RMW_MAX 4096UL  // largest erase unit writeFileRange() read-modify-writes in RAM
+#endif
+#ifndef UNIFIED_FS_CACHE_LINES
+#define UNIFIED_FS_CACHE_LINES 8  // LRU read cache lines per driver (0 = no cache)
+#endif
+#ifndef UNIFIED_FS_CACHE_LINE_SIZE
+#define UNIFIED_FS_CACHE_LINE_SIZE 512  // power of two
+#endif
+// Default cache policy per backend: 0 = off, 1 = write-through, 2 = write-back (PSRAM only)
+#ifndef UNIFIED_FS_CACHE_POLICY_PSRAM
+#define UNIFIED_FS_CACHE_POLICY_PSRAM 1
+#endif
+#ifndef UNIFIED_FS_CACHE_POLICY_NOR
+#define UNIFIED_FS_CACHE_POLICY_NOR 1
+#endif
+#ifndef UNIFIED_FS_CACHE_POLICY_NAND
+#define UNIFIED_FS_CACHE_POLICY_NAND 1
+#endif
+#ifndef UNIFIED_FS_READAHEAD_BYTES
+#define UNIFIED_FS_READAHEAD_BYTES 4096UL  // sequential readFileRange() window (0 = off)
+#endif
+#ifndef UNIFIED_FS_PREERASE_BYTES
+#define UNIFIED_FS_PREERASE_BYTES (64UL * 1024UL)  // erased pool kept ahead of the data head (0 = off)
+#endif
+#ifndef UNIFIED_FS_SKIP_IDENTICAL
+#define UNIFIED_FS_SKIP_IDENTICAL 1  // whole-file writes matching the stored size + CRC-32 are no-ops
+#endif
+#ifndef UNIFIED_FS_STREAM_CHUNK
+#define UNIFIED_FS_STREAM_CHUNK 4096UL  // writeFileFrom() transfer size on NOR/PSRAM (NAND: one page)
+#endif
+#ifndef UNIFIED_FS_CHANGE_MAP_BITS
+#define UNIFIED_FS_CHANGE_MAP_BITS 8192UL  // changed-since-checkpoint bitmap (1 KiB RAM when enabled)
+#endif
+#ifndef UNIFIED_FS_INLINE_MAX
+#define UNIFIED_FS_INLINE_MAX 1024UL  // largest file kept inside its directory record (0 = off; NOR: 192)
+#endif
+#ifndef UNIFIED_FS_SNAPSHOT_BYTES
+#define UNIFIED_FS_SNAPSHOT_BYTES 4096UL  // index snapshot area carved from the device tail (reserveIndexSnapshot; two on flash/NAND)
+#endif
+#ifndef UNIFIED_FS_DIR_SIZE
+#define UNIFIED_FS_DIR_SIZE 0  // format(): fixed directory bytes (0 = capacity / UNIFIED_FS_DIR_SHARE)
+#endif
+#ifndef UNIFIED_FS_DIR_SHARE
+#define UNIFIED_FS_DIR_SHARE 128  // format(): directory = 1/N of the device (8 MiB PSRAM: 64 KiB)
+#endif
+#ifndef UNIFIED_FS_DIR_MIN_RECORDS
+#define UNIFIED_FS_DIR_MIN_RECORDS 64  // format(): directory never holds fewer record slots
+#endif
+#ifndef UNIFIED_FS_SNAPSHOT_EVERY
+#define UNIFIED_FS_SNAPSHOT_EVERY 16  // flash/NAND: records appended before sync() refreshes the snapshot
+#endif
 
 // -------------------------------------------
 // UnifiedSPIMem driver adapter for SimpleFS
@@ -52,13 +174,262 @@ public:
   using DeviceType = UnifiedSpiMem::DeviceType;
   UnifiedMemFSDriver()
     : _dev(nullptr), _type(DeviceType::Unknown), _eraseSize(0) {}
-  explicit UnifiedMemFSDriver(UnifiedSpiMem::MemDevice* dev) {
+  explicit UnifiedMemFSDriver(UnifiedSpiMem::MemDevice* dev)
+    : UnifiedMemFSDriver() {
     attach(dev);
   }
+  UnifiedMemFSDriver(const UnifiedMemFSDriver&) = delete;
+  UnifiedMemFSDriver& operator=(const UnifiedMemFSDriver&) = delete;
+  ~UnifiedMemFSDriver() {
+    sync();
+    delete[] _emap;
+    delete[] _cmap;
+    delete[] _lines;
+    delete[] _lineData;
+    delete[] _ra;
+  }
   void attach(UnifiedSpiMem::MemDevice* dev) {
+    sync();
     _dev = dev;
     _type = _dev ? _dev->type() : DeviceType::Unknown;
     _eraseSize = _dev ? _dev->eraseSize() : 0;
+    _raLen = 0;
+    allocErasedMap();
+    if (_cmap) trackChanges(true);
+    int pol = (_type == DeviceType::Psram) ? UNIFIED_FS_CACHE_POLICY_PSRAM : (_type == DeviceType::NorW25Q) ? UNIFIED_FS_CACHE_POLICY_NOR
+                                                                                                            : UNIFIED_FS_CACHE_POLICY_NAND;
+    setCachePolicy((CachePolicy)pol);
+  }
+  // ---- LRU block cache (UNIFIED_FS_CACHE_LINES x UNIFIED_FS_CACHE_LINE_SIZE) ----
+  // Reads are served per line; small reads fill lines, large ones bypass the cache.
+  // WriteThrough updates cached lines after programming; WriteBack (PSRAM only) keeps small
+  // DATA writes in dirty lines until sync()/flushStep()/eviction. Erases invalidate lines.
+  enum class CachePolicy : uint8_t { Off = 0,
+                                     WriteThrough = 1,
+                                     WriteBack = 2 };
+  struct CacheStats {
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    uint32_t bypass = 0;      // large reads sent straight to the device
+    uint32_t writebacks = 0;  // dirty lines flushed
+    uint32_t raHits = 0;      // sequential reads served from the read-ahead window
+    uint32_t raFills = 0;     // read-ahead window refills
+  };
+  void setCachePolicy(CachePolicy p) {
+    sync();
+    if (p == CachePolicy::WriteBack && _type != DeviceType::Psram) p = CachePolicy::WriteThrough;  // erase semantics
+    if (UNIFIED_FS_CACHE_LINES == 0 || !_dev) p = CachePolicy::Off;
+    _policy = p;
+    if (_policy != CachePolicy::Off && !_lines) {
+      _lines = new CacheLine[UNIFIED_FS_CACHE_LINES];
+      _lineData = new uint8_t[(size_t)UNIFIED_FS_CACHE_LINES * UNIFIED_FS_CACHE_LINE_SIZE];
+    }
+    cacheInvalidate(0, UINT64_MAX);  // every line, above 4 GiB included
+  }
+  CachePolicy cachePolicy() const {
+    return _policy;
+  }
+  const CacheStats& cacheStats() const {
+    return _cstats;
+  }
+  void resetCacheStats() {
+    _cstats = CacheStats();
+  }
+  // Write every dirty line back to the device
+  bool sync() {
+    bool ok = true;
+    if (!_lines) return ok;
+    for (size_t i = 0; i < UNIFIED_FS_CACHE_LINES; ++i)
+      if (_lines[i].dirty && !cacheFlushLine(i)) ok = false;
+    return ok;
+  }
+  // Idle helper: flush at most one dirty line; returns true if one was written
+  bool flushStep() {
+    if (!_lines) return false;
+    for (size_t i = 0; i < UNIFIED_FS_CACHE_LINES; ++i)
+      if (_lines[i].dirty) return cacheFlushLine(i);
+    return false;
+  }
+  // Drop cached lines over [addr, addr+len) (device changed behind the driver, e.g. async erase)
+  void cacheInvalidate(uint64_t addr, uint64_t len) {
+    if (_raLen && _raAddr < addr + len && addr < (uint64_t)_raAddr + _raLen) _raLen = 0;
+    if (!_lines || len == 0) return;
+    for (size_t i = 0; i < UNIFIED_FS_CACHE_LINES; ++i) {
+      CacheLine& l = _lines[i];
+      if (l.valid && l.addr < addr + len && addr < (uint64_t)l.addr + UNIFIED_FS_CACHE_LINE_SIZE) {
+        l.valid = false;
+        l.dirty = false;
+      }
+    }
+  }
+  // Known-erased bitmap (NOR/NAND). A set bit means the whole granule reads 0xFF.
+  // Starts empty (unknown) and fills lazily: verify reads that cover a whole granule set it,
+  // erases set it, programs clear it. The write path trusts set bits instead of reading back.
+  void markErased(uint64_t addr, uint64_t len) {
+    if (!_emap || len == 0) return;
+    uint64_t g0 = (addr + _granule - 1) >> _granuleShift;  // fully covered only
+    uint64_t g1 = (addr + len) >> _granuleShift;
+    for (uint64_t g = g0; g < g1 && g < _emapBits; ++g) _emap[g >> 3] |= (uint8_t)(1u << (g & 7));
+  }
+  void markDirty(uint64_t addr, uint64_t len) {
+    if (!_emap || len == 0) return;
+    uint64_t g0 = addr >> _granuleShift;
+    uint64_t g1 = (addr + len - 1) >> _granuleShift;
+    for (uint64_t g = g0; g <= g1 && g < _emapBits; ++g) _emap[g >> 3] &= (uint8_t)~(1u << (g & 7));
+  }
+  bool knownErased(uint64_t addr, uint64_t len) const {
+    if (!_emap || len == 0) return false;
+    uint64_t g0 = addr >> _granuleShift;
+    uint64_t g1 = (addr + len - 1) >> _granuleShift;
+    if (g1 >= _emapBits) return false;
+    for (uint64_t g = g0; g <= g1; ++g)
+      if (!granuleErased(g)) return false;
+    return true;
+  }
+  // Paranoid mode: ignore the bitmap and always verify by reading back
+  void setVerifyErased(bool on) {
+    _verifyErased = on;
+  }
+  bool verifyErased() const {
+    return _verifyErased;
+  }
+  uint32_t erasedMapGranule() const {
+    return _emap ? _granule : 0;
+  }
+  // Changed-since-checkpoint bitmap: every device write sets the granules it touches.
+  // Enabling starts with everything marked changed (nothing is known to be saved yet).
+  void trackChanges(bool on) {
+    delete[] _cmap;
+    _cmap = nullptr;
+    _cmapBits = 0;
+    if (!on || !_dev) return;
+    uint64_t cap = _dev->capacity();
+    uint8_t shift = 8;
+    while ((cap >> shift) > UNIFIED_FS_CHANGE_MAP_BITS) ++shift;
+    _cgranuleShift = shift;
+    _cmapBits = (uint32_t)((cap + (1ull << shift) - 1) >> shift);
+    _cmap = new uint8_t[(_cmapBits + 7) / 8];
+    memset(_cmap, 0xFF, (_cmapBits + 7) / 8);
+  }
+  bool trackingChanges() const {
+    return _cmap != nullptr;
+  }
+  uint32_t changeGranule() const {
+    return _cmap ? (1u << _cgranuleShift) : 0;
+  }
+  // Any granule of [addr, addr+len) written since the last clearChanges() (true when untracked)
+  bool changedSince(uint64_t addr, uint64_t len) const {
+    return changedIn(_cmap, addr, len);
+  }
+  // Same test against a map handed out by takeChanges() (nullptr: everything changed)
+  bool changedIn(const uint8_t* map, uint64_t addr, uint64_t len) const {
+    if (!map) return true;
+    if (len == 0) return false;
+    uint64_t g1 = (addr + len - 1) >> _cgranuleShift;
+    for (uint64_t g = addr >> _cgranuleShift; g <= g1; ++g)
+      if (g >= _cmapBits || (map[g >> 3] & (uint8_t)(1u << (g & 7)))) return true;
+    return false;
+  }
+  void clearChanges() {
+    if (_cmap) memset(_cmap, 0, (_cmapBits + 7) / 8);
+  }
+  // Checkpoint start: hand over the map and keep tracking in a clean one, so writes made while
+  // the checkpoint runs stay marked. nullptr when untracked or out of memory (map left as is).
+  uint8_t* takeChanges() {
+    if (!_cmap) return nullptr;
+    const uint32_t n = (_cmapBits + 7) / 8;
+    uint8_t* fresh = new uint8_t[n];
+    if (!fresh) return nullptr;
+    memset(fresh, 0, n);
+    uint8_t* taken = _cmap;
+    _cmap = fresh;
+    return taken;
+  }
+  // Checkpoint failed: its granules are still unsaved, merge them back (frees taken)
+  void mergeChanges(uint8_t* taken) {
+    if (!taken) return;
+    if (_cmap)
+      for (uint32_t i = 0; i < (_cmapBits + 7) / 8; ++i) _cmap[i] |= taken[i];
+    delete[] taken;
+  }
+  void dropChanges(uint8_t* taken) {
+    delete[] taken;
+  }
+  // Write guard: the first program or erase after armWriteGuard(addr) zeroes the 4 bytes at
+  // addr beforehand (an index snapshot's magic), so a saved snapshot never describes newer data
+  void armWriteGuard(uint64_t addr) {
+    _guardAddr = addr;
+    _guardArmed = true;
+  }
+  void disarmWriteGuard() {
+    _guardArmed = false;
+  }
+  bool writeGuardArmed() const {
+    return _guardArmed;
+  }
+  // Partial update for writeFileRange(): programs [addr, addr+len) and keeps every other byte
+  // of the touched erase units. Units needing a 0->1 bit are read into RAM, merged, erased and
+  // reprogrammed. canUpdateInPlace() is false when the unit exceeds UNIFIED_FS_RMW_MAX.
+  bool canUpdateInPlace() const {
+    return _eraseSize <= UNIFIED_FS_RMW_MAX;
+  }
+  bool updateRange(uint64_t addr, const uint8_t* buf, size_t len) {
+    if (!_dev || !buf || len == 0) return true;
+    if (_eraseSize == 0) return writeData02(addr, buf, len);
+    if (!canUpdateInPlace()) return false;
+    uint8_t* unit = nullptr;
+    bool ok = true;
+    const uint64_t end = (uint64_t)addr + len;
+    uint64_t pos = addr;
+    while (ok && pos < end) {
+      const uint64_t uStart = alignDown(pos, _eraseSize);
+      const uint64_t segEnd = min<uint64_t>(end, uStart + _eraseSize);
+      const uint8_t* src = buf + (pos - addr);
+      const size_t n = (size_t)(segEnd - pos);
+      int cls = regionIsErased(pos, n) ? 3 : classifyNor(pos, src, n);
+      if (cls == 0) {
+        _stats.sectorsUnchanged++;
+      } else if (cls == 3 || (cls == 1 && _type == DeviceType::NorW25Q)) {
+        ok = devWrite(pos, src, n);
+        if (cls == 3) _stats.sectorsProgrammed++;
+        else _stats.sectorsBitClear++;
+      } else if (cls < 0) {
+        ok = false;
+      } else {
+        if (!unit) unit = (uint8_t*)malloc(_eraseSize);
+        ok = unit && _dev->read(uStart, unit, _eraseSize) == _eraseSize;
+        if (ok) {
+          memcpy(unit + (pos - uStart), src, n);
+          ok = eraseRange(uStart, _eraseSize);
+        }
+        if (ok) {
+          size_t progLen = _eraseSize;
+          while (progLen > 0 && unit[progLen - 1] == 0xFF) --progLen;  // tail stays erased
+          ok = (progLen == 0) || devWrite(uStart, unit, progLen);
+          _stats.sectorsErased++;
+        }
+      }
+      pos = segEnd;
+    }
+    if (unit) free(unit);
+    return ok;
+  }
+  // Per-sector write outcomes (NOR/NAND); one count per erase unit touched by a write
+  struct WriteStats {
+    uint32_t sectorsProgrammed = 0;  // target was already erased
+    uint32_t sectorsBitClear = 0;    // NOR: programmed in place, (old & new) == new
+    uint32_t sectorsUnchanged = 0;   // data already present, nothing programmed
+    uint32_t sectorsErased = 0;      // erase needed before programming
+    uint32_t filesUnchanged = 0;     // whole-file writes skipped, contents already stored
+  };
+  const WriteStats& writeStats() const {
+    return _stats;
+  }
+  void resetWriteStats() {
+    _stats = WriteStats();
+  }
+  void noteFileUnchanged() {
+    _stats.filesUnchanged++;
   }
   UnifiedSpiMem::MemDevice* device() const {
     return _dev;
@@ -72,29 +443,84 @@ public:
   uint32_t pageSize() const {
     return _dev ? _dev->pageSize() : 256u;
   }
+  uint32_t blockEraseSize() const {
+    return _dev ? _dev->blockEraseSize() : _eraseSize;
+  }
+  // Erase the units covering [addr, addr+len) unless the range already reads erased
+  bool ensureErased(uint64_t addr, size_t len) {
+    if (_eraseSize == 0 || regionIsErased(addr, len)) return true;
+    return eraseRange(addr, len);
+  }
   bool eraseRange(uint64_t addr, uint64_t len) {
     if (!_dev) return false;
     if (_eraseSize == 0) return false;
-    return _dev->eraseRange(addr, len);
+    uint64_t start = alignDown(addr, _eraseSize);
+    uint64_t end = alignUp64(addr + len, _eraseSize);
+    fireWriteGuard();
+    markDirty(start, end - start);  // unknown until the erase succeeds
+    markChanged(start, end - start);
+    cacheInvalidate(start, end - start);
+    if (!_dev->eraseRange(addr, len)) return false;
+    markErased(start, end - start);
+    return true;
   }
   // SimpleFS expects these methods:
-  bool readData03(uint32_t addr, uint8_t* buf, size_t len) {
+  bool readData03(uint64_t addr, uint8_t* buf, size_t len) {
     if (!_dev || !buf || len == 0) return true;
-    size_t r = _dev->read((uint64_t)addr, buf, len);
+    if (_policy != CachePolicy::Off) return cachedRead(addr, buf, len);
+    size_t r = _dev->read(addr, buf, len);
     return r == len;
   }
-  bool writeData02(uint32_t addr, const uint8_t* buf, size_t len, bool /*needsWriteEnable*/ = false) {
+  // Sequential stream read (caller detected it): served from the read-ahead window, which is
+  // refilled with one device read up to limit; then the device is hinted at the next window.
+  bool readStream(uint64_t addr, uint8_t* buf, size_t len, uint64_t limit) {
+    if (!_dev || !buf || len == 0) return true;
+    if (UNIFIED_FS_READAHEAD_BYTES == 0 || len >= UNIFIED_FS_READAHEAD_BYTES) {
+      if (!readData03(addr, buf, len)) return false;
+      if (addr + len < limit) _dev->prefetch(addr + len);
+      return true;
+    }
+    const uint64_t raEnd = _raAddr + _raLen;
+    size_t done = 0;
+    if (_raLen && addr >= _raAddr && addr < raEnd) {
+      done = (size_t)min<uint64_t>(len, raEnd - addr);
+      memcpy(buf, _ra + (addr - _raAddr), done);
+      if (done == len) {
+        _cstats.raHits++;
+        return true;
+      }
+    }
+    if (!_ra) _ra = new uint8_t[UNIFIED_FS_READAHEAD_BYTES];
+    const uint64_t start = addr + done;
+    const size_t need = len - done;
+    uint64_t end = alignDown(start + UNIFIED_FS_READAHEAD_BYTES, pageSize());  // stop on a page boundary
+    if (end < start + need) end = start + UNIFIED_FS_READAHEAD_BYTES;
+    if (end > limit) end = limit;
+    if (end < start + need) end = start + need;
+    const size_t n = (size_t)(end - start);
+    cacheFlushRange(start, n);
+    _raLen = 0;
+    if (_dev->read(start, _ra, n) != n) return false;
+    _raAddr = start;
+    _raLen = (uint32_t)n;
+    _cstats.raFills++;
+    memcpy(buf + done, _ra, need);
+    if (end < limit) _dev->prefetch(end);
+    return true;
+  }
+  bool writeData02(uint64_t addr, const uint8_t* buf, size_t len, bool /*needsWriteEnable*/ = false) {
     if (!_dev || !buf || len == 0) return true;
     switch (_type) {
       case DeviceType::Psram:
-        // No erase required
-        return _dev->write((uint64_t)addr, buf, len);
+        // No erase required; small DATA writes may stay in write-back lines
+        if (_policy == CachePolicy::WriteBack && addr >= _dirEnd && len < 2 * UNIFIED_FS_CACHE_LINE_SIZE) return cachedWrite(addr, buf, len);
+        return devWrite(addr, buf, len);
       case DeviceType::NorW25Q:
       case DeviceType::SpiNandMX35:
         return writeWithErasePolicy(addr, buf, len);
       default:
         // Unknown: best effort raw write
-        return _dev->write((uint64_t)addr, buf, len);
+        return devWrite(addr, buf, len);
     }
   }
   const char* styleName() const {
@@ -106,10 +532,12 @@ public:
   uint64_t capacityBytes() const {
     return _dev ? _dev->capacity() : 0;
   }
+  // Directory writes below this address must land on erased space (never erase-and-rewrite)
+  void setDirEnd(uint64_t addr) {
+    _dirEnd = addr;
+  }
 private:
-  static constexpr uint32_t DIR_START = 0x000000UL;
-  static constexpr uint32_t DIR_SIZE = 64UL * 1024UL;
-  static constexpr uint32_t DATA_START = DIR_START + DIR_SIZE;
+  uint64_t _dirEnd = 64UL * 1024UL;  // directory/data boundary, set from the FS layout
   static inline bool isAllFF(const uint8_t* p, size_t n) {
     for (size_t i = 0; i < n; ++i)
       if (p[i] != 0xFF) return false;
@@ -121,26 +549,44 @@ private:
   static inline uint64_t alignUp64(uint64_t v, uint64_t a) {
     return (v + (a - 1)) & ~(a - 1);
   }
-  bool regionIsErased(uint32_t addr, size_t len) {
+  bool regionIsErased(uint64_t addr, size_t len) {
     if (!_dev || len == 0) return true;
-    // Read-chunk scan for any non-0xFF
+    if (!_verifyErased && knownErased(addr, len)) return true;
+    // Read-chunk scan for any non-0xFF, skipping granules already known erased
     uint8_t tmp[256];
     uint64_t pos = addr;
-    uint64_t end = (uint64_t)addr + (uint64_t)len;
+    uint64_t end = addr + len;
     while (pos < end) {
-      size_t n = (size_t)min<uint64_t>(sizeof(tmp), end - pos);
-      size_t r = _dev->read(pos, tmp, n);
-      if (r != n) return false;  // I/O fail treated as non-erased
-      for (size_t i = 0; i < n; ++i) {
-        if (tmp[i] != 0xFF) return false;
+      uint64_t gEnd = end;
+      if (_emap) {
+        uint64_t g = pos >> _granuleShift;
+        gEnd = min<uint64_t>(end, (g + 1) << _granuleShift);
+        if (!_verifyErased && g < _emapBits && granuleErased(g)) {
+          pos = gEnd;
+          continue;
+        }
+      }
+      uint64_t segStart = pos;
+      while (pos < gEnd) {
+        size_t n = (size_t)min<uint64_t>(sizeof(tmp), gEnd - pos);
+        size_t r = _dev->read(pos, tmp, n);
+        if (r != n) return false;  // I/O fail treated as non-erased
+        for (size_t i = 0; i < n; ++i) {
+          if (tmp[i] != 0xFF) return false;
+        }
+        pos += n;
       }
-      pos += n;
+      markErased(segStart, gEnd - segStart);  // only sets the bit if the whole granule was read
     }
     return true;
   }
-  bool writeWithErasePolicy(uint32_t addr, const uint8_t* buf, size_t len) {
+  bool writeWithErasePolicy(uint64_t addr, const uint8_t* buf, size_t len) {
     // If caller writes "all 0xFF", we translate to erase on erase-capable devices.
     if (_eraseSize > 0 && isAllFF(buf, len)) {
+      if (regionIsErased(addr, len)) {
+        _stats.sectorsUnchanged += sectorSpan(addr, len);
+        return true;
+      }
       uint64_t start = alignDown((uint64_t)addr, (uint64_t)_eraseSize);
       uint64_t end = alignUp64((uint64_t)addr + (uint64_t)len, (uint64_t)_eraseSize);
       uint64_t elen = (end > start) ? (end - start) : 0;
@@ -150,31 +596,489 @@ private:
       return true;
     }
     // For non-FF payload:
-    const bool inDir = (addr < DATA_START);
+    const bool inDir = (addr < _dirEnd);
     if (_eraseSize > 0) {
-      if (inDir) {
+      if (regionIsErased(addr, len)) {
+        _stats.sectorsProgrammed += sectorSpan(addr, len);
+      } else if (_type == DeviceType::NorW25Q) {
+        return writeNorInPlace(addr, buf, len, inDir);
+      } else if (inDir) {
         // Directory writes MUST target previously erased (0xFF) space.
         // Avoid erasing to preserve prior directory entries.
-        if (!regionIsErased(addr, len)) {
-          return false;
+        return false;
+      } else {
+        // DATA region (NAND): erase the covering range.
+        uint64_t start = alignDown((uint64_t)addr, (uint64_t)_eraseSize);
+        uint64_t end = alignUp64((uint64_t)addr + (uint64_t)len, (uint64_t)_eraseSize);
+        uint64_t elen = (end > start) ? (end - start) : 0;
+        if (elen) {
+          if (!eraseRange(start, elen)) return false;
         }
+        _stats.sectorsErased += sectorSpan(addr, len);
+      }
+    }
+    return devWrite(addr, buf, len);
+  }
+  // NOR programming can only clear bits. Per sector: skip when the data is already there,
+  // program in place when (old & new) == new, and erase only sectors that need a 0->1 bit.
+  // Consecutive erase-needing sectors are erased as one range (block erases).
+  bool writeNorInPlace(uint64_t addr, const uint8_t* buf, size_t len, bool inDir) {
+    const uint64_t end = addr + len;
+    uint64_t runStart = 0, runEnd = 0;  // pending erase run
+    uint64_t pos = addr;
+    while (pos < end) {
+      uint64_t secEnd = min<uint64_t>(end, alignDown(pos, _eraseSize) + _eraseSize);
+      int cls = classifyNor(pos, buf + (pos - addr), (size_t)(secEnd - pos));
+      if (cls < 0) return false;
+      if (cls == 2) {
+        // Directory records are never erased in place (would drop neighbours)
+        if (inDir) return false;
+        if (runEnd != pos || runEnd == 0) {
+          if (!eraseAndProgram(addr, buf, runStart, runEnd)) return false;
+          runStart = pos;
+        }
+        runEnd = secEnd;
+        _stats.sectorsErased++;
       } else {
-        // DATA region: ensure erased. If not, erase the covering range.
-        if (!regionIsErased(addr, len)) {
-          uint64_t start = alignDown((uint64_t)addr, (uint64_t)_eraseSize);
-          uint64_t end = alignUp64((uint64_t)addr + (uint64_t)len, (uint64_t)_eraseSize);
-          uint64_t elen = (end > start) ? (end - start) : 0;
-          if (elen) {
-            if (!eraseRange(start, elen)) return false;
-          }
+        if (!eraseAndProgram(addr, buf, runStart, runEnd)) return false;
+        runStart = runEnd = 0;
+        if (cls == 1) {
+          if (!devWrite(pos, buf + (pos - addr), (size_t)(secEnd - pos))) return false;
+          _stats.sectorsBitClear++;
+        } else {
+          _stats.sectorsUnchanged++;
         }
       }
+      pos = secEnd;
+    }
+    return eraseAndProgram(addr, buf, runStart, runEnd);
+  }
+  bool eraseAndProgram(uint64_t addr, const uint8_t* buf, uint64_t runStart, uint64_t runEnd) {
+    if (runEnd <= runStart) return true;
+    uint64_t start = alignDown(runStart, _eraseSize);
+    if (!eraseRange(start, alignUp64(runEnd, _eraseSize) - start)) return false;
+    return devWrite(runStart, buf + (runStart - addr), (size_t)(runEnd - runStart));
+  }
+  // 0: identical, 1: programmable by clearing bits only, 2: needs erase, -1: read error
+  int classifyNor(uint64_t addr, const uint8_t* data, size_t len) {
+    uint8_t old[256];
+    bool identical = true;
+    size_t off = 0;
+    while (off < len) {
+      size_t n = min<size_t>(sizeof(old), len - off);
+      if (_dev->read(addr + off, old, n) != n) return -1;
+      for (size_t i = 0; i < n; ++i) {
+        uint8_t o = old[i], w = data[off + i];
+        if ((o & w) != w) return 2;
+        if (o != w) identical = false;
+      }
+      off += n;
+    }
+    return identical ? 0 : 1;
+  }
+  uint32_t sectorSpan(uint64_t addr, uint64_t len) const {
+    if (_eraseSize == 0 || len == 0) return 0;
+    return (uint32_t)((alignUp64(addr + len, _eraseSize) - alignDown(addr, _eraseSize)) / _eraseSize);
+  }
+  // Every program goes through here so the erased map and the cache stay coherent
+  bool devWrite(uint64_t addr, const uint8_t* buf, size_t len) {
+    fireWriteGuard();
+    markDirty(addr, len);
+    markChanged(addr, len);
+    if (!_dev->write(addr, buf, len)) {
+      cacheInvalidate(addr, len);
+      return false;
+    }
+    cacheUpdate(addr, buf, len);
+    return true;
+  }
+  // Flush dirty lines overlapping a range about to be read straight from the device
+  void cacheFlushRange(uint64_t addr, uint64_t len) {
+    if (!_lines) return;
+    for (size_t i = 0; i < UNIFIED_FS_CACHE_LINES; ++i) {
+      const CacheLine& l = _lines[i];
+      if (l.dirty && l.addr < addr + len && addr < l.addr + UNIFIED_FS_CACHE_LINE_SIZE) cacheFlushLine(i);
+    }
+  }
+  struct CacheLine {
+    uint64_t addr = 0;
+    uint32_t tick = 0;
+    bool valid = false;
+    bool dirty = false;
+  };
+  uint8_t* lineData(size_t i) const {
+    return _lineData + i * UNIFIED_FS_CACHE_LINE_SIZE;
+  }
+  uint32_t lineLen(uint64_t lineAddr) const {
+    uint64_t cap = _dev->capacity();
+    if (lineAddr >= cap) return 0;
+    return (uint32_t)min<uint64_t>(UNIFIED_FS_CACHE_LINE_SIZE, cap - lineAddr);
+  }
+  int cacheFind(uint64_t lineAddr) const {
+    for (size_t i = 0; i < UNIFIED_FS_CACHE_LINES; ++i)
+      if (_lines[i].valid && _lines[i].addr == lineAddr) return (int)i;
+    return -1;
+  }
+  bool cacheFlushLine(size_t i) {
+    CacheLine& l = _lines[i];
+    if (!l.dirty) return true;
+    l.dirty = false;
+    _cstats.writebacks++;
+    return _dev->write(l.addr, lineData(i), lineLen(l.addr));
+  }
+  // Returns a line holding lineAddr (filled from the device), evicting the LRU one; -1 on error
+  int cacheLoad(uint64_t lineAddr) {
+    int i = cacheFind(lineAddr);
+    if (i >= 0) {
+      _cstats.hits++;
+      _lines[i].tick = ++_tick;
+      return i;
+    }
+    _cstats.misses++;
+    size_t victim = 0;
+    for (size_t k = 0; k < UNIFIED_FS_CACHE_LINES; ++k) {
+      if (!_lines[k].valid) {
+        victim = k;
+        break;
+      }
+      if (_lines[k].tick < _lines[victim].tick) victim = k;
+    }
+    if (!cacheFlushLine(victim)) return -1;
+    CacheLine& l = _lines[victim];
+    l.valid = false;
+    uint32_t n = lineLen(lineAddr);
+    if (n == 0 || _dev->read(lineAddr, lineData(victim), n) != n) return -1;
+    l.addr = lineAddr;
+    l.valid = true;
+    l.tick = ++_tick;
+    return (int)victim;
+  }
+  bool cachedRead(uint64_t addr, uint8_t* buf, size_t len) {
+    if (len >= 2 * UNIFIED_FS_CACHE_LINE_SIZE) {
+      // Large read: one device transaction; flush overlapping dirty lines first
+      cacheFlushRange(addr, len);
+      _cstats.bypass++;
+      return _dev->read(addr, buf, len) == len;
+    }
+    size_t done = 0;
+    while (done < len) {
+      uint64_t a = addr + done;
+      uint64_t lineAddr = a & ~(uint64_t)(UNIFIED_FS_CACHE_LINE_SIZE - 1);
+      int i = cacheLoad(lineAddr);
+      if (i < 0) return false;
+      uint32_t off = (uint32_t)(a - lineAddr);
+      size_t n = min<size_t>(len - done, lineLen(lineAddr) - off);
+      memcpy(buf + done, lineData(i) + off, n);
+      done += n;
+    }
+    return true;
+  }
+  bool cachedWrite(uint64_t addr, const uint8_t* buf, size_t len) {
+    fireWriteGuard();
+    markChanged(addr, len);
+    raUpdate(addr, buf, len);
+    size_t done = 0;
+    while (done < len) {
+      uint64_t a = addr + done;
+      uint64_t lineAddr = a & ~(uint64_t)(UNIFIED_FS_CACHE_LINE_SIZE - 1);
+      int i = cacheLoad(lineAddr);
+      if (i < 0) return false;
+      uint32_t off = (uint32_t)(a - lineAddr);
+      size_t n = min<size_t>(len - done, lineLen(lineAddr) - off);
+      memcpy(lineData(i) + off, buf + done, n);
+      _lines[i].dirty = true;
+      done += n;
+    }
+    return true;
+  }
+  void raUpdate(uint64_t addr, const uint8_t* buf, size_t len) {
+    if (!_raLen) return;
+    uint64_t a = max<uint64_t>(addr, _raAddr);
+    uint64_t b = min<uint64_t>(addr + len, _raAddr + _raLen);
+    if (a < b) memcpy(_ra + (a - _raAddr), buf + (a - addr), (size_t)(b - a));
+  }
+  void cacheUpdate(uint64_t addr, const uint8_t* buf, size_t len) {
+    raUpdate(addr, buf, len);
+    if (!_lines || _policy == CachePolicy::Off) return;
+    for (size_t i = 0; i < UNIFIED_FS_CACHE_LINES; ++i) {
+      const CacheLine& l = _lines[i];
+      if (!l.valid) continue;
+      uint64_t a = max<uint64_t>(addr, l.addr);
+      uint64_t b = min<uint64_t>(addr + len, l.addr + UNIFIED_FS_CACHE_LINE_SIZE);
+      if (a < b) memcpy(lineData(i) + (a - l.addr), buf + (a - addr), (size_t)(b - a));
     }
-    return _dev->write((uint64_t)addr, buf, len);
+  }
+  void fireWriteGuard() {
+    if (!_guardArmed) return;
+    _guardArmed = false;
+    static const uint8_t zero[4] = { 0, 0, 0, 0 };
+    markDirty(_guardAddr, sizeof(zero));
+    if (_dev->write(_guardAddr, zero, sizeof(zero))) cacheUpdate(_guardAddr, zero, sizeof(zero));
+    else cacheInvalidate(_guardAddr, sizeof(zero));
+  }
+  void markChanged(uint64_t addr, uint64_t len) {
+    if (!_cmap || len == 0) return;
+    uint64_t g1 = (addr + len - 1) >> _cgranuleShift;
+    for (uint64_t g = addr >> _cgranuleShift; g <= g1 && g < _cmapBits; ++g) _cmap[g >> 3] |= (uint8_t)(1u << (g & 7));
+  }
+  bool granuleErased(uint64_t g) const {
+    return (_emap[g >> 3] & (uint8_t)(1u << (g & 7))) != 0;
+  }
+  void allocErasedMap() {
+    delete[] _emap;
+    _emap = nullptr;
+    _emapBits = 0;
+    if (!_dev || _eraseSize == 0) return;
+    uint64_t cap = _dev->capacity();
+    uint32_t g = _dev->pageSize();
+    if (g == 0 || (g & (g - 1)) != 0) g = 256;
+    uint8_t shift = 0;
+    while ((1u << shift) < g) ++shift;
+    while ((cap >> shift) > UNIFIED_FS_ERASED_MAP_BITS) ++shift;
+    _granuleShift = shift;
+    _granule = 1u << shift;
+    _emapBits = (uint32_t)((cap + _granule - 1) >> shift);
+    _emap = new uint8_t[(_emapBits + 7) / 8];
+    memset(_emap, 0, (_emapBits + 7) / 8);
   }
   UnifiedSpiMem::MemDevice* _dev;
   DeviceType _type;
   uint32_t _eraseSize;
+  uint8_t* _emap = nullptr;
+  uint32_t _emapBits = 0;
+  uint32_t _granule = 0;
+  uint8_t _granuleShift = 0;
+  uint8_t* _cmap = nullptr;  // changed-since-checkpoint granules (trackChanges)
+  uint32_t _cmapBits = 0;
+  uint8_t _cgranuleShift = 0;
+  uint64_t _guardAddr = 0;
+  bool _guardArmed = false;
+  bool _verifyErased = (UNIFIED_FS_VERIFY_ERASED != 0);
+  WriteStats _stats;
+  CachePolicy _policy = CachePolicy::Off;
+  CacheLine* _lines = nullptr;
+  uint8_t* _lineData = nullptr;
+  uint32_t _tick = 0;
+  CacheStats _cstats;
+  uint8_t* _ra = nullptr;  // read-ahead window
+  uint64_t _raAddr = 0;
+  uint32_t _raLen = 0;
+};
+
+// -------------------------------------------
+/* LZSS codec for compressed files (heatshrink-style, byte aligned)
+   Stream: [ctrl][up to 8 items]... ctrl bit i (LSB first): 0 = literal byte,
+   1 = match: 2 bytes, offset-1 (10 bits: b0 | b1[7:6] << 8), len-3 (6 bits: b1[5:0]).
+   The 1 KiB window bounds decoder RAM; the encoder matches against the input buffer.
+   File layout v2: header, restart table (BE32 stream offset of each BLOCK of raw bytes,
+   counted from the end of the table), then the blocks, each an independent stream (no match
+   reaches before its block, its last group is not continued), so a seek decodes at most one
+   block. v1 files are one stream with no table. */
+struct UnifiedFSLz {
+  static constexpr uint32_t WINDOW = 1024;
+  static constexpr uint32_t MIN_MATCH = 3;
+  static constexpr uint32_t MAX_MATCH = 66;
+  static constexpr uint32_t HASH_SIZE = 1024;
+  static constexpr uint32_t MAX_CHAIN = 32;
+  static constexpr uint32_t BLOCK = 4096;  // v2 restart interval (raw bytes)
+  // Stored in front of the compressed stream: 'Z' 'L' version window-bits rawSize(BE32)
+  static constexpr uint32_t HEADER_SIZE = 8;
+  typedef bool (*Sink)(void* ctx, const uint8_t* p, size_t n);  // false aborts compress()
+  static uint32_t blockCount(uint32_t rawSize) {
+    return (uint32_t)(((uint64_t)rawSize + BLOCK - 1) / BLOCK);
+  }
+  static void writeHeader(uint8_t* h, uint32_t rawSize) {
+    h[0] = 'Z';
+    h[1] = 'L';
+    h[2] = 2;
+    h[3] = 10;
+    h[4] = (uint8_t)(rawSize >> 24);
+    h[5] = (uint8_t)(rawSize >> 16);
+    h[6] = (uint8_t)(rawSize >> 8);
+    h[7] = (uint8_t)rawSize;
+  }
+  // version: 1 (one stream) or 2 (restart table and blocks)
+  static bool parseHeader(const uint8_t* h, uint32_t& rawSize, uint8_t* version = nullptr) {
+    if (h[0] != 'Z' || h[1] != 'L' || (h[2] != 1 && h[2] != 2) || h[3] != 10) return false;
+    rawSize = (uint32_t)h[4] << 24 | (uint32_t)h[5] << 16 | (uint32_t)h[6] << 8 | (uint32_t)h[7];
+    if (version) *version = h[2];
+    return true;
+  }
+  // Match tables, reused across the blocks of one file
+  struct Tables {
+    uint32_t* head = nullptr;  // last position + 1
+    uint16_t* prev = nullptr;  // distance to previous, 0 = none
+    bool alloc() {
+      head = (uint32_t*)malloc(HASH_SIZE * sizeof(uint32_t));
+      prev = (uint16_t*)malloc(WINDOW * sizeof(uint16_t));
+      return head && prev;
+    }
+    ~Tables() {
+      free(head);
+      free(prev);
+    }
+  };
+  // Greedy hash-chain compressor; output goes to sink in chunks of up to 256 bytes
+  static bool compress(const uint8_t* in, uint32_t n, Sink sink, void* ctx, uint32_t* outLen = nullptr) {
+    Tables t;
+    return t.alloc() && compress(t, in, n, sink, ctx, outLen);
+  }
+  // One independent stream over in[0, n) (the tables start empty)
+  static bool compress(Tables& t, const uint8_t* in, uint32_t n, Sink sink, void* ctx, uint32_t* outLen = nullptr) {
+    uint32_t* head = t.head;
+    uint16_t* prev = t.prev;
+    memset(head, 0, HASH_SIZE * sizeof(uint32_t));
+    memset(prev, 0, WINDOW * sizeof(uint16_t));
+    uint8_t out[256];
+    size_t outPos = 0;
+    uint32_t total = 0;
+    uint8_t group[1 + 8 * 2];
+    size_t gLen = 1;
+    uint8_t gItems = 0;
+    group[0] = 0;
+    bool ok = true;
+    auto flushGroup = [&]() {
+      if (outPos + gLen > sizeof(out)) {
+        ok = ok && sink(ctx, out, outPos);
+        total += outPos;
+        outPos = 0;
+      }
+      memcpy(out + outPos, group, gLen);
+      outPos += gLen;
+      gLen = 1;
+      gItems = 0;
+      group[0] = 0;
+    };
+    auto insert = [&](uint32_t p) {
+      if (p + MIN_MATCH > n) return;
+      uint32_t h = hash3(in + p);
+      uint32_t last = head[h];
+      uint32_t d = last ? (p - (last - 1)) : 0;
+      prev[p & (WINDOW - 1)] = (uint16_t)((d && d <= WINDOW) ? d : 0);
+      head[h] = p + 1;
+    };
+    uint32_t pos = 0;
+    while (ok && pos < n) {
+      uint32_t bestLen = 0, bestOff = 0;
+      if (pos + MIN_MATCH <= n) {
+        const uint32_t maxLen = min<uint32_t>(MAX_MATCH, n - pos);
+        uint32_t cand = head[hash3(in + pos)];
+        for (uint32_t steps = 0; cand && steps < MAX_CHAIN; ++steps) {
+          uint32_t c = cand - 1;
+          uint32_t dist = pos - c;
+          if (dist == 0 || dist > WINDOW) break;
+          uint32_t l = 0;
+          while (l < maxLen && in[c + l] == in[pos + l]) ++l;
+          if (l > bestLen) {
+            bestLen = l;
+            bestOff = dist;
+            if (l == maxLen) break;
+          }
+          uint16_t d = prev[c & (WINDOW - 1)];
+          if (!d || d > c) break;
+          cand = c - d + 1;
+        }
+      }
+      if (bestLen >= MIN_MATCH) {
+        group[0] |= (uint8_t)(1u << gItems);
+        group[gLen++] = (uint8_t)((bestOff - 1) & 0xFF);
+        group[gLen++] = (uint8_t)((((bestOff - 1) >> 8) << 6) | (bestLen - MIN_MATCH));
+        for (uint32_t k = 0; k < bestLen; ++k) insert(pos + k);
+        pos += bestLen;
+      } else {
+        group[gLen++] = in[pos];
+        insert(pos);
+        pos += 1;
+      }
+      if (++gItems == 8) flushGroup();
+    }
+    if (gItems) flushGroup();
+    if (ok && outPos) ok = sink(ctx, out, outPos);
+    total += outPos;
+    if (outLen) *outLen = total;
+    return ok;
+  }
+  // Streaming decoder; Source provides bool next(uint8_t&)
+  struct Decoder {
+    uint8_t win[WINDOW];
+    uint32_t out = 0;   // raw bytes produced so far
+    uint32_t base = 0;  // raw offset of the current block (matches stay above it)
+    uint16_t wpos = 0;
+    uint16_t mOff = 0, mLen = 0;  // match still being copied
+    uint8_t ctrl = 0, items = 0;
+    bool failed = false;
+    void reset() {
+      out = 0;
+      base = 0;
+      wpos = 0;
+      mOff = mLen = 0;
+      ctrl = items = 0;
+      failed = false;
+    }
+    // Continue with the v2 block starting at raw offset at (decoded from its first byte)
+    void restartAt(uint32_t at) {
+      reset();
+      out = base = at;
+    }
+    // Sequential decode reached the end of a v2 block: the next one opens a new group
+    void nextBlock() {
+      base = out;
+      ctrl = items = 0;
+    }
+    // Produce up to n bytes into dst (nullptr: skip them); returns the count produced
+    template<typename Source>
+    size_t decode(uint8_t* dst, size_t n, Source& src) {
+      size_t done = 0;
+      while (!failed && done < n) {
+        if (mLen) {
+          put(win[(wpos - mOff) & (WINDOW - 1)], dst, done);
+          --mLen;
+          continue;
+        }
+        if (items == 0) {
+          if (!src.next(ctrl)) break;
+          items = 8;
+        }
+        const bool isMatch = (ctrl & 1) != 0;
+        ctrl >>= 1;
+        --items;
+        uint8_t b0, b1;
+        if (!src.next(b0)) break;
+        if (!isMatch) {
+          put(b0, dst, done);
+          continue;
+        }
+        if (!src.next(b1)) break;
+        mOff = (uint16_t)((b0 | ((uint16_t)(b1 >> 6) << 8)) + 1);
+        mLen = (uint16_t)((b1 & 0x3F) + MIN_MATCH);
+        if (mOff > out - base) failed = true;  // corrupt stream
+      }
+      return done;
+    }
+  private:
+    inline void put(uint8_t c, uint8_t* dst, size_t& done) {
+      win[wpos] = c;
+      wpos = (uint16_t)((wpos + 1) & (WINDOW - 1));
+      if (dst) dst[done] = c;
+      ++done;
+      ++out;
+    }
+  };
+  // Whole-buffer helper: decode exactly rawSize bytes from a memory stream
+  struct MemSource {
+    const uint8_t* p;
+    size_t n;
+    bool next(uint8_t& c) {
+      if (!n) return false;
+      c = *p++;
+      --n;
+      return true;
+    }
+  };
+private:
+  static inline uint32_t hash3(const uint8_t* p) {
+    return ((uint32_t)p[0] * 2654435761u ^ (uint32_t)p[1] * 40503u ^ p[2]) & (HASH_SIZE - 1);
+  }
 };
 
 // -------------------------------------------
@@ -187,9 +1091,8 @@ template<typename Driver>
 class UnifiedSimpleFS_Generic {
 public:
   static const uint32_t DIR_START = 0x000000UL;
-  static const uint32_t DIR_SIZE = 64UL * 1024UL;
+  static const uint32_t LEGACY_DIR_SIZE = 64UL * 1024UL;  // volumes formatted without a superblock
   static const uint32_t ENTRY_SIZE = 32;  // logical entry size
-  static const uint32_t DATA_START = DIR_START + DIR_SIZE;
   static const size_t MAX_NAME = 32;
   enum class WriteMode : uint8_t {
     ReplaceIfExists = 0,
@@ -197,53 +1100,84 @@ public:
   };
   struct FileInfo {
     char name[MAX_NAME + 1];
-    uint32_t addr;
-    uint32_t size;
+    uint64_t addr;
+    uint64_t size;
     uint32_t seq;
     bool deleted;
-    uint32_t capEnd;
+    uint64_t capEnd;
     bool slotSafe;
+    bool compressed;   // record flag 0x02: data is an UnifiedFSLz stream, size is the stored length
+    uint64_t rawSize;  // decompressed length (== size when not compressed)
+    bool crcValid;     // crc (CRC-32 of the raw contents) is known: stored with the record or verified
+    uint32_t crc;
+    uint32_t gen;      // RAM only: renewed by every change, including in-place writes without a record
   };
-  UnifiedSimpleFS_Generic(Driver& dev, uint32_t capacityBytes)
+  UnifiedSimpleFS_Generic(Driver& dev, uint64_t capacityBytes)
     : _dev(dev), _capacity(capacityBytes) {
     _fileCount = 0;
-    _dirWriteOffset = 0;
+    memset(_order, 0, sizeof(_order));  // unlocked readers may index _files through any entry
+    _dirWriteOffset = _dirFirst;
     _nextSeq = 1;
-    _dataHead = DATA_START;
+    _dataHead = _dataStart;
     // Runtime params (init lazily)
     _paramsInit = false;
     _isNand = false;
     _eraseAlign = 1;
+    _blockAlign = 1;
     _nandPage = ENTRY_SIZE;
     _dirStride = ENTRY_SIZE;
     _dirScratch = nullptr;
     _lastSeqWritten = 0;
+    _mounted = false;
+    _preEraseBytes = UNIFIED_FS_PREERASE_BYTES;
+    _preErasePos = 0;
+    _preEraseCheck = 0;
+    _preEraseUnit = 0;
+    _seqFile = ~0ULL;
+    _seqNext = 0;
   }
   ~UnifiedSimpleFS_Generic() {
+    delete _z;
     if (_dirScratch) {
       delete[] _dirScratch;
       _dirScratch = nullptr;
     }
   }
   bool mount(bool autoFormatIfEmpty = true) {
-    if (_capacity == 0 || _capacity <= DATA_START) return false;
+    if (_capacity == 0) return false;
     ensureParams();
+    if (!readLayout() || _capacity <= _dataStart) return false;
+    // Durable snapshot: load it and replay only the records appended after it
+    if (durableSnapshot() && resumeFromSnapshot()) return true;
+    _snapReplayed = 0;
     _fileCount = 0;
-    _dirWriteOffset = 0;
+    _dirWriteOffset = _dirFirst;
     _nextSeq = 1;
-    _dataHead = DATA_START;
-    uint32_t maxEnd = DATA_START;
+    _dataHead = _dataStart;
+    uint64_t maxEnd = _dataStart;
     uint32_t maxSeq = 0;
+    _lastRecOff = 0;
+    if (!replayLog(_dirFirst, maxEnd, maxSeq)) {
+      _dirWriteOffset = _dirFirst;
+      // Blank device: lay out a directory sized for it (a superblock volume is just empty)
+      if (autoFormatIfEmpty && !_dirFirst && format()) return true;
+    }
+    finishMount(maxEnd, maxSeq);
+    return true;
+  }
+  // Apply directory records from offset from on; false when the log is empty there
+  bool replayLog(uint32_t from, uint64_t& maxEnd, uint32_t& maxSeq) {
     bool sawAny = false;
-
     const uint32_t stride = _dirStride;  // 32 for NOR/PSRAM, pageSize for NAND
-    const uint32_t entries = DIR_SIZE / stride;
-    uint8_t buf[ENTRY_SIZE];
+    const uint32_t entries = _dirSize / stride;
+    uint8_t buf[ENTRY_SIZE * 2];
+    const uint32_t readLen = _isNand ? 2 * ENTRY_SIZE : ENTRY_SIZE;  // NAND: record + extension
+    int lastIdx = -1;  // owner of a following extension record
 
-    for (uint32_t i = 0; i < entries; ++i) {
+    for (uint32_t i = from / stride; i < entries; ++i) {
       uint32_t addr = DIR_START + i * stride;
       // Only read logical entry header (32 bytes)
-      if (!_dev.readData03(addr, buf, ENTRY_SIZE)) {
+      if (!_dev.readData03(addr, buf, readLen)) {
         // Read error: treat as empty and stop scanning to avoid corruption
         _dirWriteOffset = i * stride;
         break;
@@ -253,6 +1187,13 @@ public:
         break;
       }
       sawAny = true;
+      if (buf[0] == 0x57 && buf[1] == 0x58) {
+        applyExtRecord(lastIdx, buf, maxEnd);  // NOR/PSRAM: extension in the next slot
+        lastIdx = -1;
+        if (i == entries - 1) _dirWriteOffset = _dirSize;
+        continue;
+      }
+      lastIdx = -1;
       if (buf[0] != 0x57 || buf[1] != 0x46) continue;
       uint8_t flags = buf[2];
       uint8_t nameLen = buf[3];
@@ -260,100 +1201,144 @@ public:
       char nameBuf[MAX_NAME + 1];
       memset(nameBuf, 0, sizeof(nameBuf));
       for (uint8_t k = 0; k < nameLen; ++k) nameBuf[k] = (char)buf[4 + k];
-      uint32_t faddr = rd32(&buf[20]);
-      uint32_t fsize = rd32(&buf[24]);
+      uint64_t faddr = rd32(&buf[20]);
+      uint64_t fsize = rd32(&buf[24]);
       uint32_t seq = rd32(&buf[28]);
       if (seq > maxSeq) maxSeq = seq;
-      int idx = findIndexByName(nameBuf);
-      if (idx < 0) {
-        if (_fileCount < MAX_FILES) {
-          idx = _fileCount++;
-          copyName(_files[idx].name, nameBuf);
-        } else {
-          continue;
-        }
+      _lastRecOff = i * stride;
+      if ((flags & (0x01 | FLAG_PREFIX)) == (0x01 | FLAG_PREFIX)) {
+        deleteIndexPrefix(nameBuf, seq);  // prefix tombstone: the whole subtree, no slot of its own
+        if (i >= entries - 1) _dirWriteOffset = _dirSize;
+        continue;
       }
+      int idx = findIndexByName(nameBuf);
+      if (idx < 0) idx = addSlot(nameBuf);
+      if (idx < 0) continue;
       bool deleted = (flags & 0x01) != 0;
+      touch(_files[idx]);
       _files[idx].seq = seq;
       _files[idx].deleted = deleted;
-      if (!deleted) {
-        _files[idx].addr = faddr;
-        _files[idx].size = fsize;
-        uint32_t end = faddr + fsize;
-        if (end > maxEnd) maxEnd = end;
-      } else {
-        _files[idx].addr = 0;
-        _files[idx].size = 0;
+      _files[idx].compressed = !deleted && (flags & FLAG_COMPRESSED) != 0;
+      _files[idx].rawSize = _files[idx].compressed ? 0 : fsize;  // compressed: read from the stream header
+      _files[idx].crcValid = false;
+      _files[idx].addr = deleted ? 0 : faddr;
+      _files[idx].size = deleted ? 0 : fsize;
+      if (!deleted && faddr + fsize > maxEnd) maxEnd = faddr + fsize;
+      lastIdx = idx;
+      if (_isNand) {
+        applyExtRecord(lastIdx, buf + ENTRY_SIZE, maxEnd);  // NAND: extension shares the record's page
+        lastIdx = -1;
+      } else if (!deleted && (flags & FLAG_INLINE)) {
+        // NOR/PSRAM: extension, then the inline data slots
+        if (_dev.readData03(addr + ENTRY_SIZE, buf, ENTRY_SIZE)) applyExtRecord(lastIdx, buf, maxEnd);
+        lastIdx = -1;
+        i += 1 + (uint32_t)(alignUp(fsize, ENTRY_SIZE) / ENTRY_SIZE);
       }
-      if (i == entries - 1) _dirWriteOffset = DIR_SIZE;
+      if (i >= entries - 1) _dirWriteOffset = _dirSize;
     }
-    if (!sawAny) {
-      _dirWriteOffset = 0;
-      if (autoFormatIfEmpty) format();
+    return sawAny;
+  }
+  void finishMount(uint64_t maxEnd, uint32_t maxSeq) {
+    // Compressed files keep their raw length in the stream header
+    for (size_t i = 0; i < _fileCount; ++i) {
+      FileInfo& fi = _files[i];
+      if (fi.deleted || !fi.compressed || fi.rawSize) continue;  // snapshot entries already have it
+      uint8_t h[UnifiedFSLz::HEADER_SIZE];
+      uint32_t raw = 0;
+      fi.rawSize = (fi.size >= sizeof(h) && _dev.readData03(fi.addr, h, sizeof(h)) && UnifiedFSLz::parseHeader(h, raw)) ? raw : 0;
     }
     _nextSeq = maxSeq + 1;
     if (_nextSeq == 0) _nextSeq = 1;
     _dataHead = maxEnd;
+    // Data grown into the snapshot area (reserved after it was written): give the area up
+    if (_snapAddr && _dataHead > _snapAddr) {
+      _capacity += snapAreas() * snapAreaBytes();
+      _snapAddr = 0;
+    }
     computeCapacities(_dataHead);
-    return true;
+    _mounted = true;
+    resetPreErase();
   }
+  // Fresh log with a superblock; the directory is sized by plannedDirSize()
   bool format() {
     ensureParams();
-    // Fill DIR with 0xFF (driver will translate to erase on NOR/NAND)
-    const uint32_t PAGE_CHUNK = 256;
-    uint8_t tmp[PAGE_CHUNK];
-    memset(tmp, 0xFF, PAGE_CHUNK);
-    for (uint32_t i = 0; i < DIR_SIZE; i += PAGE_CHUNK) {
-      uint32_t chunk = (i + PAGE_CHUNK <= DIR_SIZE) ? PAGE_CHUNK : (DIR_SIZE - i);
-      if (!_dev.writeData02(DIR_START + i, tmp, chunk)) return false;
+    const uint32_t dirSize = plannedDirSize();
+    if (!dirSize) return false;
+    if (_eraseAlign > 1) {
+      // One coalesced erase (whole blocks on NOR) instead of per-chunk sector erases
+      if (!_dev.eraseRange(DIR_START, dirSize)) return false;
+    } else {
+      // PSRAM: fill DIR with 0xFF
+      const uint32_t PAGE_CHUNK = 256;
+      uint8_t tmp[PAGE_CHUNK];
+      memset(tmp, 0xFF, PAGE_CHUNK);
+      for (uint32_t i = 0; i < dirSize; i += PAGE_CHUNK) {
+        uint32_t chunk = (i + PAGE_CHUNK <= dirSize) ? PAGE_CHUNK : (dirSize - i);
+        if (!_dev.writeData02(DIR_START + i, tmp, chunk)) return false;
+      }
     }
-    _fileCount = 0;
-    _dirWriteOffset = 0;
-    _nextSeq = 1;
-    _dataHead = DATA_START;
-    computeCapacities(_dataHead);
-    return true;
+    dropSnapshot();
+    return startLog(dirSize);
   }
   bool wipeChip() {
     ensureParams();
     if (_capacity == 0) return false;
     if (_eraseAlign > 1) {
-      // Fast path: use erase units across the device
-      uint64_t pos = 0;
-      while (pos < _capacity) {
-        uint64_t remain = _capacity - pos;
-        uint64_t n = (remain >= _eraseAlign) ? _eraseAlign : remain;
-        if (!_dev.eraseRange(pos, n)) return false;
-        pos += n;
-      }
+      // Fast path: whole-device range lets the device pick chip/block erase
+      if (!_dev.eraseRange(0, _capacity)) return false;
     } else {
       // PSRAM: write 0xFF
       const uint32_t CHUNK = 256;
       uint8_t tmp[CHUNK];
       memset(tmp, 0xFF, CHUNK);
-      uint32_t pos = 0;
+      uint64_t pos = 0;
       while (pos < _capacity) {
-        uint32_t n = (pos + CHUNK <= _capacity) ? CHUNK : (_capacity - pos);
+        uint32_t n = (uint32_t)min<uint64_t>(CHUNK, _capacity - pos);
         if (!_dev.writeData02(pos, tmp, n)) return false;
         pos += n;
       }
     }
-    _fileCount = 0;
-    _dirWriteOffset = 0;
-    _dataHead = DATA_START;
-    computeCapacities(_dataHead);
-    return true;
+    dropSnapshot();
+    return startLog(plannedDirSize());
+  }
+  // Directory bytes for the next format(); 0 = UNIFIED_FS_DIR_SIZE or the capacity share
+  void setFormatDirSize(uint32_t bytes) {
+    _formatDirSize = bytes;
+  }
+  // UNIFIED_FS_DIR_MIN_RECORDS .. half the device, whole erase units (0: device too small)
+  uint32_t plannedDirSize() {
+    ensureParams();
+    uint64_t want = _formatDirSize ? _formatDirSize : UNIFIED_FS_DIR_SIZE ? UNIFIED_FS_DIR_SIZE : _capacity / UNIFIED_FS_DIR_SHARE;
+    const uint32_t unit = max(_eraseAlign, _dirStride);
+    const uint64_t lo = alignUp((UNIFIED_FS_DIR_MIN_RECORDS + 1) * _dirStride, unit);  // + the superblock
+    const uint64_t hi = min<uint64_t>(_capacity / 2, 0x80000000UL) / unit * unit;   // directory offsets stay 32-bit
+    want = alignUp(max(want, lo), unit);
+    if (want > hi) want = hi;
+    return want >= lo ? (uint32_t)want : 0;
+  }
+  uint32_t dirSize() const {
+    return _dirSize;
+  }
+  // Superblock version of the mounted volume (0: legacy layout, 64 KiB directory, no superblock;
+  // 1: 32-bit extents only; 2: records past 4 GiB carry the high words in their extension;
+  // 3: prefix tombstones)
+  uint8_t layoutVersion() const {
+    return _layoutVer;
   }
   bool writeFile(const char* name, const uint8_t* data, uint32_t size, WriteMode mode = WriteMode::ReplaceIfExists) {
     ensureParams();
-    if (!validName(name) || size > 0xFFFFFFUL) return false;
-    if (_dirWriteOffset + _dirStride > DIR_SIZE) return false;
+    if (!validName(name)) return false;
+    if (_dirWriteOffset + _dirStride > _dirSize) return false;
     int idxExisting = findIndexByName(name);
     bool exists = (idxExisting >= 0 && !_files[idxExisting].deleted);
     if (exists && mode == WriteMode::FailIfExists) return false;
+    const uint32_t crc = CRC32Fast::compute(data, size);
+    if (exists && sameContent(idxExisting, size, crc)) return true;
+    // NAND: the record's page is programmed anyway, so small files ride along
+    if (_isNand && size && fitsInline(size)) return writeInline(name, data, size, crc);
 
-    uint32_t start = _dataHead;
-    if (start < DATA_START) start = DATA_START;
+    uint64_t start = _dataHead;
+    if (start < _dataStart) start = _dataStart;
     if (start + size > _capacity) return false;
 
     if (size > 0) {
@@ -361,8 +1346,9 @@ public:
     }
 
     uint32_t seq = 0;
-    if (!appendDirEntry(0x00, name, start, size, seq)) return false;
+    if (!appendDirEntry(0x00, name, start, size, seq, &crc)) return false;
     upsertFileIndex(name, start, size, false, seq);
+    noteCrc(name, crc);
     _dataHead = start + size;
     computeCapacities(_dataHead);
     return true;
@@ -375,115 +1361,361 @@ public:
   bool writeFile(const char* name, const uint8_t* data, uint32_t size, ModeT modeOther) {
     return writeFile(name, data, size, (int)modeOther);
   }
-  bool createFileSlot(const char* name, uint32_t reserveBytes, const uint8_t* initialData = nullptr, uint32_t initialSize = 0) {
+  // Fills buf with len bytes of the contents at offset (writeFileFrom, writeFileCompressedFrom)
+  typedef bool (*ChunkSource)(void* ctx, uint64_t offset, uint8_t* buf, uint32_t len);
+  // Like writeFile(), but stores an UnifiedFSLz stream (record flag 0x02) streamed straight to
+  // the data head. Reads decompress transparently. A sizing pass runs first (no I/O) so data
+  // that does not shrink is written plain instead, without programming a discarded attempt.
+  bool writeFileCompressed(const char* name, const uint8_t* data, uint32_t size, WriteMode mode = WriteMode::ReplaceIfExists) {
+    if (size && !data) return false;
+    int idxExisting = findIndexByName(name);
+    // A plain copy with the same contents is still rewritten: the caller asked for compression
+    if (idxExisting >= 0 && _files[idxExisting].compressed && sameContent(idxExisting, size, CRC32Fast::compute(data, size))) return true;
+    bool plain = false;
+    if (writeCompressed(name, size, &memSource, (void*)data, mode, plain)) return true;
+    return plain && writeFile(name, data, size, mode);
+  }
+  // writeFileCompressed() pulling the contents from src one UnifiedFSLz::BLOCK at a time, so no
+  // whole-file buffer is needed. src is read twice (sizing pass, then the write).
+  bool writeFileCompressedFrom(const char* name, uint64_t size, ChunkSource src, void* ctx, WriteMode mode = WriteMode::ReplaceIfExists) {
+    bool plain = false;
+    if (writeCompressed(name, size, src, ctx, mode, plain)) return true;
+    return plain && writeFileFrom(name, size, src, ctx, mode);
+  }
+
+  // Like writeFile(), but pulls the contents from src in chunks of up to UNIFIED_FS_STREAM_CHUNK
+  // bytes (src(ctx, offset, buf, len) fills buf), so no whole-file buffer is needed.
+  bool writeFileFrom(const char* name, uint64_t size, ChunkSource src, void* ctx, WriteMode mode = WriteMode::ReplaceIfExists) {
+    ensureParams();
+    if (!validName(name) || !src) return false;
+    if (_dirWriteOffset + _dirStride > _dirSize) return false;
+    int idxExisting = findIndexByName(name);
+    if (idxExisting >= 0 && !_files[idxExisting].deleted && mode == WriteMode::FailIfExists) return false;
+    ZWriter w;
+    w.fs = this;
+    w.start = (_dataHead < _dataStart) ? _dataStart : _dataHead;
+    if (_isNand) w.start = alignUp(w.start, _nandPage);  // whole-page programs
+    if (w.start + size > _capacity) return false;
+    w.prepared = alignUp(w.start, _eraseAlign);
+    w.chunk = _isNand ? _nandPage : UNIFIED_FS_STREAM_CHUNK;
+    w.buf = (uint8_t*)malloc(w.chunk);
+    if (!w.buf) return false;
+    CRC32Fast::Crc32 crc;
+    bool ok = true;
+    for (uint64_t off = 0; ok && off < size;) {
+      const uint32_t n = (uint32_t)min<uint64_t>(w.chunk, size - off);
+      ok = src(ctx, off, w.buf, n);
+      if (ok) {
+        crc.update(w.buf, n);
+        w.fill = n;
+        ok = w.flush();
+      }
+      off += n;
+    }
+    free(w.buf);
+    if (!ok) return false;
+    uint32_t seq = 0;
+    const uint32_t sum = crc.value();
+    if (!appendDirEntry(0x00, name, w.start, size, seq, &sum)) return false;
+    upsertFileIndex(name, w.start, size, false, seq);
+    noteCrc(name, sum);
+    _dataHead = w.start + size;
+    computeCapacities(_dataHead);
+    return true;
+  }
+  bool createFileSlot(const char* name, uint64_t reserveBytes, const uint8_t* initialData = nullptr, uint32_t initialSize = 0) {
     ensureParams();
     if (!validName(name)) return false;
-    if (_dirWriteOffset + _dirStride > DIR_SIZE) return false;
+    if (_dirWriteOffset + _dirStride > _dirSize) return false;
     if (initialSize > reserveBytes) return false;
     if (exists(name)) return false;
+    // Tiny file whose whole reserve fits a record: pack it into the directory instead of
+    // burning a unit (a larger reserve means the caller intends to grow it in place)
+    if (reserveBytes <= inlineMax() && fitsInline(initialSize))
+      return writeInline(name, initialData, initialSize, CRC32Fast::compute(initialData, initialSize));
 
-    // Align capacity and start to erase alignment if erase is needed
-    uint32_t align = (_eraseAlign > 1) ? _eraseAlign : 1u;
-    uint32_t cap = alignUp((reserveBytes < 1u ? 1u : reserveBytes), align);
-    uint32_t start = alignUp(_dataHead, align);
-    if (start < DATA_START) start = DATA_START;
-    if (start + cap > _capacity) return false;
-
-    // Pre-erase/fill with 0xFF
-    if (_eraseAlign > 1) {
-      if (!_dev.eraseRange(start, cap)) return false;
-    } else {
-      // PSRAM fallback
-      const uint32_t PAGE_CHUNK = 256;
-      uint8_t tmp[PAGE_CHUNK];
-      memset(tmp, 0xFF, PAGE_CHUNK);
-      uint32_t p = start;
-      while (p < start + cap) {
-        uint32_t n = min<uint32_t>(PAGE_CHUNK, start + cap - p);
-        if (!_dev.writeData02(p, tmp, n)) return false;
-        p += n;
-      }
-    }
+    uint64_t start = 0, cap = 0;
+    if (!reserveSlot(reserveBytes, start, cap)) return false;
 
     if (initialSize > 0) {
       if (!_dev.writeData02(start, initialData, initialSize)) return false;
     }
     uint32_t seq = 0;
-    if (!appendDirEntry(0x00, name, start, initialSize, seq)) return false;
+    const uint32_t crc = CRC32Fast::compute(initialData, initialSize);
+    if (!appendDirEntry(0x00, name, start, initialSize, seq, &crc)) return false;
     upsertFileIndex(name, start, initialSize, false, seq);
+    noteCrc(name, crc);
+    _dataHead = start + cap;
+    computeCapacities(_dataHead);
+    return true;
+  }
+  // Erase-aligned slot whose whole reserve is the file: left erased, no CRC, never inlined.
+  // For in-place record stores (ring logs) that program it with writeFileRange() and
+  // eraseFileRange() without growing it, so no further directory records are appended.
+  bool createFixedFile(const char* name, uint64_t size) {
+    ensureParams();
+    if (!validName(name) || size == 0 || exists(name)) return false;
+    if (_dirWriteOffset + _dirStride > _dirSize) return false;
+    uint64_t start = 0, cap = 0;
+    uint32_t seq = 0;
+    if (!reserveSlot(size, start, cap)) return false;
+    if (!appendDirEntry(0x00, name, start, size, seq)) return false;
+    upsertFileIndex(name, start, size, false, seq);
     _dataHead = start + cap;
     computeCapacities(_dataHead);
     return true;
   }
+  // Erase [offset, offset+len) of a file in place (erase-unit aligned; PSRAM fills 0xFF).
+  // Units already reading erased are skipped. No directory record.
+  bool eraseFileRange(const char* name, uint64_t offset, uint32_t len) {
+    ensureParams();
+    int idx = findIndexByName(name);
+    if (idx < 0 || _files[idx].deleted || _files[idx].compressed || isInline(_files[idx])) return false;
+    const FileInfo& fi = _files[idx];
+    if (offset + len > fi.size) return false;
+    if ((offset % _eraseAlign) || (len % _eraseAlign)) return false;
+    if (len == 0) return true;
+    touch(_files[idx]);
+    if (_eraseAlign > 1) return _dev.ensureErased(fi.addr + offset, len);
+    return fillErased(fi.addr + offset, len);
+  }
+  // Program [offset, offset+len) of a fixed file the caller keeps erased (no read-modify-write,
+  // no directory record); on SPI-NAND whole pages at programUnit() alignment
+  bool programFileRange(const char* name, uint64_t offset, const uint8_t* data, uint32_t len) {
+    ensureParams();
+    int idx = findIndexByName(name);
+    if (idx < 0 || _files[idx].deleted || _files[idx].compressed || isInline(_files[idx])) return false;
+    FileInfo& fi = _files[idx];
+    if (offset + len > fi.size) return false;
+    if (_isNand && ((offset % _nandPage) || (len % _nandPage))) return false;
+    if (fi.crcValid) dropSnapshot();  // no record follows: a durable snapshot would keep the old CRC
+    fi.crcValid = false;
+    touch(fi);
+    return _dev.writeData02(fi.addr + offset, data, len);
+  }
+  uint32_t eraseUnit() const {
+    return _eraseAlign;
+  }
+  uint32_t programUnit() const {
+    return _isNand ? _nandPage : 1u;
+  }
   bool writeFileInPlace(const char* name, const uint8_t* data, uint32_t size, bool allowReallocate = false) {
     ensureParams();
     int idx = findIndexByName(name);
     if (idx < 0 || _files[idx].deleted) return false;
     FileInfo& fi = _files[idx];
-    uint32_t cap = (fi.capEnd > fi.addr) ? (fi.capEnd - fi.addr) : 0;
+    const uint32_t crc = CRC32Fast::compute(data, size);
+    if (sameContent(idx, size, crc)) return true;
+    if (isInline(fi) && fitsInline(size)) return writeInline(name, data, size, crc);
+    uint64_t cap = (fi.capEnd > fi.addr) ? (fi.capEnd - fi.addr) : 0;
     if (fi.slotSafe && cap >= size) {
+      touch(fi);
       if (size > 0) {
         if (!_dev.writeData02(fi.addr, data, size)) return false;
       }
       uint32_t seq = 0;
-      if (!appendDirEntry(0x00, name, fi.addr, size, seq)) return false;
+      if (!appendDirEntry(0x00, name, fi.addr, size, seq, &crc)) return false;
       fi.size = size;
       fi.seq = seq;
+      fi.compressed = false;
+      fi.rawSize = size;
+      noteCrc(name, crc);
       return true;
     }
     if (!allowReallocate) return false;
     return writeFile(name, data, size, WriteMode::ReplaceIfExists);
   }
+  // Patch [offset, offset+len) of an existing file. Only the touched erase units are rewritten
+  // (bit-clear or read-modify-write in the driver). Writing past the end grows the file within
+  // its capacity; a directory record is appended only when the size changes or a stored CRC
+  // goes stale. Erase units too large to buffer (SPI-NAND blocks), growth past the capacity or an
+  // empty file (its address may be shared with, or lie inside, another file) relocate instead.
+  bool writeFileRange(const char* name, uint64_t offset, const uint8_t* data, uint32_t len) {
+    ensureParams();
+    int idx = findIndexByName(name);
+    if (idx < 0 || _files[idx].deleted) return false;
+    FileInfo& fi = _files[idx];
+    if (fi.compressed) return patchCompressed(idx, offset, data, len);
+    if (offset > fi.size) return false;
+    if (len == 0) return true;
+    if (!data) return false;
+    uint64_t newSize = (offset + len > fi.size) ? (offset + len) : fi.size;
+    // Patch identical to what is stored: keep the record (and its CRC)
+    if (UNIFIED_FS_SKIP_IDENTICAL && newSize == fi.size && rangeMatches(fi.addr + offset, data, len)) {
+      _dev.noteFileUnchanged();
+      return true;
+    }
+    if (isInline(fi)) return patchInline(idx, offset, data, len, newSize);
+    uint64_t cap = (fi.capEnd > fi.addr) ? (fi.capEnd - fi.addr) : 0;
+    if (fi.addr + fi.size >= _dataHead) cap = _capacity - fi.addr;  // last file: free space follows
+    if (!_dev.canUpdateInPlace() || fi.size == 0 || newSize > cap) return relocateWithPatch(idx, offset, data, len, newSize);
+    touch(fi);  // a same-size patch of a file without a stored CRC appends no record
+    if (!_dev.updateRange(fi.addr + offset, data, len)) return false;
+    if (newSize == fi.size && !fi.crcValid) return true;
+    uint32_t seq = 0;
+    if (!appendDirEntry(0x00, name, fi.addr, newSize, seq)) return false;
+    fi.size = newSize;
+    fi.rawSize = newSize;
+    fi.seq = seq;
+    fi.crcValid = false;
+    if (fi.addr + newSize > _dataHead) _dataHead = fi.addr + newSize;
+    computeCapacities(_dataHead);
+    return true;
+  }
   uint32_t readFile(const char* name, uint8_t* buf, uint32_t bufSize) {
     int idx = findIndexByName(name);
     if (idx < 0 || _files[idx].deleted) return 0;
-    uint32_t n = _files[idx].size;
-    if (bufSize < n) n = bufSize;
+    if (_files[idx].compressed) return readCompressed(_files[idx], 0, buf, bufSize);
+    const uint32_t n = (uint32_t)min<uint64_t>(_files[idx].size, bufSize);
     if (n == 0) return 0;
     if (!_dev.readData03(_files[idx].addr, buf, n)) return 0;
     return n;
   }
-  uint32_t readFileRange(const char* name, uint32_t offset, uint8_t* buf, uint32_t len) {
+  uint32_t readFileRange(const char* name, uint64_t offset, uint8_t* buf, uint32_t len) {
     int idx = findIndexByName(name);
     if (idx < 0 || _files[idx].deleted) return 0;
+    if (_files[idx].compressed) return readCompressed(_files[idx], offset, buf, len);
     if (offset >= _files[idx].size) return 0;
-    uint32_t maxLen = _files[idx].size - offset;
-    if (len > maxLen) len = maxLen;
+    len = (uint32_t)min<uint64_t>(len, _files[idx].size - offset);
     if (len == 0) return 0;
-    if (!_dev.readData03(_files[idx].addr + offset, buf, len)) return 0;
+    // A read starting where the previous one on this file ended streams through read-ahead
+    const uint64_t fileAddr = _files[idx].addr;
+    const uint64_t addr = fileAddr + offset;
+    bool ok;
+    if (fileAddr == _seqFile && addr == _seqNext) ok = _dev.readStream(addr, buf, len, fileAddr + _files[idx].size);
+    else ok = _dev.readData03(addr, buf, len);
+    if (!ok) return 0;
+    _seqFile = fileAddr;
+    _seqNext = addr + len;
     return len;
   }
-  bool getFileSize(const char* name, uint32_t& sizeOut) {
+  bool getFileSize(const char* name, uint64_t& sizeOut) {
     int idx = findIndexByName(name);
     if (idx < 0 || _files[idx].deleted) return false;
-    sizeOut = _files[idx].size;
+    sizeOut = _files[idx].rawSize;
     return true;
   }
-  bool getFileInfo(const char* name, uint32_t& addrOut, uint32_t& sizeOut, uint32_t& capOut) {
+  // 32-bit callers: false for a file of 4 GiB or more
+  bool getFileSize(const char* name, uint32_t& sizeOut) {
+    uint64_t s = 0;
+    if (!getFileSize(name, s) || s > 0xFFFFFFFFUL) return false;
+    sizeOut = (uint32_t)s;
+    return true;
+  }
+  // sizeOut is the logical (decompressed) size; see getStoredSize() for bytes on the device
+  bool getFileInfo(const char* name, uint64_t& addrOut, uint64_t& sizeOut, uint64_t& capOut) {
     int idx = findIndexByName(name);
     if (idx < 0 || _files[idx].deleted) return false;
     addrOut = _files[idx].addr;
-    sizeOut = _files[idx].size;
+    sizeOut = _files[idx].rawSize;
     capOut = (_files[idx].capEnd > _files[idx].addr) ? (_files[idx].capEnd - _files[idx].addr) : 0;
     return true;
   }
+  // 32-bit callers: false when the extent does not fit below 4 GiB
+  bool getFileInfo(const char* name, uint32_t& addrOut, uint32_t& sizeOut, uint32_t& capOut) {
+    uint64_t a = 0, s = 0, c = 0;
+    if (!getFileInfo(name, a, s, c) || a + c > 0xFFFFFFFFUL || s > 0xFFFFFFFFUL) return false;
+    addrOut = (uint32_t)a;
+    sizeOut = (uint32_t)s;
+    capOut = (uint32_t)c;
+    return true;
+  }
   bool exists(const char* name) {
     int idx = findIndexByName(name);
     return (idx >= 0 && !_files[idx].deleted);
   }
+  // CRC-32 of the file contents as recorded at write time; false when not recorded
+  bool getFileCrc(const char* name, uint32_t& crcOut) {
+    int idx = findIndexByName(name);
+    if (idx < 0 || _files[idx].deleted || !_files[idx].crcValid) return false;
+    crcOut = _files[idx].crc;
+    return true;
+  }
+  // Changes with every write to the file, in-place ones that append no directory record
+  // included (programFileRange, eraseFileRange, same-size writeFileRange). RAM only, never
+  // reused by this instance: caches compare it to tell whether their copy is still current.
+  bool getFileGeneration(const char* name, uint32_t& genOut) {
+    int idx = findIndexByName(name);
+    if (idx < 0 || _files[idx].deleted) return false;
+    genOut = _files[idx].gen;
+    return true;
+  }
+  bool getStoredSize(const char* name, uint64_t& sizeOut, bool& compressedOut) {
+    int idx = findIndexByName(name);
+    if (idx < 0 || _files[idx].deleted) return false;
+    sizeOut = _files[idx].size;
+    compressedOut = _files[idx].compressed;
+    return true;
+  }
+  bool getStoredSize(const char* name, uint32_t& sizeOut, bool& compressedOut) {
+    uint64_t s = 0;
+    if (!getStoredSize(name, s, compressedOut) || s > 0xFFFFFFFFUL) return false;
+    sizeOut = (uint32_t)s;
+    return true;
+  }
   bool deleteFile(const char* name) {
     ensureParams();
     int idx = findIndexByName(name);
     if (idx < 0 || _files[idx].deleted) return false;
     uint32_t seq = 0;
     if (!appendDirEntry(0x01, name, 0, 0, seq)) return false;
-    _files[idx].deleted = true;
-    _files[idx].addr = 0;
-    _files[idx].size = 0;
-    _files[idx].seq = seq;
+    markDeleted(_files[idx], seq);
     computeCapacities(_dataHead);
     return true;
   }
+  // Delete every live file whose name starts with prefix (a folder marker "dir/" and its
+  // subtree). Layout v3 volumes take one prefix tombstone; older ones one tombstone per file.
+  // countOut: files deleted (also on a partial failure)
+  bool deletePrefix(const char* prefix, uint32_t* countOut = nullptr) {
+    ensureParams();
+    if (countOut) *countOut = 0;
+    if (!validName(prefix)) return false;
+    const uint32_t live = (uint32_t)visitPrefix(prefix, nullptr, nullptr);
+    if (live == 0) return false;
+    uint32_t done = 0;
+    bool ok = true;
+    if (_layoutVer >= 3) {
+      uint32_t seq = 0;
+      ok = appendDirEntry(0x01 | FLAG_PREFIX, prefix, 0, 0, seq);
+      if (ok) done = deleteIndexPrefix(prefix, seq);
+    } else {
+      const size_t lp = strlen(prefix);
+      for (size_t k = lowerBound(prefix); ok && k < _fileCount; ++k) {
+        FileInfo& fi = _files[_order[k]];
+        if (strncmp(fi.name, prefix, lp) != 0) break;
+        if (fi.deleted) continue;
+        uint32_t seq = 0;
+        ok = appendDirEntry(0x01, fi.name, 0, 0, seq);
+        if (ok) {
+          markDeleted(fi, seq);
+          done++;
+        }
+      }
+    }
+    computeCapacities(_dataHead);
+    if (countOut) *countOut = done;
+    return ok;
+  }
+  // Live files whose names start with prefix, in name order, from the in-memory index (no
+  // device reads). fn returning false stops the walk; fn may be null to just count.
+  typedef bool (*PrefixVisitor)(void* ctx, const char* name, uint64_t size);
+  size_t visitPrefix(const char* prefix, PrefixVisitor fn, void* ctx) const {
+    if (!prefix) return 0;
+    const size_t lp = strlen(prefix);
+    size_t n = 0;
+    for (size_t k = lowerBound(prefix); k < _fileCount; ++k) {
+      const FileInfo& fi = _files[_order[k]];
+      if (strncmp(fi.name, prefix, lp) != 0) break;
+      if (fi.deleted) continue;
+      ++n;
+      if (fn && !fn(ctx, fi.name, fi.rawSize)) break;
+    }
+    return n;
+  }
+  // Directory bytes taken by the log (superblock and extension records included)
+  uint32_t dirBytesUsed() const {
+    return _dirWriteOffset;
+  }
   void listFilesToSerial(Stream& out = Serial) {
     // Device info (style, CS, capacity)
     const char* style = _dev.styleName();
@@ -491,17 +1723,17 @@ public:
     const uint64_t devCap = _dev.capacityBytes();
     // FS region math (DIR + DATA)
     const uint32_t dirUsed = _dirWriteOffset;
-    const uint32_t dirFree = (DIR_SIZE > dirUsed) ? (DIR_SIZE - dirUsed) : 0;
-    const uint32_t dataCap = (_capacity > DATA_START) ? (_capacity - DATA_START) : 0;
-    uint32_t dataUsed = (_dataHead > DATA_START) ? (_dataHead - DATA_START) : 0;
+    const uint32_t dirFree = (_dirSize > dirUsed) ? (_dirSize - dirUsed) : 0;
+    const uint64_t dataCap = (_capacity > _dataStart) ? (_capacity - _dataStart) : 0;
+    uint64_t dataUsed = (_dataHead > _dataStart) ? (_dataHead - _dataStart) : 0;
     if (dataUsed > dataCap) dataUsed = dataCap;
-    const uint32_t dataFree = (dataCap > dataUsed) ? (dataCap - dataUsed) : 0;
-    auto printPct = [&](uint32_t num, uint32_t den) {
+    const uint64_t dataFree = (dataCap > dataUsed) ? (dataCap - dataUsed) : 0;
+    auto printPct = [&](uint64_t num, uint64_t den) {
       if (den == 0) {
         out.print("n/a");
         return;
       }
-      uint32_t scaled = (uint32_t)(((uint64_t)num * 10000ULL + (den / 2)) / den);  // 2 decimals, rounded
+      uint32_t scaled = (uint32_t)((num * 10000ULL + (den / 2)) / den);  // 2 decimals, rounded
       uint32_t ip = scaled / 100;
       uint32_t fp = scaled % 100;
       out.print(ip);
@@ -510,24 +1742,24 @@ public:
       out.print(fp);
       out.print('%');
     };
-    out.printf("Files (%s, CS=%u, %llu bytes total; FS data=%lu bytes)\n", style, cs, (unsigned long long)devCap, (unsigned long)dataCap);
+    out.printf("Files (%s, CS=%u, %llu bytes total; FS data=%llu bytes)\n", style, cs, (unsigned long long)devCap, (unsigned long long)dataCap);
     out.print("Usage: data used=");
-    out.print((unsigned long)dataUsed);
+    out.print((unsigned long long)dataUsed);
     out.print(" (");
     printPct(dataUsed, dataCap);
     out.print(")  data free=");
-    out.print((unsigned long)dataFree);
+    out.print((unsigned long long)dataFree);
     out.print(" (");
     printPct(dataFree, dataCap);
     out.println(")");
     out.print("       dir used=");
     out.print((unsigned long)dirUsed);
     out.print(" (");
-    printPct(dirUsed, DIR_SIZE);
+    printPct(dirUsed, _dirSize);
     out.print(")  dir free=");
     out.print((unsigned long)dirFree);
     out.print(" (");
-    printPct(dirFree, DIR_SIZE);
+    printPct(dirFree, _dirSize);
     out.println(")");
     // File list
     for (size_t i = 0; i < _fileCount; ++i) {
@@ -539,9 +1771,10 @@ public:
         out.printf("- %s\t (folder)\n", nm);
         continue;
       }
-      out.printf("- %s\t size=%u\t addr=0x%08lX", nm, (unsigned)_files[i].size, (unsigned long)_files[i].addr);
-      uint32_t cap = (_files[i].capEnd > _files[i].addr) ? (_files[i].capEnd - _files[i].addr) : 0;
-      out.printf("\t cap=%u\t slotSafe=%s\t seq=%u\n", (unsigned)cap, _files[i].slotSafe ? "Y" : "N", (unsigned)_files[i].seq);
+      out.printf("- %s\t size=%llu\t addr=0x%08llX", nm, (unsigned long long)_files[i].size, (unsigned long long)_files[i].addr);
+      uint64_t cap = (_files[i].capEnd > _files[i].addr) ? (_files[i].capEnd - _files[i].addr) : 0;
+      out.printf("\t cap=%llu\t slotSafe=%s\t seq=%u%s\n", (unsigned long long)cap, _files[i].slotSafe ? "Y" : "N", (unsigned)_files[i].seq,
+                 isInline(_files[i]) ? "\t inline" : "");
     }
   }
   size_t fileCount() const {
@@ -550,33 +1783,449 @@ public:
       if (!_files[i].deleted) ++n;
     return n;
   }
-  uint32_t nextDataAddr() const {
+  // Directory iteration: slots 0..fileSlots()-1; fileAt() is false for deleted slots.
+  // nameOut points into the index and stays valid until the next mount/format.
+  size_t fileSlots() const {
+    return _fileCount;
+  }
+  bool fileAt(size_t i, const char*& nameOut, uint64_t& sizeOut) const {
+    if (i >= _fileCount || _files[i].deleted) return false;
+    nameOut = _files[i].name;
+    sizeOut = _files[i].rawSize;
+    return true;
+  }
+  bool fileAt(size_t i, const char*& nameOut, uint32_t& sizeOut) const {
+    uint64_t s = 0;
+    if (!fileAt(i, nameOut, s) || s > 0xFFFFFFFFUL) return false;
+    sizeOut = (uint32_t)s;
+    return true;
+  }
+  // writeFileRange() patches in place (false: SPI-NAND, where it relocates the whole file)
+  bool canUpdateInPlace() const {
+    return _dev.canUpdateInPlace();
+  }
+  uint64_t nextDataAddr() const {
     return _dataHead;
   }
-  uint32_t capacity() const {
+  uint64_t capacity() const {
     return _capacity;
   }
   uint32_t dataRegionStart() const {
-    return DATA_START;
+    return _dataStart;
+  }
+  // Idle-time pre-erase of free space past the data head (NOR/NAND only).
+  // Each call does at most one 256-byte verify read or one async erase submit.
+  // Returns true while the pool is not yet fully erased.
+  bool preEraseStep() {
+    if (!_mounted || _eraseAlign <= 1 || _preEraseBytes == 0) return false;
+    UnifiedSpiMem::MemDevice* dev = _dev.device();
+    if (!dev) return false;
+    if (dev->asyncBusy()) return true;
+    uint64_t base = alignUp(_dataHead, _eraseAlign);
+    if (_preErasePos < base) {
+      _preErasePos = base;
+      _preEraseCheck = 0;
+    }
+    uint32_t pool = (_preEraseBytes > _eraseAlign) ? _preEraseBytes : _eraseAlign;
+    uint64_t limit = base + pool;
+    if (limit > _capacity) limit = _capacity;
+    if (_preErasePos + _eraseAlign > limit) return false;
+    if (_preEraseCheck == 0 && !_dev.verifyErased() && _dev.knownErased(_preErasePos, _eraseAlign)) {
+      _preErasePos += _eraseAlign;
+      return true;
+    }
+    uint8_t tmp[256];
+    uint32_t n = min<uint32_t>(sizeof(tmp), _eraseAlign - _preEraseCheck);
+    if (!_dev.readData03(_preErasePos + _preEraseCheck, tmp, n)) return false;
+    if (isAllFF(tmp, n)) {
+      _preEraseCheck += n;
+      if (_preEraseCheck >= _eraseAlign) {
+        _dev.markErased(_preErasePos, _eraseAlign);
+        _preErasePos += _eraseAlign;
+        _preEraseCheck = 0;
+      }
+      return true;
+    }
+    UnifiedSpiMem::MemDevice::AsyncRequest req;
+    req.op = UnifiedSpiMem::MemDevice::AsyncOp::Erase;
+    req.addr = _preErasePos;
+    req.len = _eraseAlign;
+    req.cb = &UnifiedSimpleFS_Generic::onPreErased;
+    req.ctx = this;
+    _preEraseUnit = _preErasePos;
+    dev->submitAsync(req);
+    return true;
+  }
+  void setPreEraseBytes(uint32_t bytes) {
+    _preEraseBytes = bytes;
+  }
+  uint32_t preEraseBytes() const {
+    return _preEraseBytes;
+  }
+  // ---- Index snapshot (warm mount) ----
+  // Carve the snapshot area(s) from the end of the FS; call before mount()
+  bool reserveIndexSnapshot() {
+    if (_snapAddr) return true;
+    ensureParams();
+    const uint64_t area = snapAreas() * snapAreaBytes();
+    if (_mounted || _capacity < _dataStart + 2 * area) return false;
+    _capacity -= area;
+    _snapAddr = _capacity;
+    return true;
+  }
+  bool hasIndexSnapshot() const {
+    return _snapAddr != 0;
+  }
+  // Saved and nothing written to the device since
+  bool indexSnapshotCurrent() const {
+    if (durableSnapshot()) return _snapSaved && _snapSeq == _nextSeq;
+    return _snapSaved && _dev.writeGuardArmed();
+  }
+  // Flash/NAND keep the snapshot across power cycles as a prefix of the directory log;
+  // PSRAM's is only valid for one boot epoch and dies with the first write after it
+  bool durableSnapshot() const {
+    return _snapAddr && _eraseAlign > 1;
+  }
+  bool saveIndexSnapshot(uint32_t epoch) {
+    if (!_snapAddr || !_mounted) return false;
+    if (_snapEpoch == epoch && indexSnapshotCurrent()) return true;
+    if (durableSnapshot()) epoch = DURABLE_EPOCH;
+    if (!_dev.sync()) return false;  // write-back lines must reach the device before the index describing them
+    uint8_t* buf = (uint8_t*)malloc(SNAP_BYTES);
+    if (!buf) return false;
+    memset(buf, 0xFF, SNAP_BYTES);
+    const uint32_t len = serializeIndex(buf + SNAP_HEADER);
+    wr32(&buf[0], SNAP_MAGIC);
+    wr32(&buf[4], epoch);
+    wr32(&buf[8], len);
+    wr32(&buf[12], CRC32Fast::compute(buf + SNAP_HEADER, len));
+    _dev.disarmWriteGuard();
+    // Fixed size: always one direct device write (never held in write-back lines).
+    // Durable copies go to the other area, so the newest one survives a reset mid-write.
+    const uint8_t area = durableSnapshot() ? _snapArea ^ 1 : 0;
+    bool ok = _dev.writeData02(snapAreaAddr(area), buf, SNAP_BYTES);
+    free(buf);
+    _snapSaved = ok;
+    if (!ok) return false;
+    _snapArea = area;
+    _snapEpoch = epoch;
+    _snapSeq = _nextSeq;
+    if (!durableSnapshot()) _dev.armWriteGuard(_snapAddr);
+    return true;
+  }
+  // Clean-sync hook (flash/NAND): refresh the durable snapshot once UNIFIED_FS_SNAPSHOT_EVERY
+  // records were appended since the last one, bounding the replay of the next mount
+  bool syncIndexSnapshot() {
+    if (!durableSnapshot() || !_mounted) return false;
+    if (_snapSaved && _nextSeq - _snapSeq < UNIFIED_FS_SNAPSHOT_EVERY) return true;
+    return saveIndexSnapshot(DURABLE_EPOCH);
+  }
+  // Directory records a mount would replay after the snapshot
+  uint32_t recordsSinceSnapshot() const {
+    return _snapSaved ? _nextSeq - _snapSeq : _nextSeq - 1;
+  }
+  // Records the last mount replayed after loading the durable snapshot
+  uint32_t snapshotReplayed() const {
+    return _snapReplayed;
+  }
+  bool mounted() const {
+    return _mounted;
+  }
+  // Warm mount: load the index from the snapshot instead of scanning the directory.
+  // False (nothing mounted) when there is none, it belongs to another epoch or the log moved on.
+  // Durable (flash/NAND) snapshots match any epoch.
+  bool mountFromSnapshot(uint32_t epoch) {
+    if (!_snapAddr) return false;
+    ensureParams();
+    if (!readLayout() || _capacity <= _dataStart) return false;
+    if (durableSnapshot()) epoch = DURABLE_EPOCH;
+    if (!loadSnapshot(epoch, true)) {
+      _fileCount = 0;
+      _dirWriteOffset = _dirFirst;
+      _nextSeq = 1;
+      _dataHead = _dataStart;
+      _mounted = false;
+      return false;
+    }
+    computeCapacities(_dataHead);
+    _mounted = true;
+    resetPreErase();
+    _snapSaved = true;
+    _snapEpoch = epoch;
+    _snapSeq = _nextSeq;
+    _snapReplayed = 0;
+    if (!durableSnapshot()) _dev.armWriteGuard(_snapAddr);
+    return true;
   }
 private:
   Driver& _dev;
-  uint32_t _capacity;
+  uint64_t _capacity;
   static const size_t MAX_FILES = 64;
   FileInfo _files[MAX_FILES];
+  uint8_t _order[MAX_FILES];  // _files slots sorted by name (addSlot keeps it in step)
   size_t _fileCount;
+  uint32_t _gen = 0;  // last FileInfo::gen handed out (kept across remounts)
   uint32_t _dirWriteOffset;
-  uint32_t _dataHead;
+  uint64_t _dataHead;
   uint32_t _nextSeq;
 
   // Runtime parameters
   bool _paramsInit;
   bool _isNand;
   uint32_t _eraseAlign;  // erase unit (1 for PSRAM)
+  uint32_t _blockAlign;  // preferred placement for large slots (64K on NOR)
   uint32_t _nandPage;    // NAND page size
   uint32_t _dirStride;   // logical stride between entries (32 or NAND page)
+  static const uint8_t LAYOUT_VERSION = 3;
+  uint32_t _dirSize = LEGACY_DIR_SIZE;  // directory bytes (from the superblock)
+  uint32_t _dataStart = DIR_START + LEGACY_DIR_SIZE;
+  uint32_t _dirFirst = 0;       // offset of the first record: 0 (legacy) or one stride past the superblock
+  uint32_t _formatDirSize = 0;  // setFormatDirSize()
+  uint8_t _layoutVer = 0;       // superblock version (0: legacy, none)
   uint8_t* _dirScratch;  // scratch for writing a full NAND page
   uint32_t _lastSeqWritten;
+  bool _mounted;
+
+  // Background pre-erase cursor: [alignUp(_dataHead), _preErasePos) is known erased
+  uint32_t _preEraseBytes;
+  uint64_t _preErasePos;
+  uint32_t _preEraseCheck;  // verified bytes of the unit at _preErasePos
+  uint64_t _preEraseUnit;   // unit handed to submitAsync()
+  // Sequential read detection (readFileRange): file start address and next expected address
+  uint64_t _seqFile;
+  uint64_t _seqNext;
+  static constexpr uint8_t FLAG_COMPRESSED = 0x02;
+  static constexpr uint8_t FLAG_INLINE = 0x04;       // data follows the extension record in the directory
+  static constexpr uint8_t FLAG_PREFIX = 0x08;       // with 0x01: tombstone for every name the record's name prefixes
+  static constexpr uint8_t EXT_CRC = 0x01;           // extension flags: CRC-32 at +8
+  static constexpr uint8_t EXT_HIGH = 0x02;          // high words of the address (+12) and size (+16)
+  static const uint32_t NOR_INLINE_ROOM = 192;       // inline data cap on NOR (directory space)
+  uint32_t _lastRecOff = 0;                          // directory offset of the newest record
+  // Index snapshot: header magic, epoch, payload length, payload CRC-32; payload holds the log
+  // cursors (dir offset, next seq, data head (64-bit), file count, newest record) and one entry
+  // per file
+  static const uint32_t SNAP_MAGIC = 0x57534E32UL;  // "WSN2" (64-bit extents; "WSN1" copies are ignored)
+  static const uint32_t SNAP_HEADER = 16;
+  static const uint32_t SNAP_CURSORS = 24;
+  static const uint32_t SNAP_ENTRY = MAX_NAME + 1 + 1 + 2 * 8 + 3 * 4;  // name, flags, addr/size, seq/rawSize/crc
+  static const uint32_t SNAP_BYTES = SNAP_HEADER + SNAP_CURSORS + MAX_FILES * SNAP_ENTRY;
+  static_assert(SNAP_BYTES <= UNIFIED_FS_SNAPSHOT_BYTES, "UNIFIED_FS_SNAPSHOT_BYTES too small for the index");
+  static const uint32_t DURABLE_EPOCH = 0x44555241UL;  // "DURA": flash/NAND snapshots outlive boots
+  uint64_t _snapAddr = 0;  // 0: no snapshot area
+  uint32_t _snapEpoch = 0;
+  uint32_t _snapSeq = 0;       // _nextSeq when the snapshot was written
+  uint32_t _snapReplayed = 0;  // records replayed after the snapshot by the last mount
+  uint8_t _snapArea = 0;       // area holding the newest durable copy
+  bool _snapSaved = false;
+  uint32_t serializeIndex(uint8_t* p) const {
+    wr32(&p[0], _dirWriteOffset);
+    wr32(&p[4], _nextSeq);
+    wr64(&p[8], _dataHead);
+    wr32(&p[16], (uint32_t)_fileCount);
+    wr32(&p[20], _lastRecOff);
+    uint8_t* e = p + SNAP_CURSORS;
+    for (size_t i = 0; i < _fileCount; ++i, e += SNAP_ENTRY) {
+      const FileInfo& fi = _files[i];
+      memset(e, 0, MAX_NAME + 1);
+      memcpy(e, fi.name, strlen(fi.name));
+      e[MAX_NAME + 1] = (uint8_t)((fi.deleted ? 0x01 : 0) | (fi.compressed ? 0x02 : 0) | (fi.crcValid ? 0x04 : 0));
+      uint8_t* v = e + MAX_NAME + 2;
+      wr64(&v[0], fi.addr);
+      wr64(&v[8], fi.size);
+      wr32(&v[16], fi.seq);
+      wr32(&v[20], (uint32_t)fi.rawSize);  // read back for compressed files only
+      wr32(&v[24], fi.crc);
+    }
+    return SNAP_CURSORS + (uint32_t)_fileCount * SNAP_ENTRY;
+  }
+  bool loadIndex(const uint8_t* p, uint32_t len) {
+    if (len < SNAP_CURSORS) return false;
+    const uint32_t count = rd32(&p[16]);
+    if (count > MAX_FILES || len != SNAP_CURSORS + count * SNAP_ENTRY) return false;
+    _dirWriteOffset = rd32(&p[0]);
+    _nextSeq = rd32(&p[4]);
+    _dataHead = rd64(&p[8]);
+    _lastRecOff = rd32(&p[20]);
+    if (_dataHead < _dataStart || _dataHead > _capacity || _nextSeq == 0) return false;
+    _fileCount = 0;
+    const uint8_t* e = p + SNAP_CURSORS;
+    for (uint32_t i = 0; i < count; ++i, e += SNAP_ENTRY) {
+      FileInfo& fi = _files[i];
+      if (e[MAX_NAME] != 0 || !validName((const char*)e)) return false;
+      addSlot((const char*)e);
+      const uint8_t f = e[MAX_NAME + 1];
+      const uint8_t* v = e + MAX_NAME + 2;
+      fi.deleted = (f & 0x01) != 0;
+      fi.compressed = (f & 0x02) != 0;
+      fi.crcValid = (f & 0x04) != 0;
+      fi.addr = rd64(&v[0]);
+      fi.size = rd64(&v[8]);
+      fi.seq = rd32(&v[16]);
+      touch(fi);
+      fi.rawSize = fi.compressed ? rd32(&v[20]) : fi.size;
+      fi.crc = rd32(&v[24]);
+      const uint64_t end = isInline(fi) ? _dataStart : _dataHead;  // inline data lives in the directory
+      if (!fi.deleted && (fi.addr > end || fi.size > end - fi.addr)) return false;
+    }
+    _fileCount = count;
+    _lastSeqWritten = _nextSeq - 1;
+    return true;
+  }
+  // O(1) check that the directory log ends at off: the slot there is erased and the newest
+  // record still carries seq
+  bool logEndsAt(uint32_t off, uint32_t seq) {
+    const uint32_t stride = _isNand ? _dirStride : ENTRY_SIZE;
+    if (off > _dirSize || off % stride) return false;
+    uint8_t b[ENTRY_SIZE];
+    if (off < _dirSize && (!_dev.readData03(DIR_START + off, b, ENTRY_SIZE) || !isAllFF(b, ENTRY_SIZE))) return false;
+    if (off == _dirFirst) return _fileCount == 0;
+    if (_lastRecOff >= off || !_dev.readData03(DIR_START + _lastRecOff, b, ENTRY_SIZE)) return false;
+    return b[0] == 0x57 && b[1] == 0x46 && rd32(&b[28]) == seq;
+  }
+  // Superblock (directory slot 0): "WS", version, dir size, stride, erase unit, data start, CRC-32
+  // of bytes 0..27 at 28. Without one the legacy layout applies: 64 KiB, records from offset 0.
+  // Version 1 volumes mount as before; records are only widened past 4 GiB on version 2.
+  // False when a superblock describes another geometry (other device or stride).
+  bool readLayout() {
+    uint8_t b[ENTRY_SIZE];
+    setLayout(LEGACY_DIR_SIZE, 0, 0);
+    if (!_dev.readData03(DIR_START, b, ENTRY_SIZE)) return false;
+    if (b[0] != 0x57 || b[1] != 0x53 || CRC32Fast::compute(b, 28) != rd32(&b[28])) return true;
+    const uint32_t dirSize = rd32(&b[4]);
+    if (b[2] < 1 || b[2] > LAYOUT_VERSION || rd32(&b[8]) != _dirStride || rd32(&b[12]) != _eraseAlign || rd32(&b[16]) != DIR_START + dirSize) return false;
+    if (dirSize < 2 * _dirStride || dirSize % _dirStride || dirSize % _eraseAlign || DIR_START + dirSize >= _capacity) return false;
+    setLayout(dirSize, _dirStride, b[2]);
+    return true;
+  }
+  void setLayout(uint32_t dirSize, uint32_t first, uint8_t ver) {
+    _dirSize = dirSize;
+    _dataStart = DIR_START + dirSize;
+    _dirFirst = first;
+    _layoutVer = ver;
+    _dev.setDirEnd(_dataStart);
+  }
+  // Stamp the superblock into the erased directory and start an empty log after it
+  bool startLog(uint32_t dirSize) {
+    if (!dirSize) return false;
+    uint8_t b[ENTRY_SIZE];
+    memset(b, 0xFF, sizeof(b));
+    b[0] = 0x57;
+    b[1] = 0x53;
+    b[2] = LAYOUT_VERSION;
+    wr32(&b[4], dirSize);
+    wr32(&b[8], _dirStride);
+    wr32(&b[12], _eraseAlign);
+    wr32(&b[16], DIR_START + dirSize);
+    wr32(&b[28], CRC32Fast::compute(b, 28));
+    bool ok;
+    if (_isNand) {
+      // NAND: one whole page, like a directory record
+      memset(_dirScratch, 0xFF, _dirStride);
+      memcpy(_dirScratch, b, sizeof(b));
+      ok = _dev.writeData02(DIR_START, _dirScratch, _dirStride);
+    } else {
+      ok = _dev.writeData02(DIR_START, b, sizeof(b));
+    }
+    if (!ok) return false;
+    setLayout(dirSize, _dirStride, LAYOUT_VERSION);
+    _fileCount = 0;
+    _dirWriteOffset = _dirFirst;
+    _nextSeq = 1;
+    _lastRecOff = 0;
+    _dataHead = _dataStart;
+    computeCapacities(_dataHead);
+    _mounted = true;
+    resetPreErase();
+    return true;
+  }
+  // Durable mount: snapshot index, then the records appended after it. False (index cleared)
+  // when the copy is missing, fails its CRC or the log no longer holds its newest record.
+  bool resumeFromSnapshot() {
+    if (!loadSnapshot(DURABLE_EPOCH, false)) {
+      _fileCount = 0;
+      _snapSaved = false;
+      return false;
+    }
+    _snapSeq = _nextSeq;
+    uint64_t maxEnd = _dataHead;
+    uint32_t maxSeq = _nextSeq - 1;
+    replayLog(_dirWriteOffset, maxEnd, maxSeq);
+    finishMount(maxEnd, maxSeq);
+    _snapSaved = true;
+    _snapEpoch = DURABLE_EPOCH;
+    _snapReplayed = _nextSeq - _snapSeq;
+    return true;
+  }
+  // The record at off is still the one with seq (the log was not formatted since)
+  bool logHolds(uint32_t off, uint32_t seq) {
+    if (_fileCount == 0 && seq == 0) return true;  // empty index: the replay covers the whole log
+    uint8_t b[ENTRY_SIZE];
+    if (off >= _dirWriteOffset || !_dev.readData03(DIR_START + off, b, ENTRY_SIZE)) return false;
+    return b[0] == 0x57 && b[1] == 0x46 && rd32(&b[28]) == seq;
+  }
+  // Load the newest copy for epoch whose CRC matches and whose records the log still holds
+  // (atEnd: nothing was appended after it); the other durable area is the fallback.
+  // The headers pick the order, so a clean mount reads one full copy.
+  bool loadSnapshot(uint32_t epoch, bool atEnd) {
+    uint32_t seq[2] = { 0, 0 };
+    for (uint8_t a = 0; a < snapAreas(); ++a) seq[a] = snapshotSeq(a, epoch);
+    if (!seq[0] && !seq[1]) return false;
+    uint8_t* buf = (uint8_t*)malloc(SNAP_BYTES);
+    if (!buf) return false;
+    const uint8_t newest = (seq[1] && (!seq[0] || (int32_t)(seq[1] - seq[0]) > 0)) ? 1 : 0;
+    bool ok = false;
+    for (uint8_t i = 0; i < 2 && !ok; ++i) {
+      const uint8_t a = newest ^ i;
+      if (!seq[a] || !_dev.readData03(snapAreaAddr(a), buf, SNAP_BYTES)) continue;
+      const uint32_t len = rd32(&buf[8]);
+      ok = rd32(&buf[0]) == SNAP_MAGIC && rd32(&buf[4]) == epoch && len <= SNAP_BYTES - SNAP_HEADER;
+      ok = ok && CRC32Fast::compute(buf + SNAP_HEADER, len) == rd32(&buf[12]) && loadIndex(buf + SNAP_HEADER, len);
+      ok = ok && (atEnd ? logEndsAt(_dirWriteOffset, _nextSeq - 1) : logHolds(_lastRecOff, _nextSeq - 1));
+      if (ok) _snapArea = a;
+    }
+    free(buf);
+    return ok;
+  }
+  // _nextSeq recorded in the header of area a's copy (0: none for this epoch)
+  uint32_t snapshotSeq(uint8_t a, uint32_t epoch) {
+    uint8_t h[SNAP_HEADER + 8];
+    if (!_dev.readData03(snapAreaAddr(a), h, sizeof(h)) || rd32(&h[0]) != SNAP_MAGIC || rd32(&h[4]) != epoch) return 0;
+    return rd32(&h[SNAP_HEADER + 4]);
+  }
+  // Flash/NAND alternate between two areas; PSRAM's per-boot copy needs one
+  uint8_t snapAreas() const {
+    return _eraseAlign > 1 ? 2 : 1;
+  }
+  uint64_t snapAreaBytes() const {
+    return alignUp(UNIFIED_FS_SNAPSHOT_BYTES, _eraseAlign);
+  }
+  uint64_t snapAreaAddr(uint8_t a) const {
+    return _snapAddr + a * snapAreaBytes();
+  }
+  // format()/wipeChip(): the snapshot must not describe the old log
+  void dropSnapshot() {
+    _snapSaved = false;
+    if (!durableSnapshot()) return;
+    for (uint8_t a = 0; a < snapAreas(); ++a) {
+      uint8_t m[4];
+      if (_dev.readData03(snapAreaAddr(a), m, sizeof(m)) && rd32(m) == SNAP_MAGIC) _dev.eraseRange(snapAreaAddr(a), snapAreaBytes());
+    }
+  }
+  struct ZStream;
+  ZStream* _z = nullptr;
+  void resetPreErase() {
+    _preErasePos = 0;
+    _preEraseCheck = 0;
+  }
+  static void onPreErased(void* ctx, bool ok) {
+    // Failed units are skipped; a foreground write retries the erase synchronously
+    auto* self = static_cast<UnifiedSimpleFS_Generic*>(ctx);
+    self->_dev.cacheInvalidate(self->_preEraseUnit, self->_eraseAlign);
+    if (ok) self->_dev.markErased(self->_preEraseUnit, self->_eraseAlign);
+    if (self->_preErasePos != self->_preEraseUnit) return;  // cursor moved meanwhile
+    self->_preErasePos += self->_eraseAlign;
+    self->_preEraseCheck = 0;
+  }
 
   // Utilities
   static inline uint32_t rd32(const uint8_t* p) {
@@ -588,7 +2237,14 @@ private:
     p[2] = (uint8_t)(v >> 8);
     p[3] = (uint8_t)(v >> 0);
   }
-  static inline uint32_t alignUp(uint32_t v, uint32_t a) {
+  static inline uint64_t rd64(const uint8_t* p) {
+    return (uint64_t)rd32(p) << 32 | rd32(p + 4);
+  }
+  static inline void wr64(uint8_t* p, uint64_t v) {
+    wr32(p, (uint32_t)(v >> 32));
+    wr32(p + 4, (uint32_t)v);
+  }
+  static inline uint64_t alignUp(uint64_t v, uint64_t a) {
     return (a > 1) ? ((v + (a - 1)) & ~(a - 1)) : v;
   }
   static bool isAllFF(const uint8_t* p, size_t n) {
@@ -613,6 +2269,8 @@ private:
     _isNand = (t == UnifiedSpiMem::DeviceType::SpiNandMX35);
     uint32_t e = _dev.eraseSize();
     _eraseAlign = (e > 0) ? e : 1u;
+    uint32_t b = _dev.blockEraseSize();
+    _blockAlign = (e > 0 && b > e) ? b : _eraseAlign;
     _nandPage = _dev.pageSize();
     if (_isNand) {
       if (_nandPage < 512u || _nandPage > 8192u) _nandPage = 4096u;  // sane default
@@ -626,32 +2284,216 @@ private:
     if (_dirScratch) memset(_dirScratch, 0xFF, _dirStride);
     _paramsInit = true;
   }
+  // First position in _order whose name is not below name
+  size_t lowerBound(const char* name) const {
+    size_t lo = 0, hi = __atomic_load_n(&_fileCount, __ATOMIC_ACQUIRE);  // pairs with addSlot()
+    while (lo < hi) {
+      const size_t mid = (lo + hi) / 2;
+      if (strncmp(_files[_order[mid]].name, name, MAX_NAME) < 0) lo = mid + 1;
+      else hi = mid;
+    }
+    return lo;
+  }
   int findIndexByName(const char* name) const {
-    for (size_t i = 0; i < _fileCount; ++i)
-      if (strncmp(_files[i].name, name, MAX_NAME) == 0) return (int)i;
+    const size_t k = lowerBound(name);
+    if (k < _fileCount && strncmp(_files[_order[k]].name, name, MAX_NAME) == 0) return _order[k];
     return -1;
   }
-  void upsertFileIndex(const char* name, uint32_t addr, uint32_t size, bool deleted, uint32_t seq) {
-    int idx = findIndexByName(name);
-    if (idx < 0) {
-      if (_fileCount >= MAX_FILES) return;
-      idx = _fileCount++;
-      copyName(_files[idx].name, name);
+  // Next free slot, named name and linked into _order; -1 when the index is full
+  int addSlot(const char* name) {
+    if (_fileCount >= MAX_FILES) return -1;
+    const size_t k = lowerBound(name);
+    const int idx = (int)_fileCount;
+    memmove(&_order[k + 1], &_order[k], _fileCount - k);
+    _order[k] = (uint8_t)idx;
+    copyName(_files[idx].name, name);
+    // Publish the count after the _order entry it covers (an unlocked reader on the other core)
+    __atomic_store_n(&_fileCount, _fileCount + 1, __ATOMIC_RELEASE);
+    return idx;
+  }
+  void touch(FileInfo& fi) {
+    fi.gen = ++_gen;
+  }
+  void markDeleted(FileInfo& fi, uint32_t seq) {
+    touch(fi);
+    fi.deleted = true;
+    fi.addr = 0;
+    fi.size = 0;
+    fi.compressed = false;
+    fi.rawSize = 0;
+    fi.crcValid = false;
+    fi.seq = seq;
+  }
+  // Apply a prefix tombstone to the index; returns the live files it removed
+  uint32_t deleteIndexPrefix(const char* prefix, uint32_t seq) {
+    const size_t lp = strlen(prefix);
+    uint32_t n = 0;
+    for (size_t k = lowerBound(prefix); k < _fileCount; ++k) {
+      FileInfo& fi = _files[_order[k]];
+      if (strncmp(fi.name, prefix, lp) != 0) break;
+      if (!fi.deleted) n++;
+      markDeleted(fi, seq);
     }
+    return n;
+  }
+  void upsertFileIndex(const char* name, uint64_t addr, uint64_t size, bool deleted, uint32_t seq) {
+    int idx = findIndexByName(name);
+    if (idx < 0) idx = addSlot(name);
+    if (idx < 0) return;
+    touch(_files[idx]);
     _files[idx].addr = addr;
     _files[idx].size = size;
     _files[idx].deleted = deleted;
     _files[idx].seq = seq;
+    _files[idx].compressed = false;
+    _files[idx].rawSize = size;
+    _files[idx].crcValid = false;
+  }
+  // Live file idx already holds size bytes with CRC-32 crc. Without a stored CRC the file is read
+  // back once (a read is far cheaper than erase + program) and the result is remembered.
+  bool sameContent(int idx, uint32_t size, uint32_t crc) {
+    if (!UNIFIED_FS_SKIP_IDENTICAL) return false;
+    if (idx < 0 || _files[idx].deleted || _files[idx].rawSize != size) return false;
+    FileInfo& fi = _files[idx];
+    if (!fi.crcValid) {
+      uint8_t buf[128];
+      CRC32Fast::Crc32 c;
+      for (uint32_t off = 0; off < size;) {
+        uint32_t n = min<uint32_t>(sizeof(buf), size - off);
+        if (readFileRange(fi.name, off, buf, n) != n) return false;
+        c.update(buf, n);
+        off += n;
+      }
+      fi.crc = c.value();
+      fi.crcValid = true;
+    }
+    if (fi.crc != crc) return false;
+    _dev.noteFileUnchanged();
+    return true;
+  }
+  bool rangeMatches(uint64_t addr, const uint8_t* data, uint32_t len) {
+    uint8_t buf[128];
+    for (uint32_t off = 0; off < len;) {
+      uint32_t n = min<uint32_t>(sizeof(buf), len - off);
+      if (!_dev.readData03(addr + off, buf, n) || memcmp(buf, data + off, n) != 0) return false;
+      off += n;
+    }
+    return true;
+  }
+  void noteCrc(const char* name, uint32_t crc) {
+    int idx = findIndexByName(name);
+    if (idx < 0) return;
+    _files[idx].crc = crc;
+    _files[idx].crcValid = true;
+  }
+  // Pick an erased slot for reserveBytes at the data head: start/cap aligned to the erase unit
+  bool reserveSlot(uint64_t reserveBytes, uint64_t& start, uint64_t& cap) {
+    // Align capacity and start to erase alignment if erase is needed
+    uint32_t align = (_eraseAlign > 1) ? _eraseAlign : 1u;
+    cap = alignUp((reserveBytes < 1u ? 1u : reserveBytes), align);
+    // Large slots start on a block boundary so eraseRange() can use block erases;
+    // the skipped gap extends the previous slot's capacity.
+    if (_blockAlign > align && cap >= _blockAlign) align = _blockAlign;
+    start = alignUp(_dataHead, align);
+    if (start < _dataStart) start = _dataStart;
+    if (start + cap > _capacity) return false;
+    // Pre-erase/fill with 0xFF
+    if (_eraseAlign > 1) return _dev.eraseRange(start, cap);
+    return fillErased(start, cap);
+  }
+  // PSRAM fallback for erase
+  bool fillErased(uint64_t start, uint64_t len) {
+    const uint32_t PAGE_CHUNK = 256;
+    uint8_t tmp[PAGE_CHUNK];
+    memset(tmp, 0xFF, PAGE_CHUNK);
+    uint64_t p = start;
+    while (p < start + len) {
+      uint32_t n = (uint32_t)min<uint64_t>(PAGE_CHUNK, start + len - p);
+      if (!_dev.writeData02(p, tmp, n)) return false;
+      p += n;
+    }
+    return true;
+  }
+  bool isInline(const FileInfo& fi) const {
+    return !fi.deleted && fi.addr < _dataStart;
+  }
+  // Largest inline file: NAND records own a whole page anyway; NOR spends directory slots,
+  // so it is capped at 192 bytes (record + extension + data are written as one run and
+  // may cross a program page; the device write splits it); PSRAM slots are byte-granular
+  uint32_t inlineMax() {
+    ensureParams();
+    if (_eraseAlign <= 1) return 0;
+    const uint32_t room = _isNand ? _nandPage - 2 * ENTRY_SIZE : NOR_INLINE_ROOM;
+    return min<uint32_t>(room, UNIFIED_FS_INLINE_MAX);
+  }
+  bool fitsInline(uint64_t size) {
+    const uint32_t m = inlineMax();
+    if (!m || size > m) return false;
+    const uint32_t recLen = _isNand ? _dirStride : 2 * ENTRY_SIZE + (uint32_t)alignUp(size, ENTRY_SIZE);
+    return _dirWriteOffset + recLen <= _dirSize;
+  }
+  bool writeInline(const char* name, const uint8_t* data, uint32_t size, uint32_t crc) {
+    const uint32_t addr = DIR_START + _dirWriteOffset + 2 * ENTRY_SIZE;
+    uint32_t seq = 0;
+    if (!appendDirEntry(FLAG_INLINE, name, addr, size, seq, &crc, data)) return false;
+    upsertFileIndex(name, addr, size, false, seq);
+    noteCrc(name, crc);
+    computeCapacities(_dataHead);
+    return true;
   }
-  bool appendDirEntry(uint8_t flags, const char* name, uint32_t addr, uint32_t size, uint32_t& outSeq) {
+  // writeFileRange() on an inline file: patch a RAM copy and append it again (or relocate)
+  bool patchInline(int idx, uint64_t offset, const uint8_t* data, uint32_t len, uint64_t newSize) {
+    if (!fitsInline(newSize)) return relocateWithPatch(idx, offset, data, len, newSize);
+    uint8_t buf[NOR_INLINE_ROOM];
+    uint8_t* p = (newSize <= sizeof(buf)) ? buf : (uint8_t*)malloc((size_t)newSize);
+    if (!p) return false;
+    FileInfo& fi = _files[idx];
+    bool ok = !fi.size || _dev.readData03(fi.addr, p, (size_t)fi.size);
+    if (ok) {
+      memcpy(p + offset, data, len);
+      char name[MAX_NAME + 1];
+      copyName(name, fi.name);
+      ok = writeInline(name, p, (uint32_t)newSize, CRC32Fast::compute(p, (uint32_t)newSize));
+    }
+    if (p != buf) free(p);
+    return ok;
+  }
+  // Extension record: 'W' 'X' flags 0xFF seq(BE32) crc32(BE32) addrHi(BE32) sizeHi(BE32), rest 0xFF.
+  // flags bit0 (EXT_CRC): crc valid; bit1 (EXT_HIGH): the record's address/size continue past
+  // 32 bits (layout version 2; v1 extensions never set it). Only applied when its seq matches
+  // the record it follows.
+  void applyExtRecord(int idx, const uint8_t* ext, uint64_t& maxEnd) {
+    if (idx < 0 || ext[0] != 0x57 || ext[1] != 0x58) return;
+    FileInfo& fi = _files[idx];
+    if (rd32(&ext[4]) != fi.seq) return;
+    if (ext[2] & EXT_CRC) {
+      fi.crc = rd32(&ext[8]);
+      fi.crcValid = true;
+    }
+    if ((ext[2] & EXT_HIGH) && !fi.deleted) {
+      fi.addr |= (uint64_t)rd32(&ext[12]) << 32;
+      fi.size |= (uint64_t)rd32(&ext[16]) << 32;
+      if (!fi.compressed) fi.rawSize = fi.size;
+      if (fi.addr + fi.size > maxEnd) maxEnd = fi.addr + fi.size;
+    }
+  }
+  // FLAG_INLINE: inl holds size bytes stored right after the extension (crc required)
+  bool appendDirEntry(uint8_t flags, const char* name, uint64_t addr, uint64_t size, uint32_t& outSeq, const uint32_t* crc = nullptr,
+                      const uint8_t* inl = nullptr) {
     ensureParams();
     outSeq = 0;
     if (!validName(name)) return false;
-    if (_dirWriteOffset + _dirStride > DIR_SIZE) return false;
+    if (_dirWriteOffset + _dirStride > _dirSize) return false;
+    const bool isInl = (flags & FLAG_INLINE) != 0;
+    if (isInl && (!crc || !fitsInline(size))) return false;
+    // Extents past 4 GiB need the high words in the extension (and a v2 volume to hold them)
+    const bool wide = ((addr | size) >> 32) != 0;
+    const bool extRoom = _isNand || _dirWriteOffset + 2 * ENTRY_SIZE <= _dirSize;
+    if (wide && (_layoutVer < 2 || !extRoom)) return false;
 
-    // Prepare logical record (32 bytes)
-    uint8_t rec[ENTRY_SIZE];
-    memset(rec, 0xFF, ENTRY_SIZE);
+    // Prepare logical record (32 bytes) plus the optional extension record right after it
+    uint8_t rec[ENTRY_SIZE * 2 + NOR_INLINE_ROOM];
+    memset(rec, 0xFF, sizeof(rec));
     rec[0] = 0x57;
     rec[1] = 0x46;
     rec[2] = flags;
@@ -661,40 +2503,318 @@ private:
 
     // Assign sequence and stamp it (increment once on success)
     uint32_t seq = _nextSeq;
-    wr32(&rec[20], addr);
-    wr32(&rec[24], size);
+    wr32(&rec[20], (uint32_t)addr);
+    wr32(&rec[24], (uint32_t)size);
     wr32(&rec[28], seq);
+    size_t recLen = ENTRY_SIZE;
+    if ((crc || wide) && extRoom) {
+      uint8_t* ext = rec + ENTRY_SIZE;
+      ext[0] = 0x57;
+      ext[1] = 0x58;
+      ext[2] = (crc ? EXT_CRC : 0) | (wide ? EXT_HIGH : 0);
+      wr32(&ext[4], seq);
+      if (crc) wr32(&ext[8], *crc);
+      if (wide) {
+        wr32(&ext[12], (uint32_t)(addr >> 32));
+        wr32(&ext[16], (uint32_t)(size >> 32));
+      }
+      recLen = 2 * ENTRY_SIZE;
+    }
+    if (isInl && !_isNand && size) {
+      memcpy(rec + recLen, inl, size);
+      recLen += alignUp(size, ENTRY_SIZE);  // padding stays 0xFF
+    }
 
     bool ok = false;
     const uint32_t dest = DIR_START + _dirWriteOffset;
     if (_isNand) {
       // NAND: write one full page with rec at start, rest 0xFF
       memset(_dirScratch, 0xFF, _dirStride);
-      memcpy(_dirScratch, rec, ENTRY_SIZE);
+      memcpy(_dirScratch, rec, recLen);
+      if (isInl && size) memcpy(_dirScratch + recLen, inl, size);
       ok = _dev.writeData02(dest, _dirScratch, _dirStride);
       if (ok) _dirWriteOffset += _dirStride;
     } else {
-      // NOR/PSRAM: write just the record (32 bytes)
-      ok = _dev.writeData02(dest, rec, ENTRY_SIZE);
-      if (ok) _dirWriteOffset += ENTRY_SIZE;
+      // NOR/PSRAM: write just the record (32 bytes, 64 with the extension)
+      ok = _dev.writeData02(dest, rec, recLen);
+      if (ok) _dirWriteOffset += recLen;
     }
     if (!ok) return false;
+    _lastRecOff = dest - DIR_START;
     _lastSeqWritten = seq;
     _nextSeq = (_nextSeq == 0xFFFFFFFFu) ? 1u : (_nextSeq + 1u);
     outSeq = _lastSeqWritten;
     return true;
   }
-  void computeCapacities(uint32_t maxEnd) {
+  // writeFileRange() fallback: stream old contents + patch to a new copy at the data head
+  bool relocateWithPatch(int idx, uint64_t offset, const uint8_t* data, uint32_t len, uint64_t newSize) {
+    if (_dirWriteOffset + _dirStride > _dirSize) return false;
+    uint64_t start = (_dataHead < _dataStart) ? _dataStart : _dataHead;
+    if (_isNand) start = alignUp(start, _nandPage);  // whole-page programs
+    if (start + newSize > _capacity) return false;
+    const uint32_t chunk = _isNand ? _nandPage : 512u;
+    uint8_t* buf = (uint8_t*)malloc(chunk);
+    if (!buf) return false;
+    const uint64_t oldAddr = _files[idx].addr;
+    const uint64_t oldSize = _files[idx].size;
+    bool ok = true;
+    CRC32Fast::Crc32 crc;  // the new contents pass through buf anyway
+    for (uint64_t pos = 0; ok && pos < newSize; pos += chunk) {
+      uint32_t n = (uint32_t)min<uint64_t>(chunk, newSize - pos);
+      if (pos < oldSize) ok = _dev.readData03(oldAddr + pos, buf, (size_t)min<uint64_t>(n, oldSize - pos));
+      // Overlay the patch ([oldSize, newSize) is always covered by it)
+      uint64_t a = (offset > pos) ? offset : pos;
+      uint64_t b = (offset + len < pos + n) ? (offset + len) : (pos + n);
+      if (a < b) memcpy(buf + (a - pos), data + (a - offset), (size_t)(b - a));
+      crc.update(buf, n);
+      if (ok) ok = _dev.writeData02(start + pos, buf, n);
+    }
+    free(buf);
+    if (!ok) return false;
+    char name[MAX_NAME + 1];
+    copyName(name, _files[idx].name);
+    uint32_t seq = 0;
+    const uint32_t sum = crc.value();
+    if (!appendDirEntry(0x00, name, start, newSize, seq, &sum)) return false;
+    upsertFileIndex(name, start, newSize, false, seq);
+    noteCrc(name, sum);
+    _dataHead = start + newSize;
+    computeCapacities(_dataHead);
+    return true;
+  }
+  // Sizing pass, then header, restart table and blocks. False with plain set: the data does
+  // not shrink (or is too small or too large for the header), store it uncompressed.
+  bool writeCompressed(const char* name, uint64_t size, ChunkSource src, void* ctx, WriteMode mode, bool& plain) {
+    ensureParams();
+    if (!validName(name) || !src) return false;
+    if (_dirWriteOffset + _dirStride > _dirSize) return false;
+    int idxExisting = findIndexByName(name);
+    if (idxExisting >= 0 && !_files[idxExisting].deleted && mode == WriteMode::FailIfExists) return false;
+    plain = size <= UnifiedFSLz::HEADER_SIZE || size > 0xFFFFFFFFUL;  // 32-bit raw size in the header
+    if (plain) return false;
+    const uint32_t raw32 = (uint32_t)size, blocks = UnifiedFSLz::blockCount(raw32);
+    UnifiedFSLz::Tables t;
+    uint8_t* in = (uint8_t*)malloc(UnifiedFSLz::BLOCK);
+    uint8_t* table = (uint8_t*)malloc(4 * blocks);
+    bool ok = in && table && t.alloc();
+    // Sizing pass: restart table, stored length and CRC-32
+    CRC32Fast::Crc32 crc;
+    uint32_t zlen = 0;
+    for (uint32_t b = 0; ok && b < blocks; ++b) {
+      const uint32_t off = b * UnifiedFSLz::BLOCK, n = min<uint32_t>(UnifiedFSLz::BLOCK, raw32 - off);
+      uint32_t bl = 0;
+      ok = src(ctx, off, in, n) && UnifiedFSLz::compress(t, in, n, &countSink, nullptr, &bl);
+      crc.update(in, n);
+      wr32(&table[4 * b], zlen);
+      zlen += bl;
+    }
+    const uint32_t sum = crc.value();
+    const uint64_t stored = UnifiedFSLz::HEADER_SIZE + 4ULL * blocks + zlen;
+    if (ok && idxExisting >= 0 && _files[idxExisting].compressed && sameContent(idxExisting, raw32, sum)) {
+      free(in);
+      free(table);
+      return true;
+    }
+    if (!ok || stored >= size) {
+      free(in);
+      free(table);
+      plain = ok;
+      return false;
+    }
+    ZWriter w;
+    w.fs = this;
+    w.start = (_dataHead < _dataStart) ? _dataStart : _dataHead;
+    if (_isNand) w.start = alignUp(w.start, _nandPage);  // whole-page programs
+    w.prepared = alignUp(w.start, _eraseAlign);
+    w.chunk = _isNand ? _nandPage : 256u;
+    w.buf = (w.start + stored <= _capacity) ? (uint8_t*)malloc(w.chunk) : nullptr;
+    uint8_t h[UnifiedFSLz::HEADER_SIZE];
+    UnifiedFSLz::writeHeader(h, raw32);
+    ok = w.buf && ZWriter::sink(&w, h, sizeof(h)) && ZWriter::sink(&w, table, 4 * blocks);
+    CRC32Fast::Crc32 again;
+    for (uint32_t b = 0; ok && b < blocks; ++b) {
+      const uint32_t off = b * UnifiedFSLz::BLOCK, n = min<uint32_t>(UnifiedFSLz::BLOCK, raw32 - off);
+      ok = src(ctx, off, in, n) && UnifiedFSLz::compress(t, in, n, &ZWriter::sink, &w);
+      again.update(in, n);
+    }
+    ok = ok && w.flush() && w.pos == stored && again.value() == sum;  // src must not change between passes
+    free(w.buf);
+    free(in);
+    free(table);
+    if (!ok) return false;
+    uint32_t seq = 0;
+    if (!appendDirEntry(FLAG_COMPRESSED, name, w.start, w.pos, seq, &sum)) return false;
+    upsertFileIndex(name, w.start, w.pos, false, seq);
+    noteCrc(name, sum);
+    int idx = findIndexByName(name);
+    if (idx >= 0) {
+      _files[idx].compressed = true;
+      _files[idx].rawSize = raw32;
+    }
+    _dataHead = w.start + w.pos;
+    computeCapacities(_dataHead);
+    return true;
+  }  // writeFileCompressed() output: buffers one program chunk (a page on NAND) and makes sure
+  // erase units entered past the data head are erased before the first program into them
+  struct ZWriter {
+    UnifiedSimpleFS_Generic* fs;
+    uint64_t start = 0, pos = 0;
+    uint64_t prepared = 0;  // units below this address are ready for programming
+    uint8_t* buf = nullptr;
+    uint32_t chunk = 0, fill = 0;
+    static bool sink(void* ctx, const uint8_t* p, size_t n) {
+      ZWriter* w = static_cast<ZWriter*>(ctx);
+      while (n) {
+        size_t k = min<size_t>(n, w->chunk - w->fill);
+        memcpy(w->buf + w->fill, p, k);
+        w->fill += k;
+        p += k;
+        n -= k;
+        if (w->fill == w->chunk && !w->flush()) return false;
+      }
+      return true;
+    }
+    bool flush() {
+      if (!fill) return true;
+      const uint64_t a = start + pos;
+      if (a + fill > fs->_capacity) return false;
+      const uint32_t align = fs->_eraseAlign;
+      while (align > 1 && a + fill > prepared) {
+        if (!fs->_dev.ensureErased(prepared, align)) return false;
+        prepared += align;
+      }
+      if (!fs->_dev.writeData02(a, buf, fill)) return false;
+      pos += fill;
+      fill = 0;
+      return true;
+    }
+  };
+  static bool countSink(void*, const uint8_t*, size_t) {
+    return true;
+  }
+  static bool memSource(void* ctx, uint64_t offset, uint8_t* buf, uint32_t len) {
+    memcpy(buf, static_cast<const uint8_t*>(ctx) + offset, len);
+    return true;
+  }
+  // Decoder state for the compressed file being streamed (sequential reads continue it)
+  struct ZStream {
+    UnifiedSimpleFS_Generic* fs;
+    uint64_t file = ~0ULL;
+    uint32_t seq = 0;
+    uint32_t block = 0;     // v2: raw bytes per block (0: v1, one stream)
+    uint64_t blocks0 = 0;   // v2: address of block 0 (the restart table precedes it)
+    uint64_t src = 0, srcEnd = 0;
+    uint8_t in[64];
+    uint8_t inPos = 0, inLen = 0;
+    UnifiedFSLz::Decoder dec;
+    bool next(uint8_t& c) {
+      if (inPos == inLen) {
+        uint32_t n = (uint32_t)min<uint64_t>(sizeof(in), srcEnd - src);
+        if (n == 0 || !fs->_dev.readStream(src, in, n, srcEnd)) return false;
+        src += n;
+        inPos = 0;
+        inLen = (uint8_t)n;
+      }
+      c = in[inPos++];
+      return true;
+    }
+  };
+  uint32_t readCompressed(const FileInfo& fi, uint64_t offset, uint8_t* buf, uint32_t len) {
+    if (offset >= fi.rawSize || len == 0 || !buf) return 0;
+    len = (uint32_t)min<uint64_t>(len, fi.rawSize - offset);
+    if (!_z) {
+      _z = new ZStream;
+      _z->fs = this;
+    }
+    ZStream& z = *_z;
+    if (z.file != fi.addr || z.seq != fi.seq) {
+      uint8_t h[UnifiedFSLz::HEADER_SIZE];
+      uint32_t raw = 0;
+      uint8_t ver = 0;
+      if (!_dev.readData03(fi.addr, h, sizeof(h)) || !UnifiedFSLz::parseHeader(h, raw, &ver)) return 0;
+      z.file = fi.addr;
+      z.seq = fi.seq;
+      z.block = ver >= 2 ? UnifiedFSLz::BLOCK : 0;
+      z.blocks0 = fi.addr + UnifiedFSLz::HEADER_SIZE + (ver >= 2 ? 4ULL * UnifiedFSLz::blockCount(raw) : 0);
+      z.srcEnd = fi.addr + fi.size;
+      z.dec.out = ~0u;  // force a seek below
+    }
+    // Backward seeks, and forward ones past the current block, restart at offset's block
+    // (v1: the top of the stream)
+    if (offset < z.dec.out || (z.block && offset / z.block != z.dec.out / z.block)) {
+      uint64_t at = 0;
+      if (z.block) {
+        uint8_t e[4];
+        const uint32_t b = (uint32_t)(offset / z.block);
+        if (!_dev.readData03(fi.addr + UnifiedFSLz::HEADER_SIZE + 4ULL * b, e, 4)) {
+          z.file = ~0ULL;
+          return 0;
+        }
+        at = rd32(e);
+        z.dec.restartAt(b * z.block);
+      } else {
+        z.dec.reset();
+      }
+      z.src = z.blocks0 + at;
+      z.inPos = z.inLen = 0;
+    }
+    if (!zDecode(z, nullptr, (uint32_t)(offset - z.dec.out)) || !zDecode(z, buf, len)) {
+      z.file = ~0ULL;
+      return 0;
+    }
+    return len;
+  }
+  // n raw bytes into dst (nullptr: skipped); a v2 block boundary starts a new group
+  static bool zDecode(ZStream& z, uint8_t* dst, uint32_t n) {
+    while (n) {
+      uint32_t k = z.block ? min<uint32_t>(n, z.block - z.dec.out % z.block) : n;
+      if (z.dec.decode(dst, k, z) != k) return false;
+      if (dst) dst += k;
+      n -= k;
+      if (z.block && z.dec.out % z.block == 0) z.dec.nextBlock();
+    }
+    return true;
+  }
+  // writeFileRange() on a compressed file: decompress, patch in RAM, recompress
+  bool patchCompressed(int idx, uint64_t offset, const uint8_t* data, uint32_t len) {
+    FileInfo& fi = _files[idx];
+    if (offset > fi.rawSize) return false;
+    if (len == 0) return true;
+    if (!data || offset + len > 0xFFFFFFFFUL) return false;  // recompressed whole in RAM
+    const uint32_t newSize = (uint32_t)max<uint64_t>(fi.rawSize, offset + len);
+    uint8_t* raw = (uint8_t*)malloc(newSize);
+    if (!raw) return false;
+    bool ok = readCompressed(fi, 0, raw, (uint32_t)fi.rawSize) == fi.rawSize;
+    if (ok) {
+      memcpy(raw + offset, data, len);
+      char name[MAX_NAME + 1];
+      copyName(name, fi.name);
+      ok = writeFileCompressed(name, raw, newSize);
+    }
+    free(raw);
+    return ok;
+  }
+  void computeCapacities(uint64_t maxEnd) {
     ensureParams();
     int idxs[MAX_FILES];
     size_t n = 0;
-    for (size_t i = 0; i < _fileCount; ++i)
-      if (!_files[i].deleted) idxs[n++] = (int)i;
-    // insertion sort by start address
+    const uint32_t inl = inlineMax();
+    for (size_t i = 0; i < _fileCount; ++i) {
+      FileInfo& fi = _files[i];
+      if (fi.deleted) continue;
+      if (isInline(fi)) {
+        fi.capEnd = fi.addr + inl;  // rewritten by appending a new inline record
+        fi.slotSafe = false;
+      } else {
+        idxs[n++] = (int)i;
+      }
+    }
+    // insertion sort by start address, then size: an empty file sharing its address with the
+    // next one gets no capacity instead of the neighbour's bytes
     for (size_t i = 1; i < n; ++i) {
       int key = idxs[i];
       size_t j = i;
-      while (j > 0 && _files[idxs[j - 1]].addr > _files[key].addr) {
+      while (j > 0 && (_files[idxs[j - 1]].addr > _files[key].addr || (_files[idxs[j - 1]].addr == _files[key].addr && _files[idxs[j - 1]].size > _files[key].size))) {
         idxs[j] = idxs[j - 1];
         --j;
       }
@@ -703,7 +2823,7 @@ private:
     uint32_t align = (_eraseAlign > 1) ? _eraseAlign : 1u;
     for (size_t i = 0; i < n; ++i) {
       FileInfo& fi = _files[idxs[i]];
-      uint32_t nextStart = (i + 1 < n) ? _files[idxs[i + 1]].addr : alignUp(maxEnd, align);
+      uint64_t nextStart = (i + 1 < n) ? _files[idxs[i + 1]].addr : alignUp(maxEnd, align);
       fi.capEnd = nextStart;
       fi.slotSafe = ((fi.addr % align) == 0) && ((fi.capEnd % align) == 0) && (fi.capEnd > fi.addr);
     }
@@ -719,19 +2839,20 @@ public:
   using WriteMode = typename UnifiedSimpleFS_Generic<UnifiedMemFSDriver>::WriteMode;
   UnifiedSPIMemSimpleFS()
     : _mgr(nullptr), _handle(nullptr), _ownsHandle(false),
-      _fs(nullptr), _capacity32(0) {}
+      _fs(nullptr), _capacity(0) {}
   ~UnifiedSPIMemSimpleFS() {
     close();
   }
   // Open helpers
   bool beginWithDevice(UnifiedSpiMem::MemDevice* dev, bool takeOwnership = false) {
     close();
+    Writer w(*this);
     if (!dev) return false;
     _handle = dev;
     _ownsHandle = takeOwnership;
     _driver.attach(_handle);
-    _capacity32 = (uint32_t)min<uint64_t>(_handle->capacity(), 0xFFFFFFFFull);
-    _fs = new UnifiedSimpleFS_Generic<UnifiedMemFSDriver>(_driver, _capacity32);
+    _capacity = _handle->capacity();
+    _fs = new UnifiedSimpleFS_Generic<UnifiedMemFSDriver>(_driver, _capacity);
     return true;
   }
   bool beginAutoPSRAM(UnifiedSpiMem::Manager& mgr) {
@@ -743,84 +2864,344 @@ public:
   bool beginAutoMX35(UnifiedSpiMem::Manager& mgr) {
     return beginByType(mgr, DeviceType::SpiNandMX35);
   }
-  // Mount/format/etc (forwarded to FS)
+  // Mount/format/etc (forwarded to FS). Every call holds the volume lock, except the index-only
+  // lookups below, which run lock-free through peek().
   bool mount(bool autoFormatIfEmpty = true) {
+    Writer w(*this);
     if (!_fs) return false;
     return _fs->mount(autoFormatIfEmpty);
   }
   bool format() {
+    Writer w(*this);
     if (!_fs) return false;
     return _fs->format();
   }
   bool wipeChip() {
+    Writer w(*this);
     if (!_fs) return false;
     return _fs->wipeChip();
   }
   bool writeFile(const char* name, const uint8_t* data, uint32_t size, WriteMode mode = WriteMode::ReplaceIfExists) {
+    Writer w(*this);
     if (!_fs) return false;
     return _fs->writeFile(name, data, size, mode);
   }
   bool writeFile(const char* name, const uint8_t* data, uint32_t size, int modeInt) {
+    Writer w(*this);
     if (!_fs) return false;
     return _fs->writeFile(name, data, size, modeInt);
   }
   template<typename ModeT>
   bool writeFile(const char* name, const uint8_t* data, uint32_t size, ModeT modeOther) {
+    Writer w(*this);
     if (!_fs) return false;
     return _fs->template writeFile<ModeT>(name, data, size, modeOther);
   }
-  bool createFileSlot(const char* name, uint32_t reserveBytes, const uint8_t* initialData = nullptr, uint32_t initialSize = 0) {
+  using ChunkSource = UnifiedSimpleFS_Generic<UnifiedMemFSDriver>::ChunkSource;
+  using PrefixVisitor = UnifiedSimpleFS_Generic<UnifiedMemFSDriver>::PrefixVisitor;
+  bool writeFileFrom(const char* name, uint64_t size, ChunkSource src, void* ctx, WriteMode mode = WriteMode::ReplaceIfExists) {
+    Writer w(*this);
+    if (!_fs) return false;
+    return _fs->writeFileFrom(name, size, src, ctx, mode);
+  }
+  bool createFileSlot(const char* name, uint64_t reserveBytes, const uint8_t* initialData = nullptr, uint32_t initialSize = 0) {
+    Writer w(*this);
     if (!_fs) return false;
     return _fs->createFileSlot(name, reserveBytes, initialData, initialSize);
   }
   bool writeFileInPlace(const char* name, const uint8_t* data, uint32_t size, bool allowReallocate = false) {
+    Writer w(*this);
     if (!_fs) return false;
     return _fs->writeFileInPlace(name, data, size, allowReallocate);
   }
+  bool writeFileRange(const char* name, uint64_t offset, const uint8_t* data, uint32_t len) {
+    Writer w(*this);
+    if (!_fs) return false;
+    return _fs->writeFileRange(name, offset, data, len);
+  }
+  bool writeFileCompressed(const char* name, const uint8_t* data, uint32_t size, WriteMode mode = WriteMode::ReplaceIfExists) {
+    Writer w(*this);
+    if (!_fs) return false;
+    return _fs->writeFileCompressed(name, data, size, mode);
+  }
+  bool writeFileCompressedFrom(const char* name, uint64_t size, ChunkSource src, void* ctx, WriteMode mode = WriteMode::ReplaceIfExists) {
+    Writer w(*this);
+    if (!_fs) return false;
+    return _fs->writeFileCompressedFrom(name, size, src, ctx, mode);
+  }
   uint32_t readFile(const char* name, uint8_t* buf, uint32_t bufSize) {
+    Reader r(_lock);
     if (!_fs) return 0;
     return _fs->readFile(name, buf, bufSize);
   }
-  uint32_t readFileRange(const char* name, uint32_t offset, uint8_t* buf, uint32_t len) {
+  uint32_t readFileRange(const char* name, uint64_t offset, uint8_t* buf, uint32_t len) {
+    Reader r(_lock);
     if (!_fs) return 0;
     return _fs->readFileRange(name, offset, buf, len);
   }
+  bool getFileSize(const char* name, uint64_t& sizeOut) {
+    if (!_fs) return false;
+    return peek([&] {
+      return _fs->getFileSize(name, sizeOut);
+    });
+  }
   bool getFileSize(const char* name, uint32_t& sizeOut) {
     if (!_fs) return false;
-    return _fs->getFileSize(name, sizeOut);
+    return peek([&] {
+      return _fs->getFileSize(name, sizeOut);
+    });
+  }
+  bool getFileInfo(const char* name, uint64_t& addrOut, uint64_t& sizeOut, uint64_t& capOut) {
+    if (!_fs) return false;
+    return peek([&] {
+      return _fs->getFileInfo(name, addrOut, sizeOut, capOut);
+    });
   }
   bool getFileInfo(const char* name, uint32_t& addrOut, uint32_t& sizeOut, uint32_t& capOut) {
     if (!_fs) return false;
-    return _fs->getFileInfo(name, addrOut, sizeOut, capOut);
+    return peek([&] {
+      return _fs->getFileInfo(name, addrOut, sizeOut, capOut);
+    });
   }
   bool exists(const char* name) {
     if (!_fs) return false;
-    return _fs->exists(name);
+    return peek([&] {
+      return _fs->exists(name);
+    });
+  }
+  bool getStoredSize(const char* name, uint64_t& sizeOut, bool& compressedOut) {
+    if (!_fs) return false;
+    return peek([&] {
+      return _fs->getStoredSize(name, sizeOut, compressedOut);
+    });
+  }
+  bool getStoredSize(const char* name, uint32_t& sizeOut, bool& compressedOut) {
+    if (!_fs) return false;
+    return peek([&] {
+      return _fs->getStoredSize(name, sizeOut, compressedOut);
+    });
+  }
+  bool getFileCrc(const char* name, uint32_t& crcOut) {
+    if (!_fs) return false;
+    return peek([&] {
+      return _fs->getFileCrc(name, crcOut);
+    });
+  }
+  bool getFileGeneration(const char* name, uint32_t& genOut) {
+    if (!_fs) return false;
+    return peek([&] {
+      return _fs->getFileGeneration(name, genOut);
+    });
   }
   bool deleteFile(const char* name) {
+    Writer w(*this);
     if (!_fs) return false;
     return _fs->deleteFile(name);
   }
+  bool deletePrefix(const char* prefix, uint32_t* countOut = nullptr) {
+    Writer w(*this);
+    if (!_fs) return false;
+    return _fs->deletePrefix(prefix, countOut);
+  }
+  size_t visitPrefix(const char* prefix, PrefixVisitor fn, void* ctx) const {
+    Reader r(_lock);
+    if (!_fs) return 0;
+    return _fs->visitPrefix(prefix, fn, ctx);
+  }
+  uint32_t dirBytesUsed() const {
+    return _fs ? _fs->dirBytesUsed() : 0;
+  }
   void listFilesToSerial(Stream& out = Serial) {
+    Reader r(_lock);
     if (!_fs) return;
     _fs->listFilesToSerial(out);
   }
   size_t fileCount() const {
     if (!_fs) return 0;
-    return _fs->fileCount();
+    return peek([&] {
+      return _fs->fileCount();
+    });
   }
-  uint32_t nextDataAddr() const {
+  uint64_t nextDataAddr() const {
     if (!_fs) return 0;
     return _fs->nextDataAddr();
   }
-  uint32_t capacity() const {
+  uint64_t capacity() const {
     if (!_fs) return 0;
     return _fs->capacity();
   }
   uint32_t dataRegionStart() const {
-    if (!_fs) return UnifiedSimpleFS_Generic<UnifiedMemFSDriver>::DATA_START;
+    if (!_fs) return UnifiedSimpleFS_Generic<UnifiedMemFSDriver>::LEGACY_DIR_SIZE;
     return _fs->dataRegionStart();
   }
+  uint32_t dirSize() const {
+    return _fs ? _fs->dirSize() : 0;
+  }
+  uint8_t layoutVersion() const {
+    return _fs ? _fs->layoutVersion() : 0;
+  }
+  void setFormatDirSize(uint32_t bytes) {
+    Reader r(_lock);
+    if (_fs) _fs->setFormatDirSize(bytes);
+  }
+  uint32_t plannedDirSize() {
+    Reader r(_lock);
+    return _fs ? _fs->plannedDirSize() : 0;
+  }
+  size_t fileSlots() const {
+    if (!_fs) return 0;
+    return _fs->fileSlots();
+  }
+  // nameOut points into the index: valid until the next write (hold no lock across one)
+  bool fileAt(size_t i, const char*& nameOut, uint64_t& sizeOut) const {
+    Reader r(_lock);
+    if (!_fs) return false;
+    return _fs->fileAt(i, nameOut, sizeOut);
+  }
+  bool fileAt(size_t i, const char*& nameOut, uint32_t& sizeOut) const {
+    Reader r(_lock);
+    if (!_fs) return false;
+    return _fs->fileAt(i, nameOut, sizeOut);
+  }
+  bool canUpdateInPlace() const {
+    if (!_fs) return false;
+    return _fs->canUpdateInPlace();
+  }
+  bool createFixedFile(const char* name, uint64_t size) {
+    Writer w(*this);
+    if (!_fs) return false;
+    return _fs->createFixedFile(name, size);
+  }
+  bool eraseFileRange(const char* name, uint64_t offset, uint32_t len) {
+    Writer w(*this);
+    if (!_fs) return false;
+    return _fs->eraseFileRange(name, offset, len);
+  }
+  bool programFileRange(const char* name, uint64_t offset, const uint8_t* data, uint32_t len) {
+    Writer w(*this);
+    if (!_fs) return false;
+    return _fs->programFileRange(name, offset, data, len);
+  }
+  uint32_t eraseUnit() const {
+    if (!_fs) return 1;
+    return _fs->eraseUnit();
+  }
+  uint32_t programUnit() const {
+    if (!_fs) return 1;
+    return _fs->programUnit();
+  }
+  bool preEraseStep() {
+    Reader r(_lock);
+    if (!_fs) return false;
+    return _fs->preEraseStep();
+  }
+  // Advance the device's background program/erase; completions update FS state (erased map,
+  // cache), so poll through the volume rather than the device
+  bool pollAsync() {
+    Reader r(_lock);
+    return _handle && _handle->asyncBusy() && _handle->pollAsync();
+  }
+  void setPreEraseBytes(uint32_t bytes) {
+    Reader r(_lock);
+    if (_fs) _fs->setPreEraseBytes(bytes);
+  }
+  void setVerifyErased(bool on) {
+    _driver.setVerifyErased(on);
+  }
+  const UnifiedMemFSDriver::WriteStats& writeStats() const {
+    return _driver.writeStats();
+  }
+  void resetWriteStats() {
+    _driver.resetWriteStats();
+  }
+  void setCachePolicy(UnifiedMemFSDriver::CachePolicy p) {
+    Reader r(_lock);
+    _driver.setCachePolicy(p);
+  }
+  UnifiedMemFSDriver::CachePolicy cachePolicy() const {
+    return _driver.cachePolicy();
+  }
+  const UnifiedMemFSDriver::CacheStats& cacheStats() const {
+    return _driver.cacheStats();
+  }
+  void resetCacheStats() {
+    _driver.resetCacheStats();
+  }
+  void trackChanges(bool on) {
+    Writer w(*this);
+    _driver.trackChanges(on);
+  }
+  bool trackingChanges() const {
+    return _driver.trackingChanges();
+  }
+  bool changedSince(uint64_t addr, uint64_t len) const {
+    Reader r(_lock);
+    return _driver.changedSince(addr, len);
+  }
+  bool changedIn(const uint8_t* map, uint64_t addr, uint64_t len) const {
+    Reader r(_lock);
+    return _driver.changedIn(map, addr, len);
+  }
+  void clearChanges() {
+    Writer w(*this);
+    _driver.clearChanges();
+  }
+  // Atomic snapshot-and-clear of the change map for a checkpoint; hand it back with
+  // mergeChanges() when the checkpoint fails, dropChanges() when it succeeds
+  uint8_t* takeChanges() {
+    Writer w(*this);
+    return _driver.takeChanges();
+  }
+  void mergeChanges(uint8_t* taken) {
+    Writer w(*this);
+    _driver.mergeChanges(taken);
+  }
+  void dropChanges(uint8_t* taken) {
+    _driver.dropChanges(taken);
+  }
+  uint32_t changeGranule() const {
+    return _driver.changeGranule();
+  }
+  bool reserveIndexSnapshot() {
+    Writer w(*this);
+    return _fs && _fs->reserveIndexSnapshot();
+  }
+  bool hasIndexSnapshot() const {
+    return _fs && _fs->hasIndexSnapshot();
+  }
+  bool indexSnapshotCurrent() const {
+    return _fs && _fs->indexSnapshotCurrent();
+  }
+  bool saveIndexSnapshot(uint32_t epoch) {
+    Reader r(_lock);
+    return _fs && _fs->saveIndexSnapshot(epoch);
+  }
+  bool mountFromSnapshot(uint32_t epoch) {
+    Writer w(*this);
+    return _fs && _fs->mountFromSnapshot(epoch);
+  }
+  bool durableSnapshot() const {
+    return _fs && _fs->durableSnapshot();
+  }
+  uint32_t recordsSinceSnapshot() const {
+    return _fs ? _fs->recordsSinceSnapshot() : 0;
+  }
+  uint32_t snapshotReplayed() const {
+    return _fs ? _fs->snapshotReplayed() : 0;
+  }
+  bool mounted() const {
+    return _fs && _fs->mounted();
+  }
+  // Flush write-back lines; on flash/NAND also refresh a durable index snapshot that fell behind
+  bool sync() {
+    Reader r(_lock);
+    if (!_driver.sync()) return false;
+    return !_fs || !_fs->durableSnapshot() || _fs->syncIndexSnapshot();
+  }
+  bool flushStep() {
+    Reader r(_lock);
+    return _driver.flushStep();
+  }
   // Accessors
   UnifiedSpiMem::MemDevice* device() const {
     return _handle;
@@ -828,8 +3209,12 @@ public:
   UnifiedSpiMem::DeviceType deviceType() const {
     return _driver.deviceType();
   }
-  // Release resources (and reservation if managed by Manager)
+  // Release resources (and reservation if managed by Manager). Opening/closing a volume is not
+  // synchronized with the other core: do it while nothing else is using the volume.
   void close() {
+    Writer w(*this);
+    _driver.sync();
+    if (_handle) _handle->drainAsync();  // pending callbacks may reference _fs
     if (_fs) {
       delete _fs;
       _fs = nullptr;
@@ -846,11 +3231,46 @@ public:
     } else {
       _handle = nullptr;
     }
-    _capacity32 = 0;
+    _capacity = 0;
   }
 private:
+  typedef UnifiedSpiMem::LockGuard Reader;  // device I/O and driver state; index unchanged
+  // Mutating calls: volume lock, and the index sequence is odd while the outermost one runs
+  class Writer {
+  public:
+    explicit Writer(UnifiedSPIMemSimpleFS& v)
+      : _v(v) {
+      _v._lock.lock();
+      if (_v._writers++ == 0) {
+        __atomic_store_n(&_v._seq, _v._seq + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);  // odd before any index store
+      }
+    }
+    ~Writer() {
+      if (--_v._writers == 0) __atomic_store_n(&_v._seq, _v._seq + 1, __ATOMIC_RELEASE);
+      _v._lock.unlock();
+    }
+  private:
+    UnifiedSPIMemSimpleFS& _v;
+  };
+  // Seqlock read of the RAM index: run f unlocked, keep the result if no writer was inside or
+  // finished in between; otherwise run it again under the lock (also the path for lookups made
+  // from inside a write on the same core). The lookups stay in bounds whatever they race with
+  // (strncmp over fixed name arrays, _order holds slot numbers), so a discarded run is harmless.
+  template<typename F>
+  auto peek(F f) const -> decltype(f()) {
+    const uint32_t s = __atomic_load_n(&_seq, __ATOMIC_ACQUIRE);
+    if (!(s & 1)) {
+      auto r = f();
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (__atomic_load_n(&_seq, __ATOMIC_RELAXED) == s) return r;
+    }
+    Reader g(_lock);
+    return f();
+  }
   bool beginByType(UnifiedSpiMem::Manager& mgr, DeviceType t) {
     close();
+    Writer w(*this);
     _mgr = &mgr;
     UnifiedSpiMem::MemDevice* dev = mgr.openPreferred(t);
     if (!dev) {
@@ -860,8 +3280,8 @@ private:
     _handle = dev;
     _ownsHandle = false;  // Owned by Manager reservation
     _driver.attach(_handle);
-    _capacity32 = (uint32_t)min<uint64_t>(_handle->capacity(), 0xFFFFFFFFull);
-    _fs = new UnifiedSimpleFS_Generic<UnifiedMemFSDriver>(_driver, _capacity32);
+    _capacity = _handle->capacity();
+    _fs = new UnifiedSimpleFS_Generic<UnifiedMemFSDriver>(_driver, _capacity);
     return true;
   }
   UnifiedSpiMem::Manager* _mgr;
@@ -869,7 +3289,10 @@ private:
   bool _ownsHandle;
   UnifiedMemFSDriver _driver;
   UnifiedSimpleFS_Generic<UnifiedMemFSDriver>* _fs;
-  uint32_t _capacity32;
+  uint64_t _capacity;
+  mutable UnifiedSpiMem::RecursiveLock _lock;  // volume lock (both cores)
+  uint32_t _seq = 0;                           // index sequence, odd while a Writer is inside
+  uint32_t _writers = 0;                       // Writer nesting on the owning core
 };
 
 // -------------------------------------------
@@ -901,45 +3324,99 @@ public:
   template<typename ModeT> bool writeFile(const char* n, const uint8_t* d, uint32_t s, ModeT mo) {
     return _core.writeFile<ModeT>(n, d, s, mo);
   }
-  bool createFileSlot(const char* n, uint32_t r, const uint8_t* id = nullptr, uint32_t isz = 0) {
+  bool createFileSlot(const char* n, uint64_t r, const uint8_t* id = nullptr, uint32_t isz = 0) {
     return _core.createFileSlot(n, r, id, isz);
   }
+  bool writeFileFrom(const char* n, uint64_t s, UnifiedSPIMemSimpleFS::ChunkSource src, void* ctx, WriteMode m = WriteMode::ReplaceIfExists) {
+    return _core.writeFileFrom(n, s, src, ctx, m);
+  }
   bool writeFileInPlace(const char* n, const uint8_t* d, uint32_t s, bool ar = false) {
     return _core.writeFileInPlace(n, d, s, ar);
   }
+  bool writeFileRange(const char* n, uint64_t off, const uint8_t* d, uint32_t l) {
+    return _core.writeFileRange(n, off, d, l);
+  }
+  bool writeFileCompressed(const char* n, const uint8_t* d, uint32_t s, WriteMode m = WriteMode::ReplaceIfExists) {
+    return _core.writeFileCompressed(n, d, s, m);
+  }
+  bool writeFileCompressedFrom(const char* n, uint64_t s, UnifiedSPIMemSimpleFS::ChunkSource src, void* ctx, WriteMode m = WriteMode::ReplaceIfExists) {
+    return _core.writeFileCompressedFrom(n, s, src, ctx, m);
+  }
   uint32_t readFile(const char* n, uint8_t* b, uint32_t bs) {
     return _core.readFile(n, b, bs);
   }
-  uint32_t readFileRange(const char* n, uint32_t off, uint8_t* b, uint32_t l) {
+  uint32_t readFileRange(const char* n, uint64_t off, uint8_t* b, uint32_t l) {
     return _core.readFileRange(n, off, b, l);
   }
+  bool getFileSize(const char* n, uint64_t& so) {
+    return _core.getFileSize(n, so);
+  }
   bool getFileSize(const char* n, uint32_t& so) {
     return _core.getFileSize(n, so);
   }
+  bool getFileInfo(const char* n, uint64_t& a, uint64_t& s, uint64_t& c) {
+    return _core.getFileInfo(n, a, s, c);
+  }
   bool getFileInfo(const char* n, uint32_t& a, uint32_t& s, uint32_t& c) {
     return _core.getFileInfo(n, a, s, c);
   }
   bool exists(const char* n) {
     return _core.exists(n);
   }
+  bool getStoredSize(const char* n, uint64_t& s, bool& z) {
+    return _core.getStoredSize(n, s, z);
+  }
+  bool getStoredSize(const char* n, uint32_t& s, bool& z) {
+    return _core.getStoredSize(n, s, z);
+  }
+  bool getFileCrc(const char* n, uint32_t& c) {
+    return _core.getFileCrc(n, c);
+  }
+  bool getFileGeneration(const char* n, uint32_t& g) {
+    return _core.getFileGeneration(n, g);
+  }
   bool deleteFile(const char* n) {
     return _core.deleteFile(n);
   }
+  bool deletePrefix(const char* p, uint32_t* count = nullptr) {
+    return _core.deletePrefix(p, count);
+  }
+  size_t visitPrefix(const char* p, UnifiedSPIMemSimpleFS::PrefixVisitor fn, void* ctx) const {
+    return _core.visitPrefix(p, fn, ctx);
+  }
+  uint32_t dirBytesUsed() const {
+    return _core.dirBytesUsed();
+  }
   void listFilesToSerial(Stream& out = Serial) {
     _core.listFilesToSerial(out);
   }
   size_t fileCount() const {
     return _core.fileCount();
   }
-  uint32_t nextDataAddr() const {
+  uint64_t nextDataAddr() const {
     return _core.nextDataAddr();
   }
-  uint32_t capacity() const {
+  uint64_t capacity() const {
     return _core.capacity();
   }
   uint32_t dataRegionStart() const {
     return _core.dataRegionStart();
   }
+  size_t fileSlots() const {
+    return _core.fileSlots();
+  }
+  bool fileAt(size_t i, const char*& n, uint64_t& s) const {
+    return _core.fileAt(i, n, s);
+  }
+  bool fileAt(size_t i, const char*& n, uint32_t& s) const {
+    return _core.fileAt(i, n, s);
+  }
+  bool preEraseStep() {
+    return _core.preEraseStep();
+  }
+  void setPreEraseBytes(uint32_t bytes) {
+    _core.setPreEraseBytes(bytes);
+  }
   void close() {
     _core.close();
   }
@@ -975,45 +3452,99 @@ public:
   template<typename ModeT> bool writeFile(const char* n, const uint8_t* d, uint32_t s, ModeT mo) {
     return _core.writeFile<ModeT>(n, d, s, mo);
   }
-  bool createFileSlot(const char* n, uint32_t r, const uint8_t* id = nullptr, uint32_t isz = 0) {
+  bool createFileSlot(const char* n, uint64_t r, const uint8_t* id = nullptr, uint32_t isz = 0) {
     return _core.createFileSlot(n, r, id, isz);
   }
+  bool writeFileFrom(const char* n, uint64_t s, UnifiedSPIMemSimpleFS::ChunkSource src, void* ctx, WriteMode m = WriteMode::ReplaceIfExists) {
+    return _core.writeFileFrom(n, s, src, ctx, m);
+  }
   bool writeFileInPlace(const char* n, const uint8_t* d, uint32_t s, bool ar = false) {
     return _core.writeFileInPlace(n, d, s, ar);
   }
+  bool writeFileRange(const char* n, uint64_t off, const uint8_t* d, uint32_t l) {
+    return _core.writeFileRange(n, off, d, l);
+  }
+  bool writeFileCompressed(const char* n, const uint8_t* d, uint32_t s, WriteMode m = WriteMode::ReplaceIfExists) {
+    return _core.writeFileCompressed(n, d, s, m);
+  }
+  bool writeFileCompressedFrom(const char* n, uint64_t s, UnifiedSPIMemSimpleFS::ChunkSource src, void* ctx, WriteMode m = WriteMode::ReplaceIfExists) {
+    return _core.writeFileCompressedFrom(n, s, src, ctx, m);
+  }
   uint32_t readFile(const char* n, uint8_t* b, uint32_t bs) {
     return _core.readFile(n, b, bs);
   }
-  uint32_t readFileRange(const char* n, uint32_t off, uint8_t* b, uint32_t l) {
+  uint32_t readFileRange(const char* n, uint64_t off, uint8_t* b, uint32_t l) {
     return _core.readFileRange(n, off, b, l);
   }
+  bool getFileSize(const char* n, uint64_t& so) {
+    return _core.getFileSize(n, so);
+  }
   bool getFileSize(const char* n, uint32_t& so) {
     return _core.getFileSize(n, so);
   }
+  bool getFileInfo(const char* n, uint64_t& a, uint64_t& s, uint64_t& c) {
+    return _core.getFileInfo(n, a, s, c);
+  }
   bool getFileInfo(const char* n, uint32_t& a, uint32_t& s, uint32_t& c) {
     return _core.getFileInfo(n, a, s, c);
   }
   bool exists(const char* n) {
     return _core.exists(n);
   }
+  bool getStoredSize(const char* n, uint64_t& s, bool& z) {
+    return _core.getStoredSize(n, s, z);
+  }
+  bool getStoredSize(const char* n, uint32_t& s, bool& z) {
+    return _core.getStoredSize(n, s, z);
+  }
+  bool getFileCrc(const char* n, uint32_t& c) {
+    return _core.getFileCrc(n, c);
+  }
+  bool getFileGeneration(const char* n, uint32_t& g) {
+    return _core.getFileGeneration(n, g);
+  }
   bool deleteFile(const char* n) {
     return _core.deleteFile(n);
   }
+  bool deletePrefix(const char* p, uint32_t* count = nullptr) {
+    return _core.deletePrefix(p, count);
+  }
+  size_t visitPrefix(const char* p, UnifiedSPIMemSimpleFS::PrefixVisitor fn, void* ctx) const {
+    return _core.visitPrefix(p, fn, ctx);
+  }
+  uint32_t dirBytesUsed() const {
+    return _core.dirBytesUsed();
+  }
   void listFilesToSerial(Stream& out = Serial) {
     _core.listFilesToSerial(out);
   }
   size_t fileCount() const {
     return _core.fileCount();
   }
-  uint32_t nextDataAddr() const {
+  uint64_t nextDataAddr() const {
     return _core.nextDataAddr();
   }
-  uint32_t capacity() const {
+  uint64_t capacity() const {
     return _core.capacity();
   }
   uint32_t dataRegionStart() const {
     return _core.dataRegionStart();
   }
+  size_t fileSlots() const {
+    return _core.fileSlots();
+  }
+  bool fileAt(size_t i, const char*& n, uint64_t& s) const {
+    return _core.fileAt(i, n, s);
+  }
+  bool fileAt(size_t i, const char*& n, uint32_t& s) const {
+    return _core.fileAt(i, n, s);
+  }
+  bool preEraseStep() {
+    return _core.preEraseStep();
+  }
+  void setPreEraseBytes(uint32_t bytes) {
+    _core.setPreEraseBytes(bytes);
+  }
   void close() {
     _core.close();
   }
@@ -1049,45 +3580,99 @@ public:
   template<typename ModeT> bool writeFile(const char* n, const uint8_t* d, uint32_t s, ModeT mo) {
     return _core.writeFile<ModeT>(n, d, s, mo);
   }
-  bool createFileSlot(const char* n, uint32_t r, const uint8_t* id = nullptr, uint32_t isz = 0) {
+  bool createFileSlot(const char* n, uint64_t r, const uint8_t* id = nullptr, uint32_t isz = 0) {
     return _core.createFileSlot(n, r, id, isz);
   }
+  bool writeFileFrom(const char* n, uint64_t s, UnifiedSPIMemSimpleFS::ChunkSource src, void* ctx, WriteMode m = WriteMode::ReplaceIfExists) {
+    return _core.writeFileFrom(n, s, src, ctx, m);
+  }
   bool writeFileInPlace(const char* n, const uint8_t* d, uint32_t s, bool ar = false) {
     return _core.writeFileInPlace(n, d, s, ar);
   }
+  bool writeFileRange(const char* n, uint64_t off, const uint8_t* d, uint32_t l) {
+    return _core.writeFileRange(n, off, d, l);
+  }
+  bool writeFileCompressed(const char* n, const uint8_t* d, uint32_t s, WriteMode m = WriteMode::ReplaceIfExists) {
+    return _core.writeFileCompressed(n, d, s, m);
+  }
+  bool writeFileCompressedFrom(const char* n, uint64_t s, UnifiedSPIMemSimpleFS::ChunkSource src, void* ctx, WriteMode m = WriteMode::ReplaceIfExists) {
+    return _core.writeFileCompressedFrom(n, s, src, ctx, m);
+  }
   uint32_t readFile(const char* n, uint8_t* b, uint32_t bs) {
     return _core.readFile(n, b, bs);
   }
-  uint32_t readFileRange(const char* n, uint32_t off, uint8_t* b, uint32_t l) {
+  uint32_t readFileRange(const char* n, uint64_t off, uint8_t* b, uint32_t l) {
     return _core.readFileRange(n, off, b, l);
   }
+  bool getFileSize(const char* n, uint64_t& so) {
+    return _core.getFileSize(n, so);
+  }
   bool getFileSize(const char* n, uint32_t& so) {
     return _core.getFileSize(n, so);
   }
+  bool getFileInfo(const char* n, uint64_t& a, uint64_t& s, uint64_t& c) {
+    return _core.getFileInfo(n, a, s, c);
+  }
   bool getFileInfo(const char* n, uint32_t& a, uint32_t& s, uint32_t& c) {
     return _core.getFileInfo(n, a, s, c);
   }
   bool exists(const char* n) {
     return _core.exists(n);
   }
+  bool getStoredSize(const char* n, uint64_t& s, bool& z) {
+    return _core.getStoredSize(n, s, z);
+  }
+  bool getStoredSize(const char* n, uint32_t& s, bool& z) {
+    return _core.getStoredSize(n, s, z);
+  }
+  bool getFileCrc(const char* n, uint32_t& c) {
+    return _core.getFileCrc(n, c);
+  }
+  bool getFileGeneration(const char* n, uint32_t& g) {
+    return _core.getFileGeneration(n, g);
+  }
   bool deleteFile(const char* n) {
     return _core.deleteFile(n);
   }
+  bool deletePrefix(const char* p, uint32_t* count = nullptr) {
+    return _core.deletePrefix(p, count);
+  }
+  size_t visitPrefix(const char* p, UnifiedSPIMemSimpleFS::PrefixVisitor fn, void* ctx) const {
+    return _core.visitPrefix(p, fn, ctx);
+  }
+  uint32_t dirBytesUsed() const {
+    return _core.dirBytesUsed();
+  }
   void listFilesToSerial(Stream& out = Serial) {
     return _core.listFilesToSerial(out);
   }
   size_t fileCount() const {
     return _core.fileCount();
   }
-  uint32_t nextDataAddr() const {
+  uint64_t nextDataAddr() const {
     return _core.nextDataAddr();
   }
-  uint32_t capacity() const {
+  uint64_t capacity() const {
     return _core.capacity();
   }
   uint32_t dataRegionStart() const {
     return _core.dataRegionStart();
   }
+  size_t fileSlots() const {
+    return _core.fileSlots();
+  }
+  bool fileAt(size_t i, const char*& n, uint64_t& s) const {
+    return _core.fileAt(i, n, s);
+  }
+  bool fileAt(size_t i, const char*& n, uint32_t& s) const {
+    return _core.fileAt(i, n, s);
+  }
+  bool preEraseStep() {
+    return _core.preEraseStep();
+  }
+  void setPreEraseBytes(uint32_t bytes) {
+    _core.setPreEraseBytes(bytes);
+  }
   void close() {
     _core.close();
   }
@@ -47,6 +47,9 @@ static ConsolePrint Console;  // Console wrapper
 #define FILE_PT1 "pt1"
 #define FILE_PT2 "pt2"
 #define FILE_PT3 "pt3"
+#ifndef CHECKPOINT_RESTORE_AT_BOOT
+#define CHECKPOINT_RESTORE_AT_BOOT 0  // 1: repopulate the PSRAM FS from the flash checkpoint image in setup()
+#endif
 // ========== Static buffer-related compile-time constant ==========
 #define FS_SECTOR_SIZE 4096
 // Pins you already have:
@@ -83,39 +86,105 @@ struct ActiveFS {
   bool (*format)() = nullptr;
   bool (*wipeChip)() = nullptr;
   bool (*exists)(const char*) = nullptr;
-  bool (*createFileSlot)(const char*, uint32_t, const uint8_t*, uint32_t) = nullptr;
+  bool (*createFileSlot)(const char*, uint64_t, const uint8_t*, uint32_t) = nullptr;
   bool (*writeFile)(const char*, const uint8_t*, uint32_t, int /*mode*/) = nullptr;
   bool (*writeFileInPlace)(const char*, const uint8_t*, uint32_t, bool) = nullptr;
+  bool (*writeFileRange)(const char*, uint64_t, const uint8_t*, uint32_t) = nullptr;
+  bool (*writeFileCompressed)(const char*, const uint8_t*, uint32_t) = nullptr;
+  bool (*writeFileCompressedFrom)(const char*, uint64_t, UnifiedSPIMemSimpleFS::ChunkSource, void*) = nullptr;
+  bool (*getStoredSize)(const char*, uint64_t&, bool&) = nullptr;
+  bool (*getFileCrc)(const char*, uint32_t&) = nullptr;
+  bool (*getFileGeneration)(const char*, uint32_t&) = nullptr;
   uint32_t (*readFile)(const char*, uint8_t*, uint32_t) = nullptr;
-  uint32_t (*readFileRange)(const char*, uint32_t, uint8_t*, uint32_t) = nullptr;
-  bool (*getFileSize)(const char*, uint32_t&) = nullptr;
-  bool (*getFileInfo)(const char*, uint32_t&, uint32_t&, uint32_t&) = nullptr;
+  uint32_t (*readFileRange)(const char*, uint64_t, uint8_t*, uint32_t) = nullptr;
+  bool (*getFileSize)(const char*, uint64_t&) = nullptr;
+  bool (*getFileInfo)(const char*, uint64_t&, uint64_t&, uint64_t&) = nullptr;
   bool (*deleteFile)(const char*) = nullptr;
+  bool (*deletePrefix)(const char*, uint32_t*) = nullptr;
+  size_t (*visitPrefix)(const char*, UnifiedSPIMemSimpleFS::PrefixVisitor, void*) = nullptr;
+  uint32_t (*dirBytesUsed)() = nullptr;
   void (*listFilesToSerial)() = nullptr;
-  uint32_t (*nextDataAddr)() = nullptr;
-  uint32_t (*capacity)() = nullptr;
+  uint64_t (*nextDataAddr)() = nullptr;
+  uint64_t (*capacity)() = nullptr;
   uint32_t (*dataRegionStart)() = nullptr;
   static constexpr uint32_t SECTOR_SIZE = FS_SECTOR_SIZE;
   static constexpr uint32_t PAGE_SIZE = 256;
   static constexpr size_t MAX_NAME = 32;
 } activeFs;
 
-struct FsIndexEntry {
-  char name[ActiveFS::MAX_NAME + 1];
-  uint32_t size;
-  bool deleted;
-  uint32_t seq;
-};
+// Whole-file paths that buffer the file in RAM: size as 32 bits, false for files of 4 GiB or more
+static bool activeFileSize32(const char* name, uint32_t& size) {
+  uint64_t s = 0;
+  if (!activeFs.getFileSize(name, s) || s > 0xFFFFFFFFUL) return false;
+  size = (uint32_t)s;
+  return true;
+}
 
 struct FSIface {
   bool (*mount)(bool);
   bool (*exists)(const char*);
-  bool (*createFileSlot)(const char*, uint32_t, const uint8_t*, uint32_t);
+  bool (*createFileSlot)(const char*, uint64_t, const uint8_t*, uint32_t);
   bool (*writeFile)(const char*, const uint8_t*, uint32_t, int);
   bool (*writeFileInPlace)(const char*, const uint8_t*, uint32_t, bool);
   uint32_t (*readFile)(const char*, uint8_t*, uint32_t);
-  bool (*getFileInfo)(const char*, uint32_t&, uint32_t&, uint32_t&);
+  bool (*getFileInfo)(const char*, uint64_t&, uint64_t&, uint64_t&);
+  bool (*getFileCrc)(const char*, uint32_t&);
+  bool (*mounted)();
+  size_t (*fileCount)();
+  size_t (*visitPrefix)(const char*, UnifiedSPIMemSimpleFS::PrefixVisitor, void*);
+};
+
+// ========== VFS mount points: /flash, /psram, /nand ==========
+// Every backend stays mounted with its index resident once mounted; a path under a mount point
+// routes to its backend, so storage switches and cross-device copies cost no directory rescan.
+// The ops tables are filled by vfsInit() at boot.
+struct VfsMount {
+  const char* name;  // mount point without the leading '/'
+  const char* label;
+  StorageBackend backend;
+  bool autoFormat;  // format an empty device on mount (not PSRAM: it may hold a warm index)
+  FSIface ops;
+};
+static VfsMount g_vfs[] = {
+  { "flash", "FLASH", StorageBackend::Flash, true, {} },
+  { "psram", "PSRAM", StorageBackend::PSRAM_BACKEND, false, {} },
+  { "nand", "NAND", StorageBackend::NAND, true, {} },
 };
+static VfsMount& vfsFor(StorageBackend b) {
+  for (VfsMount& m : g_vfs)
+    if (m.backend == b) return m;
+  return g_vfs[1];
+}
+static VfsMount* vfsByName(const char* name, size_t len) {
+  for (VfsMount& m : g_vfs)
+    if (strlen(m.name) == len && !strncmp(m.name, name, len)) return &m;
+  return nullptr;
+}
+// "/flash/a/b" or "flash:/a/b" -> the flash mount, rest = "/a/b" ("" or "/" for the mount
+// root); nullptr for paths that are not under a mount point
+static VfsMount* vfsResolve(const char* path, const char*& rest) {
+  if (!path) return nullptr;
+  const char* name = path;
+  size_t len = 0;
+  const char* colon = strchr(path, ':');
+  if (colon) {
+    len = (size_t)(colon - path);
+    rest = colon + 1;
+  } else if (path[0] == '/') {
+    name = path + 1;
+    const char* slash = strchr(name, '/');
+    len = slash ? (size_t)(slash - name) : strlen(name);
+    rest = name + len;
+  } else {
+    return nullptr;
+  }
+  return vfsByName(name, len);
+}
+// Mount once; later calls reuse the resident index
+static bool vfsMount(StorageBackend b, bool autoFormat) {
+  VfsMount& m = vfsFor(b);
+  return m.ops.mount && m.ops.mount(autoFormat);
+}
 
 // Helper to get device for specific backend (used by fscp)
 static inline UnifiedSpiMem::MemDevice* deviceForBackend(StorageBackend backend) {
@@ -127,6 +196,73 @@ static inline UnifiedSpiMem::MemDevice* deviceForBackend(StorageBackend backend)
   }
 }
 
+// Advance background program/erase (MemDevice::submitAsync) on every backend
+static inline void pollStorageAsync() {
+  UnifiedSPIMemSimpleFS* vols[] = { &fsFlash.raw(), &fsNAND.raw(), &fsPSRAM.raw() };
+  for (UnifiedSPIMemSimpleFS* v : vols) v->pollAsync();
+}
+// ---- PSRAM warm reboot ----
+// The boot epoch lives in a watchdog scratch register: it survives soft and watchdog resets
+// and reads 0 after power-on, so the PSRAM index snapshot is only trusted across warm reboots.
+#ifndef PSRAM_WARM_SCRATCH
+#define PSRAM_WARM_SCRATCH 3  // scratch[0..3] are free (the boot ROM owns 4..7)
+#endif
+#ifndef PSRAM_SNAPSHOT_IDLE_MS
+#define PSRAM_SNAPSHOT_IDLE_MS 250  // refresh delay after the first write since the last save
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+#include <hardware/structs/watchdog.h>
+#endif
+static uint32_t g_bootEpoch = 0;
+static bool g_psramWarm = false;  // PSRAM FS index reused from the snapshot at boot
+static uint32_t loadBootEpoch() {
+#ifdef ARDUINO_ARCH_RP2040
+  const uint32_t TAG = 0x5E900000u;
+  uint32_t v = watchdog_hw->scratch[PSRAM_WARM_SCRATCH];
+  if ((v & 0xFFF00000u) != TAG) {
+    v = TAG | ((micros() ^ rp2040.getCycleCount()) & 0xFFFFFu);
+    watchdog_hw->scratch[PSRAM_WARM_SCRATCH] = v;
+  }
+  return v;
+#else
+  return 0;
+#endif
+}
+// Boot mount: reuse the snapshot index when it matches this epoch, else scan the directory
+static bool mountPsramFs(bool autoFormat) {
+  g_bootEpoch = loadBootEpoch();
+  g_psramWarm = fsPSRAM.raw().mountFromSnapshot(g_bootEpoch);
+  return g_psramWarm || fsPSRAM.mount(autoFormat);
+}
+static bool psramSnapshotStep() {
+  static uint32_t staleSince = 0;
+  UnifiedSPIMemSimpleFS& fs = fsPSRAM.raw();
+  if (!fs.hasIndexSnapshot() || fs.indexSnapshotCurrent()) {
+    staleSince = 0;
+    return false;
+  }
+  const uint32_t now = millis();
+  if (!staleSince) staleSince = now | 1;
+  if (now - staleSince < PSRAM_SNAPSHOT_IDLE_MS) return false;
+  staleSince = 0;
+  return fs.saveIndexSnapshot(g_bootEpoch);
+}
+// Idle work: trickle write-back cache lines out, refresh the PSRAM index snapshot,
+// keep free NOR/NAND space pre-erased
+static inline void storageIdle() {
+  if (fsPSRAM.raw().flushStep()) return;
+  if (psramSnapshotStep()) return;
+  if (fsFlash.preEraseStep()) return;
+  fsNAND.preEraseStep();
+}
+// Flush write-back caches on every backend (before reboot/backend switch)
+static inline void syncAllStorage() {
+  fsPSRAM.raw().sync();
+  if (fsPSRAM.raw().hasIndexSnapshot()) fsPSRAM.raw().saveIndexSnapshot(g_bootEpoch);
+  fsFlash.raw().sync();
+  fsNAND.raw().sync();
+}
+
 static inline UnifiedSpiMem::MemDevice* activeFsDevice() {
   switch (g_storage) {
     case StorageBackend::Flash: return fsFlash.raw().device();
@@ -135,12 +271,6 @@ static inline UnifiedSpiMem::MemDevice* activeFsDevice() {
     default: return nullptr;
   }
 }
-// Directory stride helper: 32 for NOR/PSRAM, NAND page size when on MX35
-static inline uint32_t dirEntryStride() {
-  UnifiedSpiMem::MemDevice* dev = activeFsDevice();
-  if (!dev) return 32u;
-  return (dev->type() == UnifiedSpiMem::DeviceType::SpiNandMX35) ? dev->pageSize() : 32u;
-}
 // Erase alignment helper for reserve rounding (PSRAM => fallback to 4K)
 static inline uint32_t getEraseAlign() {
   UnifiedSpiMem::MemDevice* dev = activeFsDevice();
@@ -182,6 +312,82 @@ static inline int fsReplaceModeFor(StorageBackend b) {
   return 0;
 }
 
+// ========== Tiered reads: hot NOR/NAND files mirrored into the PSRAM FS ==========
+#include "TieredFS.h"
+static TieredFS g_tier;
+static bool g_tierOn = false;
+static ActiveFS g_tierLower;  // backend bindings underneath the tier wrappers
+// Wrap activeFs (already bound to backend) so reads go through g_tier; no-op unless enabled
+static void bindTier(StorageBackend backend) {
+  g_tier.detach();
+  if (!g_tierOn || backend == StorageBackend::PSRAM_BACKEND) return;
+  if (!fsPSRAM.mount(true)) {
+    Console.println("tier: PSRAM FS unavailable; tiering off");
+    return;
+  }
+  g_tierLower = activeFs;
+  TierOps lo, up;
+  lo.getFileSize = activeFs.getFileSize;
+  lo.getFileInfo = activeFs.getFileInfo;
+  lo.getFileCrc = activeFs.getFileCrc;
+  lo.getFileGeneration = activeFs.getFileGeneration;
+  lo.readFile = activeFs.readFile;
+  lo.readFileRange = activeFs.readFileRange;
+  up.getFileSize = [](const char* n, uint64_t& s) {
+    return fsPSRAM.getFileSize(n, s);
+  };
+  up.readFileRange = [](const char* n, uint64_t off, uint8_t* b, uint32_t l) {
+    return fsPSRAM.readFileRange(n, off, b, l);
+  };
+  up.createFixedFile = [](const char* n, uint64_t s) {
+    return fsPSRAM.raw().createFixedFile(n, s);
+  };
+  up.writeFileRange = [](const char* n, uint64_t off, const uint8_t* d, uint32_t l) {
+    return fsPSRAM.writeFileRange(n, off, d, l);
+  };
+  up.deleteFile = [](const char* n) {
+    return fsPSRAM.deleteFile(n);
+  };
+  g_tier.attach(lo, up);
+  activeFs.readFile = [](const char* n, uint8_t* b, uint32_t sz) {
+    return g_tier.readFile(n, b, sz);
+  };
+  activeFs.readFileRange = [](const char* n, uint64_t off, uint8_t* b, uint32_t l) {
+    return g_tier.readFileRange(n, off, b, l);
+  };
+  activeFs.writeFile = [](const char* n, const uint8_t* d, uint32_t s, int m) {
+    bool ok = g_tierLower.writeFile(n, d, s, m);
+    if (ok) g_tier.noteWrite(n, d, s);
+    return ok;
+  };
+  activeFs.writeFileInPlace = [](const char* n, const uint8_t* d, uint32_t s, bool a) {
+    bool ok = g_tierLower.writeFileInPlace(n, d, s, a);
+    if (ok) g_tier.noteWrite(n, d, s);
+    return ok;
+  };
+  activeFs.writeFileCompressed = [](const char* n, const uint8_t* d, uint32_t s) {
+    bool ok = g_tierLower.writeFileCompressed(n, d, s);
+    if (ok) g_tier.noteWrite(n, d, s);
+    return ok;
+  };
+  activeFs.writeFileCompressedFrom = [](const char* n, uint64_t s, UnifiedSPIMemSimpleFS::ChunkSource src, void* ctx) {
+    bool ok = g_tierLower.writeFileCompressedFrom(n, s, src, ctx);
+    g_tier.invalidate(n);  // after: src may have promoted the old contents while it was read
+    return ok;
+  };
+  activeFs.writeFileRange = [](const char* n, uint64_t off, const uint8_t* d, uint32_t l) {
+    g_tier.invalidate(n);
+    return g_tierLower.writeFileRange(n, off, d, l);
+  };
+  activeFs.deleteFile = [](const char* n) {
+    g_tier.invalidate(n);
+    return g_tierLower.deleteFile(n);
+  };
+  activeFs.deletePrefix = [](const char* p, uint32_t* c) {
+    g_tier.invalidatePrefix(p);
+    return g_tierLower.deletePrefix(p, c);
+  };
+}
 static void bindActiveFs(StorageBackend backend) {
   if (backend == StorageBackend::Flash) {
     activeFs.mount = [](bool b) {
@@ -196,7 +402,7 @@ static void bindActiveFs(StorageBackend backend) {
     activeFs.exists = [](const char* n) {
       return fsFlash.exists(n);
     };
-    activeFs.createFileSlot = [](const char* n, uint32_t r, const uint8_t* d, uint32_t s) {
+    activeFs.createFileSlot = [](const char* n, uint64_t r, const uint8_t* d, uint32_t s) {
       return fsFlash.createFileSlot(n, r, d, s);
     };
     activeFs.writeFile = [](const char* n, const uint8_t* d, uint32_t s, int m) {
@@ -205,21 +411,48 @@ static void bindActiveFs(StorageBackend backend) {
     activeFs.writeFileInPlace = [](const char* n, const uint8_t* d, uint32_t s, bool a) {
       return fsFlash.writeFileInPlace(n, d, s, a);
     };
+    activeFs.writeFileRange = [](const char* n, uint64_t off, const uint8_t* d, uint32_t l) {
+      return fsFlash.writeFileRange(n, off, d, l);
+    };
+    activeFs.writeFileCompressed = [](const char* n, const uint8_t* d, uint32_t s) {
+      return fsFlash.writeFileCompressed(n, d, s);
+    };
+    activeFs.writeFileCompressedFrom = [](const char* n, uint64_t s, UnifiedSPIMemSimpleFS::ChunkSource src, void* ctx) {
+      return fsFlash.writeFileCompressedFrom(n, s, src, ctx);
+    };
+    activeFs.getStoredSize = [](const char* n, uint64_t& s, bool& z) {
+      return fsFlash.getStoredSize(n, s, z);
+    };
+    activeFs.getFileCrc = [](const char* n, uint32_t& c) {
+      return fsFlash.getFileCrc(n, c);
+    };
+    activeFs.getFileGeneration = [](const char* n, uint32_t& g) {
+      return fsFlash.getFileGeneration(n, g);
+    };
     activeFs.readFile = [](const char* n, uint8_t* b, uint32_t sz) {
       return fsFlash.readFile(n, b, sz);
     };
-    activeFs.readFileRange = [](const char* n, uint32_t off, uint8_t* b, uint32_t l) {
+    activeFs.readFileRange = [](const char* n, uint64_t off, uint8_t* b, uint32_t l) {
       return fsFlash.readFileRange(n, off, b, l);
     };
-    activeFs.getFileSize = [](const char* n, uint32_t& s) {
+    activeFs.getFileSize = [](const char* n, uint64_t& s) {
       return fsFlash.getFileSize(n, s);
     };
-    activeFs.getFileInfo = [](const char* n, uint32_t& a, uint32_t& s, uint32_t& c) {
+    activeFs.getFileInfo = [](const char* n, uint64_t& a, uint64_t& s, uint64_t& c) {
       return fsFlash.getFileInfo(n, a, s, c);
     };
     activeFs.deleteFile = [](const char* n) {
       return fsFlash.deleteFile(n);
     };
+    activeFs.deletePrefix = [](const char* p, uint32_t* c) {
+      return fsFlash.deletePrefix(p, c);
+    };
+    activeFs.visitPrefix = [](const char* p, UnifiedSPIMemSimpleFS::PrefixVisitor fn, void* ctx) {
+      return fsFlash.visitPrefix(p, fn, ctx);
+    };
+    activeFs.dirBytesUsed = []() {
+      return fsFlash.dirBytesUsed();
+    };
     activeFs.listFilesToSerial = []() {
       fsFlash.listFilesToSerial();
     };
@@ -245,7 +478,7 @@ static void bindActiveFs(StorageBackend backend) {
     activeFs.exists = [](const char* n) {
       return fsNAND.exists(n);
     };
-    activeFs.createFileSlot = [](const char* n, uint32_t r, const uint8_t* d, uint32_t s) {
+    activeFs.createFileSlot = [](const char* n, uint64_t r, const uint8_t* d, uint32_t s) {
       return fsNAND.createFileSlot(n, r, d, s);
     };
     activeFs.writeFile = [](const char* n, const uint8_t* d, uint32_t s, int m) {
@@ -254,21 +487,48 @@ static void bindActiveFs(StorageBackend backend) {
     activeFs.writeFileInPlace = [](const char* n, const uint8_t* d, uint32_t s, bool a) {
       return fsNAND.writeFileInPlace(n, d, s, a);
     };
+    activeFs.writeFileRange = [](const char* n, uint64_t off, const uint8_t* d, uint32_t l) {
+      return fsNAND.writeFileRange(n, off, d, l);
+    };
+    activeFs.writeFileCompressed = [](const char* n, const uint8_t* d, uint32_t s) {
+      return fsNAND.writeFileCompressed(n, d, s);
+    };
+    activeFs.writeFileCompressedFrom = [](const char* n, uint64_t s, UnifiedSPIMemSimpleFS::ChunkSource src, void* ctx) {
+      return fsNAND.writeFileCompressedFrom(n, s, src, ctx);
+    };
+    activeFs.getStoredSize = [](const char* n, uint64_t& s, bool& z) {
+      return fsNAND.getStoredSize(n, s, z);
+    };
+    activeFs.getFileCrc = [](const char* n, uint32_t& c) {
+      return fsNAND.getFileCrc(n, c);
+    };
+    activeFs.getFileGeneration = [](const char* n, uint32_t& g) {
+      return fsNAND.getFileGeneration(n, g);
+    };
     activeFs.readFile = [](const char* n, uint8_t* b, uint32_t sz) {
       return fsNAND.readFile(n, b, sz);
     };
-    activeFs.readFileRange = [](const char* n, uint32_t off, uint8_t* b, uint32_t l) {
+    activeFs.readFileRange = [](const char* n, uint64_t off, uint8_t* b, uint32_t l) {
       return fsNAND.readFileRange(n, off, b, l);
     };
-    activeFs.getFileSize = [](const char* n, uint32_t& s) {
+    activeFs.getFileSize = [](const char* n, uint64_t& s) {
       return fsNAND.getFileSize(n, s);
     };
-    activeFs.getFileInfo = [](const char* n, uint32_t& a, uint32_t& s, uint32_t& c) {
+    activeFs.getFileInfo = [](const char* n, uint64_t& a, uint64_t& s, uint64_t& c) {
       return fsNAND.getFileInfo(n, a, s, c);
     };
     activeFs.deleteFile = [](const char* n) {
       return fsNAND.deleteFile(n);
     };
+    activeFs.deletePrefix = [](const char* p, uint32_t* c) {
+      return fsNAND.deletePrefix(p, c);
+    };
+    activeFs.visitPrefix = [](const char* p, UnifiedSPIMemSimpleFS::PrefixVisitor fn, void* ctx) {
+      return fsNAND.visitPrefix(p, fn, ctx);
+    };
+    activeFs.dirBytesUsed = []() {
+      return fsNAND.dirBytesUsed();
+    };
     activeFs.listFilesToSerial = []() {
       fsNAND.listFilesToSerial();
     };
@@ -294,7 +554,7 @@ static void bindActiveFs(StorageBackend backend) {
     activeFs.exists = [](const char* n) {
       return fsPSRAM.exists(n);
     };
-    activeFs.createFileSlot = [](const char* n, uint32_t r, const uint8_t* d, uint32_t s) {
+    activeFs.createFileSlot = [](const char* n, uint64_t r, const uint8_t* d, uint32_t s) {
       return fsPSRAM.createFileSlot(n, r, d, s);
     };
     activeFs.writeFile = [](const char* n, const uint8_t* d, uint32_t s, int m) {
@@ -303,21 +563,48 @@ static void bindActiveFs(StorageBackend backend) {
     activeFs.writeFileInPlace = [](const char* n, const uint8_t* d, uint32_t s, bool a) {
       return fsPSRAM.writeFileInPlace(n, d, s, a);
     };
+    activeFs.writeFileRange = [](const char* n, uint64_t off, const uint8_t* d, uint32_t l) {
+      return fsPSRAM.writeFileRange(n, off, d, l);
+    };
+    activeFs.writeFileCompressed = [](const char* n, const uint8_t* d, uint32_t s) {
+      return fsPSRAM.writeFileCompressed(n, d, s);
+    };
+    activeFs.writeFileCompressedFrom = [](const char* n, uint64_t s, UnifiedSPIMemSimpleFS::ChunkSource src, void* ctx) {
+      return fsPSRAM.writeFileCompressedFrom(n, s, src, ctx);
+    };
+    activeFs.getStoredSize = [](const char* n, uint64_t& s, bool& z) {
+      return fsPSRAM.getStoredSize(n, s, z);
+    };
+    activeFs.getFileCrc = [](const char* n, uint32_t& c) {
+      return fsPSRAM.getFileCrc(n, c);
+    };
+    activeFs.getFileGeneration = [](const char* n, uint32_t& g) {
+      return fsPSRAM.getFileGeneration(n, g);
+    };
     activeFs.readFile = [](const char* n, uint8_t* b, uint32_t sz) {
       return fsPSRAM.readFile(n, b, sz);
     };
-    activeFs.readFileRange = [](const char* n, uint32_t off, uint8_t* b, uint32_t l) {
+    activeFs.readFileRange = [](const char* n, uint64_t off, uint8_t* b, uint32_t l) {
       return fsPSRAM.readFileRange(n, off, b, l);
     };
-    activeFs.getFileSize = [](const char* n, uint32_t& s) {
+    activeFs.getFileSize = [](const char* n, uint64_t& s) {
       return fsPSRAM.getFileSize(n, s);
     };
-    activeFs.getFileInfo = [](const char* n, uint32_t& a, uint32_t& s, uint32_t& c) {
+    activeFs.getFileInfo = [](const char* n, uint64_t& a, uint64_t& s, uint64_t& c) {
       return fsPSRAM.getFileInfo(n, a, s, c);
     };
     activeFs.deleteFile = [](const char* n) {
       return fsPSRAM.deleteFile(n);
     };
+    activeFs.deletePrefix = [](const char* p, uint32_t* c) {
+      return fsPSRAM.deletePrefix(p, c);
+    };
+    activeFs.visitPrefix = [](const char* p, UnifiedSPIMemSimpleFS::PrefixVisitor fn, void* ctx) {
+      return fsPSRAM.visitPrefix(p, fn, ctx);
+    };
+    activeFs.dirBytesUsed = []() {
+      return fsPSRAM.dirBytesUsed();
+    };
     activeFs.listFilesToSerial = []() {
       fsPSRAM.listFilesToSerial();
     };
@@ -331,6 +618,7 @@ static void bindActiveFs(StorageBackend backend) {
       return fsPSRAM.dataRegionStart();
     };
   }
+  bindTier(backend);
 }
 static bool makePath(char* out, size_t outCap, const char* folder, const char* name) {
   if (!out || !folder || !name) return false;
@@ -385,8 +673,8 @@ static bool writeFileToFolder(const char* folder, const char* fname, const uint8
   }
   uint32_t eraseAlign = getEraseAlign();
   if (!activeFs.exists(path)) {
-    uint32_t reserve = (len ? ((len + (eraseAlign - 1)) & ~(eraseAlign - 1)) : eraseAlign);
-    if (reserve < eraseAlign) reserve = eraseAlign;
+    // The FS rounds the slot up to the erase unit, or packs a tiny file into its record
+    uint32_t reserve = len ? len : eraseAlign;
     return activeFs.createFileSlot(path, reserve, data, len);
   }
   if (activeFs.writeFileInPlace(path, data, len, true)) return true;
@@ -467,11 +755,15 @@ static bool cmdMvImpl(const char* cwd, const char* srcArg, const char* dstArg) {
     Console.println("mv: source not found");
     return false;
   }
-  uint32_t srcAddr = 0, srcSize = 0, srcCap = 0;
+  uint64_t srcAddr = 0, srcSize = 0, srcCap = 0;
   if (!activeFs.getFileInfo(srcAbs, srcAddr, srcSize, srcCap)) {
     Console.println("mv: getFileInfo failed");
     return false;
   }
+  if (srcSize > 0xFFFFFFFFUL) {
+    Console.println("mv: file too large to copy through RAM");
+    return false;
+  }
   char dstAbs[ActiveFS::MAX_NAME + 1];
   size_t Ldst = strlen(dstArg);
   bool dstIsFolder = (Ldst > 0 && dstArg[Ldst - 1] == '/');
@@ -501,7 +793,7 @@ static bool cmdMvImpl(const char* cwd, const char* srcArg, const char* dstArg) {
     Console.println("mv: destination name too long for FS (would be truncated)");
     return false;
   }
-  uint8_t* buf = (uint8_t*)malloc(srcSize ? srcSize : 1);
+  uint8_t* buf = (uint8_t*)malloc(srcSize ? (size_t)srcSize : 1);
   if (!buf) {
     Console.println("mv: malloc failed");
     return false;
@@ -513,9 +805,9 @@ static bool cmdMvImpl(const char* cwd, const char* srcArg, const char* dstArg) {
     return false;
   }
   uint32_t eraseAlign = getEraseAlign();
-  uint32_t reserve = srcCap;
+  uint64_t reserve = srcCap;
   if (reserve < eraseAlign) {
-    uint32_t a = (srcSize + (eraseAlign - 1)) & ~(eraseAlign - 1);
+    uint64_t a = (srcSize + (eraseAlign - 1)) & ~(uint64_t)(eraseAlign - 1);
     if (a > reserve) reserve = a;
   }
   if (reserve < eraseAlign) reserve = eraseAlign;
@@ -523,7 +815,7 @@ static bool cmdMvImpl(const char* cwd, const char* srcArg, const char* dstArg) {
   if (!activeFs.exists(dstAbs)) {
     ok = activeFs.createFileSlot(dstAbs, reserve, buf, srcSize);
   } else {
-    uint32_t dA, dS, dC;
+    uint64_t dA, dS, dC;
     if (!activeFs.getFileInfo(dstAbs, dA, dS, dC)) dC = 0;
     if (dC >= srcSize) {
       ok = activeFs.writeFileInPlace(dstAbs, buf, srcSize, false);
@@ -557,11 +849,15 @@ static bool cmdCpImpl(const char* cwd, const char* srcArg, const char* dstArg, b
     Console.println("cp: source not found");
     return false;
   }
-  uint32_t srcAddr = 0, srcSize = 0, srcCap = 0;
+  uint64_t srcAddr = 0, srcSize = 0, srcCap = 0;
   if (!activeFs.getFileInfo(srcAbs, srcAddr, srcSize, srcCap)) {
     Console.println("cp: getFileInfo failed");
     return false;
   }
+  if (srcSize > 0xFFFFFFFFUL) {
+    Console.println("cp: file too large to copy through RAM");
+    return false;
+  }
   char dstAbs[ActiveFS::MAX_NAME + 1];
   size_t Ldst = strlen(dstArg);
   bool dstIsFolder = (Ldst > 0 && dstArg[Ldst - 1] == '/');
@@ -592,8 +888,16 @@ static bool cmdCpImpl(const char* cwd, const char* srcArg, const char* dstArg, b
     Console.println("cp: destination exists (use -f to overwrite)");
     return false;
   }
+  // Same stored size and content CRC: nothing to read or program
+  uint32_t sCrc = 0, dCrc = 0;
+  uint64_t dA0 = 0, dS0 = 0, dC0 = 0;
+  if (activeFs.exists(dstAbs) && activeFs.getFileCrc(srcAbs, sCrc) && activeFs.getFileCrc(dstAbs, dCrc) && sCrc == dCrc
+      && activeFs.getFileInfo(dstAbs, dA0, dS0, dC0) && dS0 == srcSize) {
+    Console.println("cp: destination identical, skipped");
+    return true;
+  }
   // Read full source (consistent with mv behavior)
-  uint8_t* buf = (uint8_t*)malloc(srcSize ? srcSize : 1);
+  uint8_t* buf = (uint8_t*)malloc(srcSize ? (size_t)srcSize : 1);
   if (!buf) {
     Console.println("cp: malloc failed");
     return false;
@@ -605,9 +909,9 @@ static bool cmdCpImpl(const char* cwd, const char* srcArg, const char* dstArg, b
     return false;
   }
   uint32_t eraseAlign = getEraseAlign();
-  uint32_t reserve = srcCap;
+  uint64_t reserve = srcCap;
   if (reserve < eraseAlign) {
-    uint32_t a = (srcSize + (eraseAlign - 1)) & ~(eraseAlign - 1);
+    uint64_t a = (srcSize + (eraseAlign - 1)) & ~(uint64_t)(eraseAlign - 1);
     if (a > reserve) reserve = a;
   }
   if (reserve < eraseAlign) reserve = eraseAlign;
@@ -616,7 +920,7 @@ static bool cmdCpImpl(const char* cwd, const char* srcArg, const char* dstArg, b
     ok = activeFs.createFileSlot(dstAbs, reserve, buf, srcSize);
   } else {
     // overwrite existing
-    uint32_t dA, dS, dC;
+    uint64_t dA, dS, dC;
     if (!activeFs.getFileInfo(dstAbs, dA, dS, dC)) dC = 0;
     if (dC >= srcSize) ok = activeFs.writeFileInPlace(dstAbs, buf, srcSize, false);
     if (!ok) ok = activeFs.writeFile(dstAbs, buf, srcSize, fsReplaceMode());
@@ -629,90 +933,37 @@ static bool cmdCpImpl(const char* cwd, const char* srcArg, const char* dstArg, b
   Console.println("cp: ok");
   return true;
 }
-static void printPct2(uint32_t num, uint32_t den) {
+static void printPct2(uint64_t num, uint64_t den) {
   if (den == 0) {
     Console.print("n/a");
     return;
   }
-  uint32_t scaled = (uint32_t)(((uint64_t)num * 10000ULL + (den / 2)) / den);
+  uint32_t scaled = (uint32_t)((num * 10000ULL + (den / 2)) / den);
   Console.printf("%lu.%02lu%%", (unsigned long)(scaled / 100), (unsigned long)(scaled % 100));
 }
-static uint32_t dirBytesUsedEstimate() {
-  UnifiedSpiMem::MemDevice* dev = activeFsDevice();
-  if (!dev) return 0;
-  constexpr uint32_t DIR_START = 0x000000;
-  constexpr uint32_t DIR_SIZE = 64 * 1024;
-  const uint32_t stride = dirEntryStride();
-  uint8_t rec[32];
-  uint32_t records = 0;
-  for (uint32_t off = 0; off + sizeof(rec) <= DIR_SIZE; off += stride) {
-    size_t got = dev->read(DIR_START + off, rec, sizeof(rec));
-    if (got != sizeof(rec)) break;
-    if (rec[0] == 0x57 && rec[1] == 0x46) {
-      records++;
-    }
-  }
-  return records * stride;
-}
-// ========== Minimal directory enumeration (reads the DIR table directly) ==========
-static inline uint32_t rd32_be(const uint8_t* p) {
-  return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | (uint32_t)p[3];
-}
-static bool isAllFF(const uint8_t* p, size_t n) {
-  for (size_t i = 0; i < n; ++i)
-    if (p[i] != 0xFF) return false;
-  return true;
-}
-static size_t buildFsIndex(FsIndexEntry* out, size_t outMax) {
-  UnifiedSpiMem::MemDevice* dev = activeFsDevice();
-  if (!dev) return 0;
-  constexpr uint32_t DIR_START = 0x000000;
-  constexpr uint32_t DIR_SIZE = 64 * 1024;
-  const uint32_t stride = dirEntryStride();
-  FsIndexEntry map[64];
-  size_t mapCount = 0;
-  uint8_t rec[32];
-  for (uint32_t off = 0; off + sizeof(rec) <= DIR_SIZE; off += stride) {
-    if (dev->read(DIR_START + off, rec, sizeof(rec)) != sizeof(rec)) break;
-    if (rec[0] != 0x57 || rec[1] != 0x46) continue;
-    uint8_t flags = rec[2];
-    uint8_t nlen = rec[3];
-    if (nlen == 0 || nlen > ActiveFS::MAX_NAME) continue;
-    char name[ActiveFS::MAX_NAME + 1];
-    memset(name, 0, sizeof(name));
-    for (uint8_t i = 0; i < nlen; ++i) name[i] = (char)rec[4 + i];
-    uint32_t size = rd32_be(&rec[24]);
-    uint32_t seq = rd32_be(&rec[28]);
-    bool deleted = (flags & 0x01) != 0;
-    int idx = -1;
-    for (size_t i = 0; i < mapCount; ++i) {
-      if (strncmp(map[i].name, name, ActiveFS::MAX_NAME) == 0) {
-        idx = (int)i;
-        break;
-      }
-    }
-    if (idx < 0) {
-      if (mapCount >= 64) continue;
-      idx = (int)mapCount++;
-      strncpy(map[idx].name, name, ActiveFS::MAX_NAME);
-      map[idx].name[ActiveFS::MAX_NAME] = 0;
-      map[idx].seq = 0;
-    }
-    if (seq >= map[idx].seq) {
-      map[idx].seq = seq;
-      map[idx].deleted = deleted;
-      map[idx].size = size;
-    }
-  }
-  if (out && outMax) {
-    size_t n = (mapCount < outMax) ? mapCount : outMax;
-    for (size_t i = 0; i < n; ++i) out[i] = map[i];
+// ========== Folder listing (in-memory index, name order) ==========
+// ls: direct children of a folder prefix; deeper names collapse into their first segment, which
+// arrives as one run because the index walks in name order
+struct LsWalk {
+  size_t folderLen;
+  char lastSeg[ActiveFS::MAX_NAME + 1];
+};
+static bool lsVisit(void* ctx, const char* name, uint64_t size) {
+  LsWalk& w = *(LsWalk*)ctx;
+  const char* rest = name + w.folderLen;
+  if (*rest == '/') ++rest;
+  if (*rest == 0) return true;  // the folder marker itself
+  const char* slash = strchr(rest, '/');
+  if (!slash) {
+    Console.printf("  %s  (%llu bytes)\n", rest, (unsigned long long)size);
+    return true;
   }
-  return mapCount;
-}
-static bool hasPrefix(const char* name, const char* prefix) {
-  size_t lp = strlen(prefix);
-  return strncmp(name, prefix, lp) == 0;
+  const size_t segLen = (size_t)(slash - rest);
+  if (segLen == 0 || (strlen(w.lastSeg) == segLen && !strncmp(w.lastSeg, rest, segLen))) return true;
+  memcpy(w.lastSeg, rest, segLen);
+  w.lastSeg[segLen] = 0;
+  Console.printf("  %s/\n", w.lastSeg);
+  return true;
 }
 static bool childOfFolder(const char* name, const char* folderPrefix, const char*& childOut) {
   size_t lp = strlen(folderPrefix);
@@ -745,6 +996,371 @@ static void dumpDirHeadRaw(uint32_t bytes = 256) {
     Console.println();
   }
 }
+static UnifiedSPIMemSimpleFS* activeFsCore() {
+  switch (g_storage) {
+    case StorageBackend::Flash: return &fsFlash.raw();
+    case StorageBackend::PSRAM_BACKEND: return &fsPSRAM.raw();
+    case StorageBackend::NAND: return &fsNAND.raw();
+    default: return nullptr;
+  }
+}
+// Per-sector write outcomes of the active FS (erases avoided by pre-erase/bit-clear)
+static void cmdFsStats(bool reset) {
+  UnifiedSPIMemSimpleFS* core = activeFsCore();
+  UnifiedSpiMem::MemDevice* dev = activeFsDevice();
+  if (!core || !dev) {
+    Console.println("fsstats: no active FS");
+    return;
+  }
+  const auto& st = core->writeStats();
+  const uint32_t total = st.sectorsProgrammed + st.sectorsBitClear + st.sectorsUnchanged + st.sectorsErased;
+  Console.printf("Write stats (%s, per erase unit):\n", UnifiedSpiMem::deviceTypeName(dev->type()));
+  Console.printf("  programmed (pre-erased): %lu\n", (unsigned long)st.sectorsProgrammed);
+  Console.printf("  bit-clear in place:      %lu\n", (unsigned long)st.sectorsBitClear);
+  Console.printf("  unchanged (skipped):     %lu\n", (unsigned long)st.sectorsUnchanged);
+  Console.printf("  erased before program:   %lu\n", (unsigned long)st.sectorsErased);
+  Console.printf("  files unchanged:         %lu\n", (unsigned long)st.filesUnchanged);
+  Console.print("  erases avoided:          ");
+  printPct2(total - st.sectorsErased, total);
+  Console.println();
+  static const char* const kPolicy[] = { "off", "write-through", "write-back" };
+  const auto& cs = core->cacheStats();
+  Console.printf("Cache (%s): hits=%lu misses=%lu bypass=%lu writebacks=%lu  hit rate ", kPolicy[(int)core->cachePolicy()],
+                 (unsigned long)cs.hits, (unsigned long)cs.misses, (unsigned long)cs.bypass, (unsigned long)cs.writebacks);
+  printPct2(cs.hits, cs.hits + cs.misses);
+  Console.println();
+  Console.printf("Read-ahead: hits=%lu fills=%lu\n", (unsigned long)cs.raHits, (unsigned long)cs.raFills);
+  if (core->layoutVersion())
+    Console.printf("Layout: superblock v%u, directory %lu bytes, data at 0x%08lX\n", (unsigned)core->layoutVersion(), (unsigned long)core->dirSize(),
+                   (unsigned long)core->dataRegionStart());
+  else
+    Console.printf("Layout: legacy (no superblock), directory %lu bytes; format would use %lu\n", (unsigned long)core->dirSize(),
+                   (unsigned long)core->plannedDirSize());
+  if (core->durableSnapshot())
+    Console.printf("Index snapshot: durable, %lu record(s) since save, %lu replayed at mount\n", (unsigned long)core->recordsSinceSnapshot(),
+                   (unsigned long)core->snapshotReplayed());
+  else if (core->hasIndexSnapshot())
+    Console.printf("Index snapshot: %s (epoch %08lx, %s boot)\n", core->indexSnapshotCurrent() ? "current" : "stale", (unsigned long)g_bootEpoch,
+                   g_psramWarm ? "warm" : "cold");
+  if (reset) {
+    core->resetWriteStats();
+    core->resetCacheStats();
+    Console.println("fsstats: counters reset");
+  }
+}
+static void cmdCache(const char* mode) {
+  UnifiedSPIMemSimpleFS* core = activeFsCore();
+  if (!core) {
+    Console.println("cache: no active FS");
+    return;
+  }
+  using CP = UnifiedMemFSDriver::CachePolicy;
+  if (!strcmp(mode, "off")) core->setCachePolicy(CP::Off);
+  else if (!strcmp(mode, "wt")) core->setCachePolicy(CP::WriteThrough);
+  else if (!strcmp(mode, "wb")) core->setCachePolicy(CP::WriteBack);
+  else if (!strcmp(mode, "sync")) core->sync();
+  else {
+    Console.println("usage: cache [off|wt|wb|sync]");
+    return;
+  }
+  if (!strcmp(mode, "wb") && core->cachePolicy() != CP::WriteBack) Console.println("cache: write-back is PSRAM-only; using write-through");
+  Console.println("cache: OK");
+}
+// ========== Key/value store (config, counters) on the active FS ==========
+#include "KVStore.h"
+static KVStore g_kv;
+// Bind the store to the active backend (re-opened after a backend switch or format).
+// Only writers pass create: reads never allocate the slot.
+static KVStore* kvOpen(bool create) {
+  UnifiedSPIMemSimpleFS* core = activeFsCore();
+  if (!core) return nullptr;
+  if (g_kv.bound(*core) || g_kv.begin(*core, create)) return &g_kv;
+  return nullptr;
+}
+static bool kvPrintKey(void*, const char* key, uint16_t vlen) {
+  Console.printf("  %-32s %u bytes\n", key, (unsigned)vlen);
+  return true;
+}
+static void cmdKv(const char* sub, const char* key, const char* val) {
+  if (!sub) {
+    Console.println("usage: kv [put <key> <value>|get <key>|del <key>|ls|stats|compact]");
+    return;
+  }
+  KVStore* kv = kvOpen(!strcmp(sub, "put"));
+  if (!kv) {
+    UnifiedSPIMemSimpleFS* core = activeFsCore();
+    if (core && core->canUpdateInPlace() && !core->exists(KVSTORE_SLOT)) Console.println("kv: empty (kv put creates the store)");
+    else Console.println("kv: unavailable (needs NOR or PSRAM as active storage)");
+    return;
+  }
+  if (!strcmp(sub, "put") && key) {
+    const size_t n = val ? strlen(val) : 0;
+    Console.println(n <= KVSTORE_VALUE_MAX && kv->put(key, val, (uint16_t)n) ? "kv: OK" : "kv: put failed");
+  } else if (!strcmp(sub, "get") && key) {
+    static uint8_t buf[KVSTORE_VALUE_MAX];
+    uint16_t n = 0;
+    if (!kv->get(key, buf, sizeof(buf), n)) {
+      Console.println("kv: not found");
+      return;
+    }
+    bool text = true;
+    for (uint16_t i = 0; i < n; ++i) text = text && buf[i] >= 0x20 && buf[i] < 0x7F;
+    for (uint16_t i = 0; i < n; ++i) {
+      if (text) {
+        Console.print((char)buf[i]);
+        continue;
+      }
+      if (i) Console.print(' ');
+      if (buf[i] < 0x10) Console.print('0');
+      Console.print(buf[i], HEX);
+    }
+    Console.println();
+  } else if (!strcmp(sub, "del") && key) {
+    Console.println(kv->del(key) ? "kv: OK" : "kv: not found");
+  } else if (!strcmp(sub, "ls")) {
+    kv->iter(&kvPrintKey, nullptr);
+  } else if (!strcmp(sub, "compact")) {
+    Console.println(kv->compact() ? "kv: OK" : "kv: compact failed");
+  } else if (!strcmp(sub, "stats")) {
+    const auto& st = kv->stats();
+    Console.printf("KV: keys=%u used=%lu free=%lu gen=%lu\n", (unsigned)kv->count(), (unsigned long)kv->usedBytes(), (unsigned long)kv->freeBytes(),
+                   (unsigned long)kv->generation());
+    Console.printf("  puts=%lu unchanged=%lu dels=%lu compactions=%lu skipped=%lu\n", (unsigned long)st.puts, (unsigned long)st.unchanged,
+                   (unsigned long)st.dels, (unsigned long)st.compactions, (unsigned long)st.skipped);
+  } else {
+    Console.println("usage: kv [put <key> <value>|get <key>|del <key>|ls|stats|compact]");
+  }
+}
+// ========== Ring log files (sequence-stamped records, erase-ahead) ==========
+#include "RingFile.h"
+static RingFile g_ring;
+// Open name on the active backend, reusing the open ring when it is the same file
+static RingFile* ringOpen(const char* name) {
+  UnifiedSPIMemSimpleFS* core = activeFsCore();
+  if (!core) return nullptr;
+  if (g_ring.isOpen() && !strcmp(g_ring.name(), name) && core->exists(name)) return &g_ring;
+  return g_ring.open(*core, name) ? &g_ring : nullptr;
+}
+// p: rest of the line (sizes for create, text for append, count for dump)
+static void cmdRing(const char* sub, const char* name, char* p) {
+  if (sub && name && !strcmp(sub, "create")) {
+    UnifiedSPIMemSimpleFS* core = activeFsCore();
+    char* end = nullptr;
+    const uint32_t bytes = strtoul(p, &end, 0);
+    const uint32_t rec = strtoul(end, nullptr, 0);
+    if (!bytes || !rec || rec > 0xFFFF) {
+      Console.println("usage: ring create <name> <bytes> <recordSize>");
+      return;
+    }
+    if (!core || !RingFile::create(*core, name, bytes, (uint16_t)rec)) {
+      Console.println("ring: create failed (needs NOR or PSRAM; record must fit a sector)");
+      return;
+    }
+    g_ring = RingFile();
+    Console.println("ring: OK");
+    return;
+  }
+  if (!sub || !name || (strcmp(sub, "append") && strcmp(sub, "dump") && strcmp(sub, "stat"))) {
+    Console.println("usage: ring [create <name> <bytes> <recordSize>|append <name> <text>|dump <name> [n]|stat <name>]");
+    return;
+  }
+  RingFile* r = ringOpen(name);
+  if (!r) {
+    Console.println("ring: open failed");
+    return;
+  }
+  if (!strcmp(sub, "append")) {
+    while (*p == ' ' || *p == '\t') ++p;
+    size_t n = strlen(p);
+    while (n && (p[n - 1] == '\r' || p[n - 1] == '\n')) p[--n] = 0;
+    if (n > r->recordSize()) n = r->recordSize();
+    Console.println(r->append(p, (uint16_t)n) ? "ring: OK" : "ring: append failed");
+  } else if (!strcmp(sub, "dump")) {
+    uint32_t want = strtoul(p, nullptr, 0);
+    if (!want) want = 16;
+    uint32_t from = r->tail();
+    if (r->head() - from > want) from = r->head() - want;
+    uint8_t* rec = (uint8_t*)malloc(r->recordSize());
+    if (!rec) {
+      Console.println("ring: out of memory");
+      return;
+    }
+    for (uint32_t s = from; s < r->head(); ++s) {
+      Console.printf("  %8lu  ", (unsigned long)s);
+      if (!r->read(s, rec)) {
+        Console.println("(torn)");
+        continue;
+      }
+      uint16_t n = r->recordSize();
+      while (n && rec[n - 1] == 0) --n;
+      for (uint16_t i = 0; i < n; ++i) Console.print(rec[i] >= 0x20 && rec[i] < 0x7F ? (char)rec[i] : '.');
+      Console.println();
+    }
+    free(rec);
+  } else {
+    const auto& st = r->stats();
+    Console.printf("Ring %s: head=%lu tail=%lu record=%u bytes  %lu x %lu-byte sectors (%lu records)\n", r->name(), (unsigned long)r->head(),
+                   (unsigned long)r->tail(), (unsigned)r->recordSize(), (unsigned long)r->sectors(), (unsigned long)r->sectorBytes(),
+                   (unsigned long)r->capacityRecords());
+    Console.printf("  appends=%lu sectors=%lu torn=%lu open-probes=%lu\n", (unsigned long)st.appends, (unsigned long)st.sectors, (unsigned long)st.torn,
+                   (unsigned long)st.probes);
+  }
+}
+// ========== B+tree volume for large file counts ==========
+#include "BTreeFS.h"
+static BTreeFS g_bt;
+static BTreeFS* btOpen() {
+  UnifiedSPIMemSimpleFS* core = activeFsCore();
+  if (!core) return nullptr;
+  if (g_bt.bound(*core) || g_bt.begin(*core)) return &g_bt;
+  return nullptr;
+}
+static bool btPrintFile(void*, const char* name, uint32_t size) {
+  Console.printf("  %-32s %lu\n", name, (unsigned long)size);
+  return true;
+}
+// p: rest of the line (bytes for format, text for put, count for fill)
+static void cmdBt(const char* sub, const char* name, char* p) {
+  if (sub && !strcmp(sub, "format")) {
+    UnifiedSPIMemSimpleFS* core = activeFsCore();
+    const uint32_t bytes = name ? (uint32_t)strtoul(name, nullptr, 0) : 0;
+    if (!bytes) {
+      Console.println("usage: bt format <bytes>");
+      return;
+    }
+    Console.println(core && BTreeFS::format(*core, bytes) ? "bt: OK" : "bt: format failed (exists or no room)");
+    return;
+  }
+  const bool needName = sub && (!strcmp(sub, "put") || !strcmp(sub, "cat") || !strcmp(sub, "rm"));
+  if (!sub || (needName && !name)) {
+    Console.println("usage: bt [format <bytes>|put <name> <text>|cat <name>|rm <name>|ls|stat|fill <n>|compact]");
+    return;
+  }
+  BTreeFS* bt = btOpen();
+  if (!bt) {
+    Console.println("bt: no volume on the active storage (bt format <bytes>)");
+    return;
+  }
+  if (!strcmp(sub, "put")) {
+    while (*p == ' ' || *p == '\t') ++p;
+    size_t n = strlen(p);
+    while (n && (p[n - 1] == '\r' || p[n - 1] == '\n')) p[--n] = 0;
+    Console.println(bt->writeFile(name, (const uint8_t*)p, (uint32_t)n) ? "bt: OK" : "bt: write failed");
+  } else if (!strcmp(sub, "cat")) {
+    uint8_t buf[64];
+    uint32_t size = 0;
+    if (!bt->getFileSize(name, size)) {
+      Console.println("bt: not found");
+      return;
+    }
+    for (uint32_t off = 0; off < size;) {
+      const uint32_t n = bt->readFileRange(name, off, buf, sizeof(buf));
+      if (!n) break;
+      Console.write(buf, n);
+      off += n;
+    }
+    Console.println();
+  } else if (!strcmp(sub, "rm")) {
+    Console.println(bt->deleteFile(name) ? "bt: OK" : "bt: not found");
+  } else if (!strcmp(sub, "ls")) {
+    bt->iter(&btPrintFile, nullptr);
+  } else if (!strcmp(sub, "compact")) {
+    Console.println(bt->compact() ? "bt: OK" : "bt: compact failed");
+  } else if (!strcmp(sub, "fill")) {
+    // Populate n small files, then time lookups (device reads per lookup ~ tree height)
+    const uint32_t n = name ? (uint32_t)strtoul(name, nullptr, 0) : 0;
+    char fn[24];
+    uint32_t t0 = millis(), done = 0;
+    for (; done < n; ++done) {
+      snprintf(fn, sizeof(fn), "f%06lu", (unsigned long)done);
+      if (!bt->writeFile(fn, (const uint8_t*)fn, strlen(fn))) break;
+      if ((done & 63) == 0) yield();
+    }
+    const uint32_t tw = millis() - t0;
+    bt->resetStats();
+    t0 = micros();
+    for (uint32_t i = 0; i < done; i += (done / 64) + 1) {
+      snprintf(fn, sizeof(fn), "f%06lu", (unsigned long)i);
+      bt->exists(fn);
+    }
+    const uint32_t tl = micros() - t0;
+    const auto& st = bt->stats();
+    Console.printf("bt fill: %lu files in %lu ms; %lu lookups, %lu node reads, %lu us\n", (unsigned long)done, (unsigned long)tw, (unsigned long)st.lookups,
+                   (unsigned long)st.nodeReads, (unsigned long)tl);
+  } else if (!strcmp(sub, "stat")) {
+    const auto& st = bt->stats();
+    Console.printf("B+tree volume: files=%lu height=%u node=%lu used=%lu/%lu bytes\n", (unsigned long)bt->fileCount(), (unsigned)bt->height(),
+                   (unsigned long)bt->nodeBytes(), (unsigned long)bt->usedBytes(), (unsigned long)bt->halfBytes());
+    Console.printf("  lookups=%lu node-reads=%lu node-writes=%lu commits=%lu compactions=%lu\n", (unsigned long)st.lookups, (unsigned long)st.nodeReads,
+                   (unsigned long)st.nodeWrites, (unsigned long)st.commits, (unsigned long)st.compactions);
+  } else {
+    Console.println("usage: bt [format <bytes>|put <name> <text>|cat <name>|rm <name>|ls|stat|fill <n>|compact]");
+  }
+}
+// ========== PSRAM FS checkpoint image on flash/NAND ==========
+#include "FSCheckpoint.h"
+static UnifiedSPIMemSimpleFS* checkpointImageFs(const char* which) {
+  if (!which || !strcmp(which, "flash")) return vfsMount(StorageBackend::Flash, true) ? &fsFlash.raw() : nullptr;
+  if (!strcmp(which, "nand")) return vfsMount(StorageBackend::NAND, true) ? &fsNAND.raw() : nullptr;
+  return nullptr;
+}
+static void printCheckpointStats(const char* tag, bool ok, const FSCheckpoint::Stats& st) {
+  Console.printf("%s: %s  files=%lu unchanged=%lu patched=%lu copied=%lu deleted=%lu skipped=%lu failed=%lu  %lu bytes in %lu ms\n", tag,
+                 ok ? "ok" : "incomplete", (unsigned long)st.files, (unsigned long)st.unchanged, (unsigned long)st.patched, (unsigned long)st.copied,
+                 (unsigned long)st.deleted, (unsigned long)st.skipped, (unsigned long)st.failed, (unsigned long)st.bytes, (unsigned long)st.ms);
+}
+static void cmdCheckpoint(bool restore, const char* which) {
+  const char* tag = restore ? "restore" : "checkpoint";
+  UnifiedSPIMemSimpleFS* img = checkpointImageFs(which);
+  if (!img) {
+    Console.printf("%s: image FS (%s) unavailable\n", tag, which ? which : "flash");
+    return;
+  }
+  if (!vfsMount(StorageBackend::PSRAM_BACKEND, restore)) {
+    Console.printf("%s: PSRAM FS mount failed\n", tag);
+    return;
+  }
+  FSCheckpoint::Stats st;
+  bool ok = restore ? FSCheckpoint::restore(*img, fsPSRAM.raw(), st) : FSCheckpoint::save(fsPSRAM.raw(), *img, st);
+  printCheckpointStats(tag, ok, st);
+}
+static void updateExecFsTable();
+static void cmdTier(const char* sub, const char* arg) {
+  if (sub && (!strcmp(sub, "on") || !strcmp(sub, "off"))) {
+    g_tierOn = !strcmp(sub, "on");
+    bindActiveFs(g_storage);
+    updateExecFsTable();
+    if (g_tierOn && g_storage == StorageBackend::PSRAM_BACKEND) Console.println("tier: active storage is PSRAM; takes effect on flash/nand");
+    Console.println(g_tier.attached() ? "tier: on" : "tier: off");
+    return;
+  }
+  if (sub && !strcmp(sub, "budget")) {
+    if (!arg) {
+      Console.println("usage: tier budget <bytes>");
+      return;
+    }
+    g_tier.setBudget((uint32_t)strtoul(arg, nullptr, 0));
+  } else if (sub && !strcmp(sub, "reset")) {
+    g_tier.reset();
+    g_tier.resetStats();
+  } else if (sub && strcmp(sub, "stats")) {
+    Console.println("usage: tier [on|off|stats|reset|budget <bytes>]");
+    return;
+  }
+  const auto& st = g_tier.stats();
+  Console.printf("Tier: %s  budget=%lu used=%lu\n", g_tier.attached() ? "on" : (g_tierOn ? "on (idle: PSRAM active)" : "off"), (unsigned long)g_tier.budget(),
+                 (unsigned long)g_tier.usedBytes());
+  Console.printf("  reads=%lu psram=%lu promotions=%lu evictions=%lu invalidations=%lu fails=%lu write-through=%lu  hit rate ", (unsigned long)st.reads,
+                 (unsigned long)st.upperHits, (unsigned long)st.promotions, (unsigned long)st.evictions, (unsigned long)st.invalidations,
+                 (unsigned long)st.promoteFails, (unsigned long)st.writeThrough);
+  printPct2(st.upperHits, st.reads);
+  Console.println();
+  for (uint8_t i = 0; i < g_tier.capacity(); ++i) {
+    const TieredFS::Entry& e = g_tier.entry(i);
+    if (!e.used) continue;
+    Console.printf("  %-32s reads=%-6lu hits=%-6lu %s\n", e.name, (unsigned long)e.reads, (unsigned long)e.hits, e.mirrored ? "psram" : "-");
+  }
+}
 static void cmdDf() {
   UnifiedSpiMem::MemDevice* dev = activeFsDevice();
   if (dev) {
@@ -753,22 +1369,22 @@ static void cmdDf() {
     const uint8_t cs = dev->cs();
     const uint64_t devCap = dev->capacity();
     const uint32_t dataStart = activeFs.dataRegionStart();
-    const uint32_t fsCap32 = activeFs.capacity();
-    const uint32_t dataCap = (fsCap32 > dataStart) ? (fsCap32 - dataStart) : 0;
-    const uint32_t dataUsed = (activeFs.nextDataAddr() > dataStart) ? (activeFs.nextDataAddr() - dataStart) : 0;
-    const uint32_t dataFree = (dataCap > dataUsed) ? (dataCap - dataUsed) : 0;
-    const uint32_t dirUsed = dirBytesUsedEstimate();
-    const uint32_t dirFree = (64u * 1024u > dirUsed) ? (64u * 1024u - dirUsed) : 0;
+    const uint64_t fsCap = activeFs.capacity();
+    const uint64_t dataCap = (fsCap > dataStart) ? (fsCap - dataStart) : 0;
+    const uint64_t dataUsed = (activeFs.nextDataAddr() > dataStart) ? (activeFs.nextDataAddr() - dataStart) : 0;
+    const uint64_t dataFree = (dataCap > dataUsed) ? (dataCap - dataUsed) : 0;
+    const uint32_t dirUsed = activeFs.dirBytesUsed();
+    const uint32_t dirFree = (dataStart > dirUsed) ? (dataStart - dirUsed) : 0;  // directory spans [0, dataStart)
     Console.println("Filesystem (active):");
     Console.printf("  Device:  %s  CS=%u\n", style, (unsigned)cs);
     Console.printf("  DevCap:  %llu bytes\n", (unsigned long long)devCap);
-    Console.printf("  FS data: %lu used (", (unsigned long)dataUsed);
+    Console.printf("  FS data: %llu used (", (unsigned long long)dataUsed);
     printPct2(dataUsed, dataCap);
-    Console.printf(")  %lu free (", (unsigned long)dataFree);
+    Console.printf(")  %llu free (", (unsigned long long)dataFree);
     printPct2(dataFree, dataCap);
     Console.println(")");
     Console.printf("  DIR:     %lu used (", (unsigned long)dirUsed);
-    printPct2(dirUsed, 64u * 1024u);
+    printPct2(dirUsed, dataStart);
     Console.printf(")  %lu free\n", (unsigned long)dirFree);
   } else {
     Console.println("Filesystem (active): none");
@@ -875,18 +1491,22 @@ extern "C" __scratch_x("blob_mailbox") __attribute__((aligned(4)))
 int8_t BLOB_MAILBOX[BLOB_MAILBOX_MAX] = { 0 };
 // ================= ExecHost header =================
 #include "ExecHost.h"
+#include "FileView.h"
 static ExecHost Exec;
 // ================= FSHelpers header =================
 static void updateExecFsTable() {
+  // Volume bindings only: the tier wrappers share g_tier (unsynchronized) with the console.
+  // Writes that bypass the tier are caught by its identity check on the next read.
+  const ActiveFS& fs = g_tier.attached() ? g_tierLower : activeFs;
   ExecFSTable t{};
-  t.exists = activeFs.exists;
-  t.getFileSize = activeFs.getFileSize;
-  t.readFile = activeFs.readFile;
-  t.readFileRange = activeFs.readFileRange;
-  t.createFileSlot = activeFs.createFileSlot;
-  t.writeFile = activeFs.writeFile;
-  t.writeFileInPlace = activeFs.writeFileInPlace;
-  t.getFileInfo = activeFs.getFileInfo;
+  t.exists = fs.exists;
+  t.getFileSize = fs.getFileSize;
+  t.readFile = fs.readFile;
+  t.readFileRange = fs.readFileRange;
+  t.createFileSlot = fs.createFileSlot;
+  t.writeFile = fs.writeFile;
+  t.writeFileInPlace = fs.writeFileInPlace;
+  t.getFileInfo = fs.getFileInfo;
   //t.deleteFile = activeFs.deleteFile;
   Exec.attachFS(t);
 }
@@ -957,41 +1577,180 @@ static const BlobReg* findBlob(const char* id) {
     if (strcmp(g_blobs[i].id, id) == 0) return &g_blobs[i];
   return nullptr;
 }
-static void dumpFileHead(const char* fname, uint32_t count) {
+// Rewrite an existing file as a compressed stream (reads decompress transparently). The old
+// contents stay indexed until the new record lands, so they are streamed from the file itself.
+static bool compressPull(void* ctx, uint64_t off, uint8_t* buf, uint32_t len) {
+  return activeFs.readFileRange((const char*)ctx, off, buf, len) == len;
+}
+static void cmdCompress(const char* fname) {
   uint32_t sz = 0;
-  if (!activeFs.getFileSize(fname, sz) || sz == 0) {
+  if (!activeFileSize32(fname, sz) || sz == 0) {
+    Console.println("compress: missing/empty");
+    return;
+  }
+  bool ok = activeFs.writeFileCompressedFrom(fname, sz, &compressPull, (void*)fname);
+  uint64_t stored = 0;
+  bool z = false;
+  if (!ok || !activeFs.getStoredSize(fname, stored, z)) {
+    Console.println("compress: failed");
+    return;
+  }
+  if (!z) Console.printf("compress: %s does not shrink; kept plain (%llu bytes)\n", fname, (unsigned long long)stored);
+  else Console.printf("compress: %s %lu -> %llu bytes\n", fname, (unsigned long)sz, (unsigned long long)stored);
+}
+// Codec benchmark: ratio and RAM-to-RAM throughput (no device I/O)
+struct ZBenchSink {
+  uint8_t* p;
+  uint32_t n, cap;
+  static bool put(void* ctx, const uint8_t* d, size_t k) {
+    ZBenchSink* s = static_cast<ZBenchSink*>(ctx);
+    if (s->n + k > s->cap) return false;
+    memcpy(s->p + s->n, d, k);
+    s->n += k;
+    return true;
+  }
+};
+static void zbenchOne(const char* label, const uint8_t* data, uint32_t len) {
+  static UnifiedFSLz::Decoder dec;  // 1 KiB window, keep it off the stack
+  uint32_t cap = len + len / 8 + 16;
+  uint8_t* z = (uint8_t*)malloc(cap);
+  uint8_t* out = (uint8_t*)malloc(len ? len : 1);
+  if (!z || !out) {
+    Console.printf("  %-14s malloc failed\n", label);
+    free(z);
+    free(out);
+    return;
+  }
+  ZBenchSink sink = { z, 0, cap };
+  uint32_t t0 = micros();
+  bool ok = UnifiedFSLz::compress(data, len, &ZBenchSink::put, &sink);
+  uint32_t tc = micros() - t0;
+  UnifiedFSLz::MemSource src = { z, sink.n };
+  dec.reset();
+  t0 = micros();
+  ok = ok && dec.decode(out, len, src) == len;
+  uint32_t td = micros() - t0;
+  ok = ok && memcmp(out, data, len) == 0;
+  uint32_t stored = sink.n + UnifiedFSLz::HEADER_SIZE;
+  uint32_t ratio100 = stored ? (uint32_t)((uint64_t)len * 100 / stored) : 0;
+  Console.printf("  %-14s raw=%6lu z=%6lu  %lu.%02lux  comp=%4lu KB/s  decomp=%4lu KB/s%s\n", label, (unsigned long)len, (unsigned long)stored,
+                 (unsigned long)(ratio100 / 100), (unsigned long)(ratio100 % 100),
+                 (unsigned long)(tc ? (uint64_t)len * 1000000ULL / tc / 1024 : 0), (unsigned long)(td ? (uint64_t)len * 1000000ULL / td / 1024 : 0),
+                 ok ? "" : "  VERIFY FAILED");
+  free(z);
+  free(out);
+}
+static void cmdZBench(const char* fname) {
+  Console.println("zbench: LZSS (1 KiB window), RAM to RAM");
+  if (!fname) {
+    for (size_t i = 0; i < g_blobs_count; ++i) {
+      zbenchOne(g_blobs[i].id, g_blobs[i].data, g_blobs[i].len);
+      yield();
+    }
+    return;
+  }
+  uint32_t sz = 0;
+  if (!activeFileSize32(fname, sz) || sz == 0) {
+    Console.println("zbench: missing/empty");
+    return;
+  }
+  uint8_t* buf = (uint8_t*)malloc(sz);
+  if (!buf) {
+    Console.println("zbench: malloc failed");
+    return;
+  }
+  if (activeFs.readFile(fname, buf, sz) == sz) zbenchOne(fname, buf, sz);
+  else Console.println("zbench: read failed");
+  free(buf);
+}
+// Recompute a file's CRC-32 from the device and compare it with the one stored at write time
+static void cmdSum(const char* fname) {
+  uint64_t sz = 0;
+  if (!activeFs.getFileSize(fname, sz)) {
+    Console.println("sum: not found");
+    return;
+  }
+  static uint8_t buf[512];
+  CRC32Fast::Crc32 crc;
+  uint64_t off = 0;
+  while (off < sz) {
+    uint32_t n = (uint32_t)min<uint64_t>(sizeof(buf), sz - off);
+    if (activeFs.readFileRange(fname, off, buf, n) != n) {
+      Console.println("sum: read failed");
+      return;
+    }
+    crc.update(buf, n);
+    off += n;
+  }
+  uint32_t stored = 0;
+  Console.printf("sum: %s %llu bytes crc32=0x%08lX", fname, (unsigned long long)sz, (unsigned long)crc.value());
+  if (!activeFs.getFileCrc || !activeFs.getFileCrc(fname, stored)) Console.println(" (no stored crc)");
+  else if (stored == crc.value()) Console.println(" OK");
+  else Console.printf(" MISMATCH stored=0x%08lX\n", (unsigned long)stored);
+}
+// CRC-32 throughput: bit loop vs table vs the update() path (DMA sniffer when available)
+static void cmdCrcBench(uint32_t len) {
+  if (len == 0) len = 16384;
+  uint8_t* buf = (uint8_t*)malloc(len);
+  if (!buf) {
+    Console.println("crcbench: malloc failed");
+    return;
+  }
+  for (uint32_t i = 0; i < len; ++i) buf[i] = (uint8_t)(i * 131u + (i >> 7));
+  Console.printf("crcbench: %lu bytes, %d-slice tables, DMA %s\n", (unsigned long)len, CRC32FAST_SLICES, CRC32Fast::dmaActive() ? "on" : "off");
+  uint32_t ref = 0;
+  for (int m = 0; m < 3; ++m) {
+    static const char* const names[3] = { "bitwise", "table", "update" };
+    uint32_t t0 = micros();
+    uint32_t st = CRC32Fast::begin();
+    if (m == 0) st = CRC32Fast::bitwise(st, buf, len);
+    else if (m == 1) st = CRC32Fast::software(st, buf, len);
+    else st = CRC32Fast::update(st, buf, len);
+    uint32_t dt = micros() - t0;
+    uint32_t crc = CRC32Fast::finish(st);
+    if (m == 0) ref = crc;
+    Console.printf("  %-8s %6lu us  %5lu KB/s  0x%08lX%s\n", names[m], (unsigned long)dt,
+                   (unsigned long)(dt ? (uint64_t)len * 1000000ULL / dt / 1024 : 0), (unsigned long)crc, crc == ref ? "" : "  MISMATCH");
+    yield();
+  }
+  free(buf);
+}
+static void dumpFileHead(const char* fname, uint32_t count, uint32_t start = 0) {
+  static FileView<> view;  // paged: any offset of a large file without loading it
+  if (!view.open(fname, activeFs.getFileSize, activeFs.readFileRange) || view.size() == 0) {
     Console.println("dump: missing/empty");
     return;
   }
-  if (count > sz) count = sz;
-  const size_t CHUNK = 32;
-  uint8_t buf[CHUNK];
-  uint32_t off = 0;
+  uint64_t sz = view.size();
+  if (start >= sz) {
+    Console.println("dump: offset past end");
+    return;
+  }
+  if (count > sz - start) count = (uint32_t)(sz - start);
+  const uint32_t CHUNK = 32;
+  uint32_t off = start;
   Console.print(fname);
   Console.print(" size=");
-  Console.println(sz);
-  while (off < count) {
-    size_t n = (count - off > CHUNK) ? CHUNK : (count - off);
-    uint32_t got = activeFs.readFileRange(fname, off, buf, n);
-    if (got != n) {
+  Console.println((unsigned long long)sz);
+  while (off < start + count) {
+    uint32_t n = (start + count - off > CHUNK) ? CHUNK : (start + count - off);
+    const uint8_t* row = view.span(off, n);  // rows are cut short at page boundaries
+    if (!row) {
       Console.println("  read error");
       break;
     }
-    Console.print("  ");
-    for (size_t i = 0; i < n; ++i) {
-      if (i) Console.print(' ');
-      if (buf[i] < 0x10) Console.print('0');
-      Console.print(buf[i], HEX);
-    }
+    Console.printf("  %06lX:", (unsigned long)off);
+    for (uint32_t i = 0; i < n; ++i) Console.printf(" %02X", row[i]);
     Console.println();
     off += n;
   }
+  view.close();
 }
 static bool ensureBlobFile(const char* fname, const uint8_t* data, uint32_t len, uint32_t reserve = ActiveFS::SECTOR_SIZE) {
   if (!checkNameLen(fname)) return false;
   uint32_t eraseAlign = getEraseAlign();
   if (reserve < eraseAlign) reserve = eraseAlign;
-  reserve = (len ? ((len + (eraseAlign - 1)) & ~(eraseAlign - 1)) : reserve);
+  if (len) reserve = len;  // rounded up by the FS; tiny blobs are packed into their record
   if (!activeFs.exists(fname)) {
     Console.print("Creating slot ");
     Console.print(fname);
@@ -1005,13 +1764,16 @@ static bool ensureBlobFile(const char* fname, const uint8_t* data, uint32_t len,
     Console.println("Failed to create slot");
     return false;
   }
-  uint32_t addr, size, cap;
+  uint64_t addr, size, cap;
   if (!activeFs.getFileInfo(fname, addr, size, cap)) {
     Console.println("getFileInfo failed");
     return false;
   }
   bool same = (size == len);
-  if (same) {
+  uint32_t storedCrc = 0;
+  if (same && activeFs.getFileCrc(fname, storedCrc)) {
+    same = (storedCrc == CRC32Fast::compute(data, len));  // no read-back needed
+  } else if (same) {
     const size_t CHUNK = 64;
     uint8_t buf[CHUNK];
     uint32_t off = 0;
@@ -1052,7 +1814,7 @@ static bool ensureBlobIfMissing(const char* fname, const uint8_t* data, uint32_t
   }
   uint32_t eraseAlign = getEraseAlign();
   if (reserve < eraseAlign) reserve = eraseAlign;
-  reserve = (len ? ((len + (eraseAlign - 1)) & ~(eraseAlign - 1)) : reserve);
+  if (len) reserve = len;  // rounded up by the FS; tiny blobs are packed into their record
   Console.printf("Auto-creating %s (%lu bytes)...\n", fname, (unsigned long)reserve);
   if (activeFs.createFileSlot(fname, reserve, data, len)) {
     Console.println("Created and wrote blob");
@@ -1129,7 +1891,7 @@ static void psramSafeSmokeTest(PSRAMUnifiedSimpleFS& fs, Stream& out = Serial) {
     out.println("PSRAM smoke test: capacity too small");
     return;
   }
-  const uint32_t fsHead = fs.raw().nextDataAddr();
+  const uint64_t fsHead = fs.raw().nextDataAddr();
   const uint32_t dataStart = fs.raw().dataRegionStart();
   const uint32_t TEST_SIZE = 1024;
   uint64_t testAddr = fsHead + 4096;
@@ -1820,12 +2582,12 @@ static bool readLine() {
 static void fillFsIface(StorageBackend b, FSIface& out) {
   if (b == StorageBackend::Flash) {
     out.mount = [](bool autoFmt) {
-      return fsFlash.mount(autoFmt);
+      return fsFlash.raw().mounted() || fsFlash.mount(autoFmt);  // keep the live index, no rescan
     };
     out.exists = [](const char* n) {
       return fsFlash.exists(n);
     };
-    out.createFileSlot = [](const char* n, uint32_t r, const uint8_t* d, uint32_t s) {
+    out.createFileSlot = [](const char* n, uint64_t r, const uint8_t* d, uint32_t s) {
       return fsFlash.createFileSlot(n, r, d, s);
     };
     out.writeFile = [](const char* n, const uint8_t* d, uint32_t s, int m) {
@@ -1837,17 +2599,29 @@ static void fillFsIface(StorageBackend b, FSIface& out) {
     out.readFile = [](const char* n, uint8_t* b, uint32_t sz) {
       return fsFlash.readFile(n, b, sz);
     };
-    out.getFileInfo = [](const char* n, uint32_t& a, uint32_t& s, uint32_t& c) {
+    out.getFileInfo = [](const char* n, uint64_t& a, uint64_t& s, uint64_t& c) {
       return fsFlash.getFileInfo(n, a, s, c);
     };
+    out.getFileCrc = [](const char* n, uint32_t& c) {
+      return fsFlash.getFileCrc(n, c);
+    };
+    out.mounted = []() {
+      return fsFlash.raw().mounted();
+    };
+    out.fileCount = []() {
+      return fsFlash.fileCount();
+    };
+    out.visitPrefix = [](const char* p, UnifiedSPIMemSimpleFS::PrefixVisitor fn, void* ctx) {
+      return fsFlash.visitPrefix(p, fn, ctx);
+    };
   } else if (b == StorageBackend::NAND) {
     out.mount = [](bool autoFmt) {
-      return fsNAND.mount(autoFmt);
+      return fsNAND.raw().mounted() || fsNAND.mount(autoFmt);  // keep the live index, no rescan
     };
     out.exists = [](const char* n) {
       return fsNAND.exists(n);
     };
-    out.createFileSlot = [](const char* n, uint32_t r, const uint8_t* d, uint32_t s) {
+    out.createFileSlot = [](const char* n, uint64_t r, const uint8_t* d, uint32_t s) {
       return fsNAND.createFileSlot(n, r, d, s);
     };
     out.writeFile = [](const char* n, const uint8_t* d, uint32_t s, int m) {
@@ -1859,18 +2633,29 @@ static void fillFsIface(StorageBackend b, FSIface& out) {
     out.readFile = [](const char* n, uint8_t* b, uint32_t sz) {
       return fsNAND.readFile(n, b, sz);
     };
-    out.getFileInfo = [](const char* n, uint32_t& a, uint32_t& s, uint32_t& c) {
+    out.getFileInfo = [](const char* n, uint64_t& a, uint64_t& s, uint64_t& c) {
       return fsNAND.getFileInfo(n, a, s, c);
     };
+    out.getFileCrc = [](const char* n, uint32_t& c) {
+      return fsNAND.getFileCrc(n, c);
+    };
+    out.mounted = []() {
+      return fsNAND.raw().mounted();
+    };
+    out.fileCount = []() {
+      return fsNAND.fileCount();
+    };
+    out.visitPrefix = [](const char* p, UnifiedSPIMemSimpleFS::PrefixVisitor fn, void* ctx) {
+      return fsNAND.visitPrefix(p, fn, ctx);
+    };
   } else {
     out.mount = [](bool autoFmt) {
-      (void)autoFmt;
-      return fsPSRAM.mount(false);
+      return fsPSRAM.raw().mounted() || fsPSRAM.mount(autoFmt);  // keep the live index, no rescan
     };
     out.exists = [](const char* n) {
       return fsPSRAM.exists(n);
     };
-    out.createFileSlot = [](const char* n, uint32_t r, const uint8_t* d, uint32_t s) {
+    out.createFileSlot = [](const char* n, uint64_t r, const uint8_t* d, uint32_t s) {
       return fsPSRAM.createFileSlot(n, r, d, s);
     };
     out.writeFile = [](const char* n, const uint8_t* d, uint32_t s, int m) {
@@ -1882,24 +2667,52 @@ static void fillFsIface(StorageBackend b, FSIface& out) {
     out.readFile = [](const char* n, uint8_t* b, uint32_t sz) {
       return fsPSRAM.readFile(n, b, sz);
     };
-    out.getFileInfo = [](const char* n, uint32_t& a, uint32_t& s, uint32_t& c) {
+    out.getFileInfo = [](const char* n, uint64_t& a, uint64_t& s, uint64_t& c) {
       return fsPSRAM.getFileInfo(n, a, s, c);
     };
+    out.getFileCrc = [](const char* n, uint32_t& c) {
+      return fsPSRAM.getFileCrc(n, c);
+    };
+    out.mounted = []() {
+      return fsPSRAM.raw().mounted();
+    };
+    out.fileCount = []() {
+      return fsPSRAM.fileCount();
+    };
+    out.visitPrefix = [](const char* p, UnifiedSPIMemSimpleFS::PrefixVisitor fn, void* ctx) {
+      return fsPSRAM.visitPrefix(p, fn, ctx);
+    };
   }
 }
 
-static bool parseBackendSpec(const char* spec, StorageBackend& outBackend, const char*& outPath) {
-  if (!spec) return false;
-  const char* colon = strchr(spec, ':');
-  if (!colon) return false;
-  size_t nameLen = (size_t)(colon - spec);
-  if (nameLen == 0) return false;
-  if (strncmp(spec, "flash", nameLen) == 0) outBackend = StorageBackend::Flash;
-  else if (strncmp(spec, "psram", nameLen) == 0) outBackend = StorageBackend::PSRAM_BACKEND;
-  else if (strncmp(spec, "nand", nameLen) == 0) outBackend = StorageBackend::NAND;
-  else return false;
-  outPath = colon + 1;  // may start with '/' or not
-  return true;
+static void vfsInit() {
+  for (VfsMount& m : g_vfs) fillFsIface(m.backend, m.ops);
+}
+// Boot: mount every backend that opened (no auto-format) and keep the indexes resident
+static void vfsMountAll() {
+  for (VfsMount& m : g_vfs) {
+    if (!m.ops.mounted() && !m.ops.mount(false)) continue;
+    Console.printf("VFS: /%s mounted (%u files)\n", m.name, (unsigned)m.ops.fileCount());
+  }
+}
+static void cmdMounts() {
+  for (VfsMount& m : g_vfs) {
+    Console.printf("  /%-6s %-12s", m.name, m.ops.mounted() ? "mounted" : "not mounted");
+    if (m.ops.mounted()) Console.printf(" %u files", (unsigned)m.ops.fileCount());
+    Console.println(m.backend == g_storage ? "  [active]" : "");
+  }
+}
+// Argument of a cross-device command: a mount-point path, or a path on the active storage
+// relative to cwd
+static bool vfsArg(const char* cwd, const char* arg, StorageBackend& b, char* out, size_t outCap) {
+  const char* rest = nullptr;
+  if (VfsMount* m = vfsResolve(arg, rest)) {
+    b = m->backend;
+    return snprintf(out, outCap, "%s", rest) < (int)outCap;
+  }
+  const size_t L = strlen(arg);
+  b = g_storage;
+  return pathJoin(out, outCap, cwd, arg, L > 0 && arg[L - 1] == '/');
 }
 
 static bool normalizeFsPathCopy(char* dst, size_t dstCap, const char* input, bool wantTrailingSlash) {
@@ -1915,21 +2728,13 @@ static bool normalizeFsPathCopy(char* dst, size_t dstCap, const char* input, boo
   return true;
 }
 
-static bool cmdFsCpImpl(const char* srcSpec, const char* dstSpec, bool force) {
-  StorageBackend sbSrc, sbDst;
-  const char* srcPathIn = nullptr;
-  const char* dstPathIn = nullptr;
-  if (!parseBackendSpec(srcSpec, sbSrc, srcPathIn) || !parseBackendSpec(dstSpec, sbDst, dstPathIn)) {
-    Console.println("fscp: invalid backend spec; use flash:/path psram:/path nand:/path");
-    return false;
-  }
-  // Prepare FS interfaces and mount (idempotent)
-  FSIface srcFS{}, dstFS{};
-  fillFsIface(sbSrc, srcFS);
-  fillFsIface(sbDst, dstFS);
-  // Mount: auto-format when empty on Flash/NAND; PSRAM no auto-format
-  bool srcMounted = srcFS.mount((sbSrc != StorageBackend::PSRAM_BACKEND));
-  bool dstMounted = dstFS.mount((sbDst != StorageBackend::PSRAM_BACKEND));
+static bool fsCopy(StorageBackend sbSrc, const char* srcPathIn, StorageBackend sbDst, const char* dstPathIn, bool force) {
+  // Resident mounts: only the first use of a backend scans its directory
+  // (auto-format when empty on Flash/NAND; PSRAM no auto-format)
+  const FSIface& srcFS = vfsFor(sbSrc).ops;
+  const FSIface& dstFS = vfsFor(sbDst).ops;
+  bool srcMounted = vfsMount(sbSrc, vfsFor(sbSrc).autoFormat);
+  bool dstMounted = vfsMount(sbDst, vfsFor(sbDst).autoFormat);
   if (!srcMounted) {
     Console.println("fscp: source mount failed");
     return false;
@@ -1947,7 +2752,7 @@ static bool cmdFsCpImpl(const char* srcSpec, const char* dstSpec, bool force) {
   }
   // Determine if destination is a folder spec (trailing '/')
   size_t LdstIn = strlen(dstPathIn);
-  bool dstAsFolder = (LdstIn > 0 && dstPathIn[LdstIn - 1] == '/');
+  bool dstAsFolder = (LdstIn == 0 || dstPathIn[LdstIn - 1] == '/');  // "" is the mount root
   if (!normalizeFsPathCopy(dstArgRaw, sizeof(dstArgRaw), dstPathIn, dstAsFolder)) {
     Console.println("fscp: destination path too long (<=32)");
     return false;
@@ -1957,11 +2762,15 @@ static bool cmdFsCpImpl(const char* srcSpec, const char* dstSpec, bool force) {
     Console.println("fscp: source not found");
     return false;
   }
-  uint32_t sAddr = 0, sSize = 0, sCap = 0;
+  uint64_t sAddr = 0, sSize = 0, sCap = 0;
   if (!srcFS.getFileInfo(srcAbs, sAddr, sSize, sCap)) {
     Console.println("fscp: getFileInfo(source) failed");
     return false;
   }
+  if (sSize > 0xFFFFFFFFUL) {
+    Console.println("fscp: file too large to copy through RAM");
+    return false;
+  }
   // Build destination absolute
   char dstAbs[ActiveFS::MAX_NAME + 1];
   if (dstAsFolder) {
@@ -1984,13 +2793,21 @@ static bool cmdFsCpImpl(const char* srcSpec, const char* dstSpec, bool force) {
     Console.println("fscp: destination exists (use -f to overwrite)");
     return false;
   }
+  // Same stored size and content CRC: nothing to read or program
+  uint32_t sCrc = 0, dCrc = 0;
+  uint64_t dA0 = 0, dS0 = 0, dC0 = 0;
+  if (dstFS.exists(dstAbs) && srcFS.getFileCrc(srcAbs, sCrc) && dstFS.getFileCrc(dstAbs, dCrc) && sCrc == dCrc
+      && dstFS.getFileInfo(dstAbs, dA0, dS0, dC0) && dS0 == sSize) {
+    Console.println("fscp: destination identical, skipped");
+    return true;
+  }
   // Read source fully (consistent with local cp)
-  uint8_t* buf = (uint8_t*)malloc(sSize ? sSize : 1);
+  uint8_t* buf = (uint8_t*)malloc(sSize ? (size_t)sSize : 1);
   if (!buf) {
     Console.println("fscp: malloc failed");
     return false;
   }
-  uint32_t got = srcFS.readFile(srcAbs, buf, sSize);
+  uint32_t got = srcFS.readFile(srcAbs, buf, (uint32_t)sSize);
   if (got != sSize) {
     Console.println("fscp: read failed");
     free(buf);
@@ -1998,21 +2815,21 @@ static bool cmdFsCpImpl(const char* srcSpec, const char* dstSpec, bool force) {
   }
   // Reserve/erase alignment based on destination backend
   uint32_t eraseAlign = getEraseAlignFor(sbDst);
-  uint32_t reserve = sCap;
+  uint64_t reserve = sCap;
   if (reserve < eraseAlign) {
-    uint32_t a = (sSize + (eraseAlign - 1)) & ~(eraseAlign - 1);
+    uint64_t a = (sSize + (eraseAlign - 1)) & ~(uint64_t)(eraseAlign - 1);
     if (a > reserve) reserve = a;
   }
   if (reserve < eraseAlign) reserve = eraseAlign;
 
   bool ok = false;
   if (!dstFS.exists(dstAbs)) {
-    ok = dstFS.createFileSlot(dstAbs, reserve, buf, sSize);
+    ok = dstFS.createFileSlot(dstAbs, reserve, buf, (uint32_t)sSize);
   } else {
-    uint32_t dA, dS, dC;
+    uint64_t dA, dS, dC;
     if (!dstFS.getFileInfo(dstAbs, dA, dS, dC)) dC = 0;
-    if (dC >= sSize) ok = dstFS.writeFileInPlace(dstAbs, buf, sSize, false);
-    if (!ok) ok = dstFS.writeFile(dstAbs, buf, sSize, fsReplaceModeFor(sbDst));
+    if (dC >= sSize) ok = dstFS.writeFileInPlace(dstAbs, buf, (uint32_t)sSize, false);
+    if (!ok) ok = dstFS.writeFile(dstAbs, buf, (uint32_t)sSize, fsReplaceModeFor(sbDst));
   }
   free(buf);
   if (!ok) {
@@ -2023,6 +2840,18 @@ static bool cmdFsCpImpl(const char* srcSpec, const char* dstSpec, bool force) {
   return true;
 }
 
+static bool cmdFsCpImpl(const char* srcSpec, const char* dstSpec, bool force) {
+  const char* srcPathIn = nullptr;
+  const char* dstPathIn = nullptr;
+  VfsMount* src = vfsResolve(srcSpec, srcPathIn);
+  VfsMount* dst = vfsResolve(dstSpec, dstPathIn);
+  if (!src || !dst) {
+    Console.println("fscp: invalid backend spec; use flash:/path psram:/path nand:/path (or /flash/path ...)");
+    return false;
+  }
+  return fsCopy(src->backend, srcPathIn, dst->backend, dstPathIn, force);
+}
+
 // ========== Serial console / command handling ==========
 static int nextToken(char*& p, char*& tok) {
   while (*p && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) ++p;
@@ -2042,25 +2871,26 @@ static void printHelp() {
   Console.println("Commands (filename max 32 chars):");
   Console.println("  help                         - this help");
   Console.println("  storage                      - show active storage");
-  Console.println("  storage flash|psram|nand     - switch storage backend");
+  Console.println("  storage flash|psram|nand     - switch storage backend (indexes stay resident)");
+  Console.println("  mounts                       - list /flash /psram /nand mount points");
   Console.println("  mode                         - show mode (dev/prod)");
   Console.println("  mode dev|prod                - set dev or prod mode");
   Console.println("  persist read                 - read persist file from active storage");
-  Console.println("  persist write                - write persist file to active storage");
+  Console.println("  persist write                - write persist record (kv log on NOR/PSRAM, file on NAND)");
   Console.println("  blobs                        - list compiled-in blobs");
   Console.println("  autogen                      - auto-create enabled blobs if missing");
   Console.println("  files                        - list files in FS");
   Console.println("  info <file>                  - show file addr/size/cap");
-  Console.println("  dump <file> <nbytes>         - hex dump head of file");
+  Console.println("  dump <file> <nbytes> [off]   - hex dump file contents (from offset)");
   Console.println("  mkSlot <file> <reserve>      - create sector-aligned slot");
   Console.println("  writeblob <file> <blobId>    - create/update file from blob");
   Console.println("  cat <file> [n]               - print file contents (text); default: entire file (truncates at 4096)");
-  Console.println("  cp <src> <dst|folder/> [-f]  - copy file; -f overwrites destination");
-  Console.println("  fscp <sFS:path> <dFS:path|folder/> [-f] - copy across filesystems (FS=flash|psram|nand)");
+  Console.println("  cp <src> <dst|folder/> [-f]  - copy file; -f overwrites destination; /flash/.. /psram/.. /nand/.. cross devices");
+  Console.println("  fscp <sFS:path> <dFS:path|folder/> [-f] - copy across filesystems (FS=flash|psram|nand, or /FS/path)");
   Console.printf("  exec <file> [a0..aN] [&]     - execute blob with 0..%d int args on core1; '&' to background\n", (int)MAX_EXEC_ARGS);
   Console.println("  del <file>                   - delete a file");
   Console.println("  rm <file>                    - alias for 'del'");
-  Console.println("  format                       - format active FS");
+  Console.println("  format [dirKiB]              - format active FS (directory sized for the device unless given)");
   Console.println("  wipe                         - erase active chip (DANGEROUS to FS)");
   Console.println("  wipereboot                   - erase chip then reboot (DANGEROUS to FS)");
   Console.println("  wipebootloader               - erase chip then reboot to bootloader (DANGEROUS to FS)");
@@ -2072,6 +2902,7 @@ static void printHelp() {
   Console.println("  timeout [ms]                 - show or set core1 timeout override (0=defaults)");
   Console.println("  puthex <file> <hex>          - upload binary as hex string");
   Console.println("  putb64 <file> <base64>       - upload binary as base64");
+  Console.println("  patchhex <file> <off> <hex>  - overwrite/extend bytes at offset (in-place)");
   Console.println("  cc <src> <dst>               - compile Tiny-C source file to binary");
   Console.println("  history                      - print recent command history");
   Console.println();
@@ -2085,9 +2916,21 @@ static void printHelp() {
   Console.println("  cd <path>                   - change to relative or absolute path");
   Console.println("  mkdir <path>                - create folder marker");
   Console.println("  ls [path]                   - list current or specified folder");
-  Console.println("  rmdir <path> [-r]           - remove folder; -r deletes all children");
+  Console.println("  rmdir <path> [-r]           - remove folder; -r deletes the subtree in one record");
   Console.println("  touch <path|name|folder/>   - create empty file or folder marker");
   Console.println("  df                          - show device and FS usage");
+  Console.println("  checkpoint [flash|nand]     - save changed PSRAM FS files/extents to the image (" FSCKPT_PREFIX "*)");
+  Console.println("  restore [flash|nand]        - repopulate the PSRAM FS from the checkpoint image");
+  Console.println("  fsstats [reset]             - per-sector write stats, cache and read-ahead counters");
+  Console.println("  cache [off|wt|wb|sync]      - set active FS block cache policy (wb: PSRAM only)");
+  Console.println("  tier [on|off|stats|reset|budget <bytes>] - mirror hot flash/nand files into PSRAM");
+  Console.println("  ring create <name> <bytes> <recsize> | append <name> <text> | dump <name> [n] | stat <name> - circular log file");
+  Console.println("  bt format <bytes> | put <name> <text> | cat|rm <name> | ls | stat | fill <n> | compact - B+tree volume (" BTREEFS_SLOT ")");
+  Console.println("  kv put <key> <value> | get <key> | del <key> | ls | stats | compact - key/value log (" KVSTORE_SLOT ")");
+  Console.println("  compress <file>             - store file compressed (LZSS); reads stay transparent");
+  Console.println("  zbench [file]               - compression ratio/throughput on built-in blobs or a file");
+  Console.println("  sum <file>                  - CRC-32 of file contents vs the stored checksum");
+  Console.println("  crcbench [bytes]            - CRC-32 throughput (bitwise/table/DMA)");
   Console.println("  mv <src> <dst|folder/>      - move/rename file");
   Console.println();
   Console.println("Co-Processor (serial RPC) commands:");
@@ -2116,6 +2959,8 @@ static void handleCommand(char* line) {
     for (int i = start; i < g_history_count; ++i) {
       Console.printf("  %2d  %s\n", i - start + 1, g_history[i]);
     }
+  } else if (!strcmp(t0, "mounts")) {
+    cmdMounts();
   } else if (!strcmp(t0, "storage")) {
     char* tok;
     if (!nextToken(p, tok)) {
@@ -2128,30 +2973,22 @@ static void handleCommand(char* line) {
       }
       return;
     }
-    if (!strcmp(tok, "flash")) {
-      g_storage = StorageBackend::Flash;
-      bindActiveFs(g_storage);
-      updateExecFsTable();
-      bool ok = activeFs.mount(true);
-      Console.println("Switched active storage to FLASH");
-      Console.println(ok ? "Mounted FLASH (auto-format if empty)" : "Mount failed (FLASH)");
-    } else if (!strcmp(tok, "psram")) {
-      g_storage = StorageBackend::PSRAM_BACKEND;
-      bindActiveFs(g_storage);
-      updateExecFsTable();
-      bool ok = activeFs.mount(false);
-      Console.println("Switched active storage to PSRAM");
-      Console.println(ok ? "Mounted PSRAM (no auto-format)" : "Mount failed (PSRAM)");
-    } else if (!strcmp(tok, "nand")) {
-      g_storage = StorageBackend::NAND;
-      bindActiveFs(g_storage);
-      updateExecFsTable();
-      bool ok = activeFs.mount(true);
-      Console.println("Switched active storage to NAND");
-      Console.println(ok ? "Mounted NAND (auto-format if empty)" : "Mount failed (NAND)");
-    } else {
+    syncAllStorage();
+    VfsMount* m = vfsByName(tok, strlen(tok));
+    if (!m) {
       Console.println("usage: storage [flash|psram|nand]");
+      return;
     }
+    // The backend keeps its resident index; only a first mount scans the directory
+    const bool resident = m->ops.mounted();
+    g_storage = m->backend;
+    bindActiveFs(g_storage);
+    updateExecFsTable();
+    bool ok = vfsMount(g_storage, m->autoFormat);
+    Console.printf("Switched active storage to %s\n", m->label);
+    if (!ok) Console.printf("Mount failed (%s)\n", m->label);
+    else if (resident) Console.printf("%s index resident (%u files)\n", m->label, (unsigned)m->ops.fileCount());
+    else Console.printf("Mounted %s (%s)\n", m->label, m->autoFormat ? "auto-format if empty" : "no auto-format");
   } else if (!strcmp(t0, "mode")) {
     char* tok;
     if (!nextToken(p, tok)) {
@@ -2174,15 +3011,19 @@ static void handleCommand(char* line) {
     }
     if (!strcmp(tok, "read")) {
       const char* pf = ".persist";
-      if (!activeFs.exists(pf)) {
+      uint8_t buf[PERSIST_LEN];
+      memset(buf, 0, PERSIST_LEN);
+      uint32_t got = 0;
+      uint16_t vlen = 0;
+      KVStore* kv = kvOpen(false);
+      if (kv && kv->get("persist", buf, PERSIST_LEN, vlen)) {
+        got = min<uint32_t>(vlen, PERSIST_LEN);
+      } else if (activeFs.exists(pf)) {
+        got = activeFs.readFile(pf, buf, PERSIST_LEN);
+      } else {
         Console.println("persist read: not found");
         return;
       }
-      uint32_t sz = 0;
-      activeFs.getFileSize(pf, sz);
-      uint8_t buf[PERSIST_LEN];
-      memset(buf, 0, PERSIST_LEN);
-      uint32_t got = activeFs.readFile(pf, buf, PERSIST_LEN);
       Console.printf("persist read: %lu bytes: ", (unsigned long)got);
       for (size_t i = 0; i < got; ++i) {
         if (i) Console.print(' ');
@@ -2194,13 +3035,22 @@ static void handleCommand(char* line) {
       const char* pf = ".persist";
       uint8_t buf[PERSIST_LEN];
       for (size_t i = 0; i < PERSIST_LEN; ++i) buf[i] = (uint8_t)(i ^ (g_dev_mode ? 0xA5 : 0x5A));
+      // Key/value log when the backend supports it: one append, no erase
+      KVStore* kv = kvOpen(true);
+      if (kv) {
+        Console.println(kv->put("persist", buf, PERSIST_LEN) ? "persist write: OK" : "persist write: write failed");
+        return;
+      }
       if (!activeFs.exists(pf)) {
         if (!activeFs.createFileSlot(pf, ActiveFS::SECTOR_SIZE, buf, PERSIST_LEN)) {
           Console.println("persist write: create failed");
           return;
         }
       } else {
-        if (!activeFs.writeFileInPlace(pf, buf, PERSIST_LEN, true)) {
+        // Same-size update: patch in place (only the touched sector is rewritten)
+        uint64_t curSize = 0;
+        bool patched = activeFs.getFileSize(pf, curSize) && curSize == PERSIST_LEN && activeFs.writeFileRange(pf, 0, buf, PERSIST_LEN);
+        if (!patched && !activeFs.writeFileInPlace(pf, buf, PERSIST_LEN, true)) {
           if (!activeFs.writeFile(pf, buf, PERSIST_LEN, fsReplaceMode())) {
             Console.println("persist write: write failed");
             return;
@@ -2221,24 +3071,20 @@ static void handleCommand(char* line) {
       Console.println("usage: info <file>");
       return;
     }
-    uint32_t a, s, c;
+    uint64_t a, s, c;
     if (activeFs.getFileInfo(fn, a, s, c)) {
-      Console.print(fn);
-      Console.print(": addr=0x");
-      Console.print(a, HEX);
-      Console.print(" size=");
-      Console.print(s);
-      Console.print(" cap=");
-      Console.println(c);
+      Console.printf("%s: addr=0x%llX size=%llu cap=%llu\n", fn, (unsigned long long)a, (unsigned long long)s, (unsigned long long)c);
     } else Console.println("not found");
   } else if (!strcmp(t0, "dump")) {
     char* fn;
     char* nstr;
+    char* ostr;
     if (!nextToken(p, fn) || !nextToken(p, nstr)) {
-      Console.println("usage: dump <file> <nbytes>");
+      Console.println("usage: dump <file> <nbytes> [offset]");
       return;
     }
-    dumpFileHead(fn, (uint32_t)strtoul(nstr, nullptr, 0));
+    uint32_t start = nextToken(p, ostr) ? (uint32_t)strtoul(ostr, nullptr, 0) : 0;
+    dumpFileHead(fn, (uint32_t)strtoul(nstr, nullptr, 0), start);
   } else if (!strcmp(t0, "mkSlot")) {
     char* fn;
     char* nstr;
@@ -2275,7 +3121,7 @@ static void handleCommand(char* line) {
     }
     if (nextToken(p, nstr)) limit = (uint32_t)strtoul(nstr, nullptr, 0);
     if (!checkNameLen(fn)) return;
-    uint32_t sz = 0;
+    uint64_t sz = 0;
     if (!activeFs.getFileSize(fn, sz)) {
       Console.println("cat: not found");
       return;
@@ -2285,10 +3131,10 @@ static void handleCommand(char* line) {
         limit = 4096;
         Console.println("(cat truncated to 4096 bytes; use 'dump' to hex-dump larger files)");
       } else {
-        limit = sz;
+        limit = (uint32_t)sz;
       }
     } else if (limit > sz) {
-      limit = sz;
+      limit = (uint32_t)sz;
     }
     const size_t CHUNK = 128;
     uint8_t buf[CHUNK];
@@ -2322,6 +3168,18 @@ static void handleCommand(char* line) {
         return;
       }
     }
+    // A /flash, /psram or /nand path on either side: copy across the mounted filesystems
+    const char* rest = nullptr;
+    if (vfsResolve(srcArg, rest) || vfsResolve(dstArg, rest)) {
+      StorageBackend sb, db;
+      char srcPath[ActiveFS::MAX_NAME + 2], dstPath[ActiveFS::MAX_NAME + 2];
+      if (!vfsArg(g_cwd, srcArg, sb, srcPath, sizeof(srcPath)) || !vfsArg(g_cwd, dstArg, db, dstPath, sizeof(dstPath))) {
+        Console.println("cp: path too long");
+        return;
+      }
+      if (!fsCopy(sb, srcPath, db, dstPath, force)) Console.println("cp failed");
+      return;
+    }
     if (!cmdCpImpl(g_cwd, srcArg, dstArg, force)) {
       Console.println("cp failed");
     }
@@ -2466,6 +3324,7 @@ static void handleCommand(char* line) {
     psramPrintCapacityReport(uniMem);
     psramSafeSmokeTest(fsPSRAM);
   } else if (!strcmp(t0, "reboot")) {
+    syncAllStorage();
     Console.printf("Rebooting..\n");
     delay(20);
     yield();
@@ -2493,7 +3352,10 @@ static void handleCommand(char* line) {
     }
     Console.println(ok ? "deleted" : "delete failed");
   } else if (!strcmp(t0, "format")) {
-    if (activeFs.format && activeFs.format()) Console.println("FS formatted");
+    char* kb;
+    UnifiedSPIMemSimpleFS* core = activeFsCore();
+    if (core) core->setFormatDirSize(nextToken(p, kb) ? (uint32_t)strtoul(kb, nullptr, 0) * 1024u : 0);
+    if (activeFs.format && activeFs.format()) Console.printf("FS formatted (directory %lu bytes)\n", core ? (unsigned long)core->dirSize() : 0ul);
     else Console.println("format failed");
   } else if (!strcmp(t0, "wipebootloader")) {
     Console.println("Erasing entire chip... this can take a while");
@@ -2539,6 +3401,25 @@ static void handleCommand(char* line) {
       Console.println(fn);
       if (binLen & 1u) Console.println("note: odd-sized file; if used as Thumb blob, exec will reject (needs even bytes).");
     } else Console.println("puthex: write failed");
+  } else if (!strcmp(t0, "patchhex")) {
+    char* fn;
+    char* offStr;
+    char* hex;
+    if (!nextToken(p, fn) || !nextToken(p, offStr) || !nextToken(p, hex)) {
+      Console.println("usage: patchhex <file> <offset> <hex>");
+      return;
+    }
+    uint8_t* bin = nullptr;
+    uint32_t binLen = 0;
+    if (!decodeHexString(hex, bin, binLen)) {
+      Console.println("patchhex: decode failed");
+      return;
+    }
+    uint32_t off = (uint32_t)strtoul(offStr, nullptr, 0);
+    bool ok = activeFs.writeFileRange(fn, off, bin, binLen);
+    free(bin);
+    if (ok) Console.printf("patchhex: wrote %lu bytes at offset %lu\n", (unsigned long)binLen, (unsigned long)off);
+    else Console.println("patchhex: failed (missing file or offset past end?)");
   } else if (!strcmp(t0, "putb64")) {
     char* fn;
     char* b64;
@@ -2636,7 +3517,24 @@ static void handleCommand(char* line) {
     char* arg;
     char folder[ActiveFS::MAX_NAME + 1] = { 0 };
     bool ok;
-    if (!nextToken(p, arg)) {
+    const char* rest = nullptr;
+    VfsMount* m = nextToken(p, arg) ? vfsResolve(arg, rest) : nullptr;
+    if (m) {
+      // Another mount point: list its resident index without switching storage
+      if (!m->ops.mounted()) {
+        Console.printf("ls: /%s not mounted\n", m->name);
+        return;
+      }
+      if (!normalizeFsPathCopy(folder, sizeof(folder), rest, /*wantTrailingSlash*/ true)) {
+        Console.println("ls: path too long");
+        return;
+      }
+      Console.printf("Listing /%s/%s:\n", m->name, folder);
+      LsWalk w = { strlen(folder), "" };
+      m->ops.visitPrefix(folder, lsVisit, &w);
+      return;
+    }
+    if (!arg) {
       ok = pathJoin(folder, sizeof(folder), g_cwd, "", /*wantTrailingSlash*/ true);
     } else if (!strcmp(arg, "/")) {
       folder[0] = 0;
@@ -2656,97 +3554,12 @@ static void handleCommand(char* line) {
       Console.println("ls: path too long");
       return;
     }
-    FsIndexEntry idx[64];
-    size_t n = buildFsIndex(idx, 64);
     Console.print("Listing /");
     Console.print(folder);
     Console.println(":");
-    if (folder[0] == 0) {
-      for (size_t i = 0; i < n; ++i) {
-        if (idx[i].deleted) continue;
-        if (strchr(idx[i].name, '/') == nullptr) {
-          Console.print("  ");
-          Console.print(idx[i].name);
-          Console.print("  (");
-          Console.print(idx[i].size);
-          Console.println(" bytes)");
-        }
-      }
-      const size_t MAX_SEEN = 32;
-      char seen[MAX_SEEN][ActiveFS::MAX_NAME + 1];
-      size_t seenCount = 0;
-      auto seenPush = [&](const char* seg) {
-        for (size_t k = 0; k < seenCount; ++k)
-          if (strcmp(seen[k], seg) == 0) return false;
-        if (seenCount < MAX_SEEN) {
-          strncpy(seen[seenCount], seg, ActiveFS::MAX_NAME);
-          seen[seenCount][ActiveFS::MAX_NAME] = 0;
-          ++seenCount;
-          return true;
-        }
-        return false;
-      };
-      for (size_t i = 0; i < n; ++i) {
-        if (idx[i].deleted) continue;
-        const char* slash = strchr(idx[i].name, '/');
-        if (!slash) continue;
-        char seg[ActiveFS::MAX_NAME + 1];
-        size_t segLen = (size_t)(slash - idx[i].name);
-        if (segLen > ActiveFS::MAX_NAME) segLen = ActiveFS::MAX_NAME;
-        memcpy(seg, idx[i].name, segLen);
-        seg[segLen] = 0;
-        if (seenPush(seg)) {
-          Console.print("  ");
-          Console.print(seg);
-          Console.println("/");
-        }
-      }
-      return;
-    }
-    size_t folderLen = strlen(folder);
-    if (folderExists(folder)) Console.println("  .");
-    const size_t MAX_SEEN = 32;
-    char seenChild[MAX_SEEN][ActiveFS::MAX_NAME + 1];
-    size_t seenCount = 0;
-    auto seenPush = [&](const char* seg) {
-      for (size_t k = 0; k < seenCount; ++k)
-        if (strcmp(seenChild[k], seg) == 0) return false;
-      if (seenCount < MAX_SEEN) {
-        strncpy(seenChild[seenCount], seg, ActiveFS::MAX_NAME);
-        seenChild[seenCount][ActiveFS::MAX_NAME] = 0;
-        ++seenCount;
-        return true;
-      }
-      return false;
-    };
-    for (size_t i = 0; i < n; ++i) {
-      if (idx[i].deleted) continue;
-      if (strncmp(idx[i].name, folder, folderLen) != 0) continue;
-      const char* rest = idx[i].name + folderLen;
-      if (*rest == 0) continue;
-      if (*rest == '/') ++rest;
-      if (*rest == 0) continue;
-      const char* slash = strchr(rest, '/');
-      if (!slash) {
-        Console.print("  ");
-        Console.print(rest);
-        Console.print("  (");
-        Console.print(idx[i].size);
-        Console.println(" bytes)");
-      } else {
-        if (slash == rest) continue;
-        size_t segLen = (size_t)(slash - rest);
-        char seg[ActiveFS::MAX_NAME + 1];
-        if (segLen > ActiveFS::MAX_NAME) segLen = ActiveFS::MAX_NAME;
-        memcpy(seg, rest, segLen);
-        seg[segLen] = 0;
-        if (seenPush(seg)) {
-          Console.print("  ");
-          Console.print(seg);
-          Console.println("/");
-        }
-      }
-    }
+    if (folder[0] && folderExists(folder)) Console.println("  .");
+    LsWalk w = { strlen(folder), "" };
+    activeFs.visitPrefix(folder, lsVisit, &w);
   } else if (!strcmp(t0, "lsdebug")) {
     char* nstr;
     uint32_t n = 256;
@@ -2766,41 +3579,22 @@ static void handleCommand(char* line) {
       Console.println("rmdir: path too long");
       return;
     }
-    FsIndexEntry idx[64];
-    size_t n = buildFsIndex(idx, 64);
-    if (n == 0) {
-      Console.println("(ls fallback) Directory scan empty; printing files view:");
-      activeFs.listFilesToSerial();
-      return;
-    }
-    bool empty = true;
-    for (size_t i = 0; i < n; ++i) {
-      if (idx[i].deleted) continue;
-      if (hasPrefix(idx[i].name, folder)) {
-        if (strlen(idx[i].name) == strlen(folder)) continue;
-        empty = false;
-        break;
-      }
-    }
-    if (!empty && !recursive) {
+    const bool marker = folderExists(folder);
+    const size_t live = activeFs.visitPrefix(folder, nullptr, nullptr);  // marker included
+    if (live > (marker ? 1u : 0u) && !recursive) {
       Console.println("rmdir: not empty (use -r to remove all files under folder)");
       return;
     }
     if (recursive) {
-      size_t delCount = 0;
-      for (size_t i = 0; i < n; ++i) {
-        if (idx[i].deleted) continue;
-        if (hasPrefix(idx[i].name, folder)) {
-          if (activeFs.deleteFile(idx[i].name)) delCount++;
-          yield();
-        }
-      }
+      // One prefix tombstone for the whole subtree (per-file tombstones on pre-v3 volumes)
+      uint32_t delCount = 0;
+      if (!activeFs.deletePrefix(folder, &delCount) && live) Console.println("rmdir -r: directory write failed");
       Console.print("rmdir -r: deleted ");
       Console.print((unsigned)delCount);
       Console.println(" entries");
       return;
     }
-    if (folderExists(folder)) {
+    if (marker) {
       if (activeFs.deleteFile(folder)) Console.println("rmdir: ok");
       else Console.println("rmdir: failed to remove marker");
     } else {
@@ -2817,8 +3611,64 @@ static void handleCommand(char* line) {
     } else {
       Console.println("touch failed");
     }
+  } else if (!strcmp(t0, "checkpoint") || !strcmp(t0, "restore")) {
+    char* which = nullptr;
+    nextToken(p, which);
+    cmdCheckpoint(t0[0] == 'r', which);
   } else if (!strcmp(t0, "df")) {
     cmdDf();
+  } else if (!strcmp(t0, "fsstats")) {
+    char* sub = nullptr;
+    bool reset = nextToken(p, sub) && !strcmp(sub, "reset");
+    cmdFsStats(reset);
+  } else if (!strcmp(t0, "compress")) {
+    char* fn = nullptr;
+    if (!nextToken(p, fn)) {
+      Console.println("usage: compress <file>");
+      return;
+    }
+    cmdCompress(fn);
+  } else if (!strcmp(t0, "zbench")) {
+    char* fn = nullptr;
+    cmdZBench(nextToken(p, fn) ? fn : nullptr);
+  } else if (!strcmp(t0, "sum")) {
+    char* fn = nullptr;
+    if (!nextToken(p, fn)) {
+      Console.println("usage: sum <file>");
+      return;
+    }
+    cmdSum(fn);
+  } else if (!strcmp(t0, "crcbench")) {
+    char* n = nullptr;
+    cmdCrcBench(nextToken(p, n) ? (uint32_t)strtoul(n, nullptr, 0) : 0);
+  } else if (!strcmp(t0, "cache")) {
+    char* mode = nullptr;
+    if (!nextToken(p, mode)) cmdFsStats(false);
+    else cmdCache(mode);
+  } else if (!strcmp(t0, "kv")) {
+    char* sub = nullptr;
+    char* key = nullptr;
+    if (nextToken(p, sub)) nextToken(p, key);
+    while (*p == ' ' || *p == '\t') ++p;
+    char* val = p;
+    size_t vl = strlen(val);
+    while (vl && (val[vl - 1] == '\r' || val[vl - 1] == '\n')) val[--vl] = 0;
+    cmdKv(sub, key, val);
+  } else if (!strcmp(t0, "ring")) {
+    char* sub = nullptr;
+    char* name = nullptr;
+    if (nextToken(p, sub)) nextToken(p, name);
+    cmdRing(sub, name, p);
+  } else if (!strcmp(t0, "bt")) {
+    char* sub = nullptr;
+    char* name = nullptr;
+    if (nextToken(p, sub)) nextToken(p, name);
+    cmdBt(sub, name, p);
+  } else if (!strcmp(t0, "tier")) {
+    char* sub = nullptr;
+    char* arg = nullptr;
+    if (nextToken(p, sub)) nextToken(p, arg);
+    cmdTier(sub, arg);
   } else if (!strcmp(t0, "mv")) {
     char* srcArg;
     char* dstArg;
@@ -2830,12 +3680,10 @@ static void handleCommand(char* line) {
       Console.println("mv failed");
     }
   } else if (!strcmp(t0, "lsraw")) {
-    FsIndexEntry idx[64];
-    size_t n = buildFsIndex(idx, 64);
-    for (size_t i = 0; i < n; ++i) {
-      if (idx[i].deleted) continue;
-      Console.printf("- %s  (%lu bytes)\n", idx[i].name, (unsigned long)idx[i].size);
-    }
+    activeFs.visitPrefix("", [](void*, const char* name, uint64_t size) {
+      Console.printf("- %s  (%llu bytes)\n", name, (unsigned long long)size);
+      return true;
+    }, nullptr);
   } else {
     Console.println("Unknown command. Type 'help'.");
   }
@@ -2846,6 +3694,7 @@ void setup() {
   while (!Serial) { delay(20); }
   delay(20);
   Console.println("System booting..");
+  CRC32Fast::init();  // tables and DMA probe before core1 can compute CRCs
   Console.begin();
   uniMem.begin();
   uniMem.setPreservePsramContents(true);
@@ -2860,12 +3709,26 @@ void setup() {
   bool nandOk = fsNAND.begin(uniMem);
   bool flashOk = fsFlash.begin(uniMem);
   bool psramOk = fsPSRAM.begin(uniMem);
+  vfsInit();
   if (!nandOk) Console.println("NAND FS: no suitable device found or open failed");
   if (!flashOk) Console.println("Flash FS: no suitable device found or open failed");
   if (!psramOk) Console.println("PSRAM FS: no suitable device found or open failed");
+  // Durable index snapshots: mount() replays only the records after the last sync()
+  if (flashOk) fsFlash.raw().reserveIndexSnapshot();
+  if (nandOk) fsNAND.raw().reserveIndexSnapshot();
+  bool psramMounted = false;
+  if (psramOk) {
+    fsPSRAM.raw().trackChanges(true);  // checkpoint copies only what changed
+    fsPSRAM.raw().reserveIndexSnapshot();
+    psramMounted = mountPsramFs(g_storage == StorageBackend::PSRAM_BACKEND);
+    Console.printf("PSRAM FS: %s\n", !psramMounted ? "mount failed" : g_psramWarm ? "warm reboot, index reused" : "directory scanned");
+  }
+#if CHECKPOINT_RESTORE_AT_BOOT
+  if (psramOk && flashOk && !g_psramWarm) cmdCheckpoint(true, "flash");  // warm PSRAM is newer than the image
+#endif
   bindActiveFs(g_storage);
-  bool mounted = activeFs.mount(g_storage == StorageBackend::PSRAM_BACKEND /*autoFormatIfEmpty*/);
-  if (!mounted) {
+  vfsMountAll();  // all backends stay mounted: storage switches and fscp reuse the indexes
+  if (!vfsFor(g_storage).ops.mounted()) {
     Console.println("FS mount failed on active storage");
   }
   for (size_t i = 0; i < BLOB_MAILBOX_MAX; ++i) BLOB_MAILBOX[i] = 0;
@@ -2884,8 +3747,11 @@ void loop1() {
 }
 void loop() {
   Exec.pollBackground();
+  pollStorageAsync();
   if (readLine()) {
     handleCommand(lineBuf);
     Console.print("> ");
+  } else {
+    storageIdle();
   }
 }
\ No newline at end of file